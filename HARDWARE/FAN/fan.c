@@ -1,6 +1,8 @@
-#include "stm32f10x.h" 
 #include "fan.h"
+#include "hal.h"
+#include "pwm_ramp.h"
 #include "math.h"
+#include <stdlib.h>
 /**************************************************************
 功  能：通用定时器2中断初始化
 参  数: 无
@@ -8,40 +10,8 @@
 **************************************************************/
 void Fan_TIM2_PWM_Init(void)
 {
-    GPIO_InitTypeDef GPIO_InitStructure;
-    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
-    TIM_OCInitTypeDef TIM_OCInitStructure;
-    
-    // 1. 开启时钟
-    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
-   
-    
-    // 2. 配置GPIOA1为复用推挽输出 (TIM2_CH2)
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_1;
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;  // 复用推挽输出
-    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-    GPIO_Init(GPIOA, &GPIO_InitStructure);
-    
-    // 3. 初始化定时器2
-    TIM_TimeBaseStructure.TIM_Period = 999;         // 自动重装载值
-    TIM_TimeBaseStructure.TIM_Prescaler = 71;      // 预分频系数
-    TIM_TimeBaseStructure.TIM_ClockDivision = 0;
-    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
-    TIM_TimeBaseInit(TIM2, &TIM_TimeBaseStructure);
-    
-    // 4. 初始化PWM模式
-    TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;      // PWM模式1
-    TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;
-    TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;
-    TIM_OCInitStructure.TIM_Pulse = 0;                     // 初始占空比为0
-    TIM_OC2Init(TIM2, &TIM_OCInitStructure);               // 初始化通道2
-    
-    // 5. 使能预装载寄存器
-    TIM_OC2PreloadConfig(TIM2, TIM_OCPreload_Enable);
-    TIM_ARRPreloadConfig(TIM2, ENABLE);
-    
-    // 6. 启动定时器
-    TIM_Cmd(TIM2, ENABLE);
+    // TIM2_CH2 (PA1)，1kHz，初始占空比为0
+    HAL_PWM_Init(HAL_PWM_FAN, 0);
 }
 
 /*******************************************************************
@@ -59,65 +29,159 @@ void Fan_Set_Speed(uint8_t speed_percent)
         speed_percent = 100;
     }
     
-    if (speed_percent == 0) {
-        // 完全关闭风扇
-        TIM_SetCompare2(TIM2, 0);
-        return;
-    }
-    
     // 将百分比转换为PWM比较值
     // 假设ARR设置为1000，那么50%对应500
-    compare_value = (speed_percent * TIM2->ARR) / 100;
+    compare_value = (speed_percent * HAL_PWM_GetPeriod(HAL_PWM_FAN)) / 100;
     
-    // 设置占空比
-    TIM_SetCompare2(TIM2, compare_value);
+    // 按斜坡过渡到新占空比 (软启动/软停止)，由 DMA 逐步写入
+    PwmRamp_To(HAL_PWM_FAN, compare_value);
 }
 
 void Servo_Init(void)
 {
-    GPIO_InitTypeDef GPIO_InitStructure;
-    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
-    TIM_OCInitTypeDef TIM_OCInitStructure;
-
-    // 1. 开启相关时钟
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_AFIO, ENABLE);
-    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
-
-    // 2. 配置PA6为复用推挽输出 (TIM3_CH1)
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_6;
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
-    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-    GPIO_Init(GPIOA, &GPIO_InitStructure);
-
-    TIM_TimeBaseStructure.TIM_Period = 19999;           // ARR值
-    TIM_TimeBaseStructure.TIM_Prescaler = 71;           // 预分频值
-    TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
-    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
-    TIM_TimeBaseInit(TIM3, &TIM_TimeBaseStructure);
-
-    // 4. 配置TIM3通道1为PWM模式1
-    TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
-    TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;
-    TIM_OCInitStructure.TIM_Pulse = 1500;              // 1.5ms脉宽，中间位置
-    TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;
-    
-    TIM_OC1Init(TIM3, &TIM_OCInitStructure);
-    TIM_OC1PreloadConfig(TIM3, TIM_OCPreload_Enable);
-
-    // 5. 使能ARR预装载（可选但推荐）
-    TIM_ARRPreloadConfig(TIM3, ENABLE);
+    // TIM3_CH1 (PA6)，50Hz，1.5ms脉宽，中间位置
+    HAL_PWM_Init(HAL_PWM_SERVO, 1500);
+}
 
-    // 6. 使能TIM3
-    TIM_Cmd(TIM3, ENABLE);
+// 0~180° 对应 0.5~2.5ms 脉宽
+static uint16_t Servo_Angle_To_Pulse(float angle)
+{
+    if (angle < 0.0f) angle = 0.0f;
+    if (angle > 180.0f) angle = 180.0f;
+    return (uint16_t)(500 + angle * (2000.0f / 180.0f));
 }
 
+// 扫描状态：active 为循环 DMA 正在播放，pending 为正在斜坡转到波形起点
+static struct {
+    uint8_t  active;
+    uint8_t  pending;
+    uint8_t  dirty;             // 周期或轮廓改变，下一次调用重新生成波形
+    uint16_t lo;                // 脉宽范围 (us)
+    uint16_t hi;
+} s_sweep;
+static uint16_t s_sweep_period_ms = SERVO_SWEEP_PERIOD_MS;
+static Servo_Sweep_Profile_t s_sweep_profile = SERVO_SWEEP_PROFILE;
+static uint16_t s_sweep_table[HAL_PWM_LOOP_MAX];
+
 void Set_Servo_Angle(uint16_t angle)
 {
-    // 限制角度范围
-    if(angle > 180) angle = 180;
-    
-    uint16_t pulse = (uint16_t)(500 + angle * (2000.0f / 180.0f));
-    TIM_SetCompare1(TIM3, pulse);
+    // 定点指向接管舵机，扫描结束 (斜坡会中止循环 DMA)
+    s_sweep.active = 0;
+    s_sweep.pending = 0;
+    // 按限定角速度转到位，避免舵机猛转
+    PwmRamp_To(HAL_PWM_SERVO, Servo_Angle_To_Pulse(angle));
+}
+
+void Servo_Sweep_Config(uint16_t period_ms, Servo_Sweep_Profile_t profile)
+{
+    s_sweep_period_ms = period_ms;
+    s_sweep_profile = profile;
+    s_sweep.dirty = 1;
+}
+
+// 一个周期内第 i 步 (共 n 步) 的位置，0 为范围下端，1 为上端
+static float Servo_Sweep_Shape(uint16_t i, uint16_t n)
+{
+    float p = (float)i / (float)n;
+
+    switch (s_sweep_profile)
+    {
+        case SERVO_SWEEP_TRIANGLE:
+            return (p < 0.5f) ? 2.0f * p : 2.0f - 2.0f * p;
+        case SERVO_SWEEP_DWELL_ENDS:
+        {
+            float d = SERVO_SWEEP_DWELL_PCT / 200.0f;   // 每端停留占周期的比例
+            float move = 0.5f - d;
+            if (p < d) return 0.0f;
+            if (p < d + move) return (p - d) / move;
+            if (p < 2.0f * d + move) return 1.0f;
+            return 1.0f - (p - 2.0f * d - move) / move;
+        }
+        case SERVO_SWEEP_SINE:
+        default:
+            // 两端速度自然降为零，在逆温层上下边缘停留更久
+            return 0.5f - 0.5f * cosf(2.0f * 3.1415926535f * p);
+    }
+}
+
+/**
+ * @brief  在 lo_angle ~ hi_angle 之间往复扫描：预先算好一个周期的脉宽波形，由 TIM3 更新事件
+ *         触发的循环 DMA 每 20ms 写入一个点，启动后不再占用 CPU
+ * @note   每轮调用即可：范围变化小于 SERVO_SWEEP_DEADBAND_US 时保持当前扫描不重启；
+ *         舵机当前位置不在波形上时先用斜坡转到最近的波形点，再从该点开始循环，不会跳变
+ */
+void Servo_Sweep(float lo_angle, float hi_angle)
+{
+    uint16_t lo = Servo_Angle_To_Pulse(lo_angle);
+    uint16_t hi = Servo_Angle_To_Pulse(hi_angle);
+    uint16_t n, k, cur, best;
+
+    if (lo > hi)
+    {
+        uint16_t t = lo;
+        lo = hi;
+        hi = t;
+    }
+    if (hi - lo < SERVO_SWEEP_MIN_SPAN_US)
+    {
+        Set_Servo_Angle((uint16_t)((lo_angle + hi_angle) * 0.5f + 0.5f));
+        return;
+    }
+
+    if ((s_sweep.active || s_sweep.pending) && !s_sweep.dirty &&
+        abs((int)lo - (int)s_sweep.lo) < SERVO_SWEEP_DEADBAND_US &&
+        abs((int)hi - (int)s_sweep.hi) < SERVO_SWEEP_DEADBAND_US)
+    {
+        if (s_sweep.active || PwmRamp_Busy(HAL_PWM_SERVO))
+        {
+            return;
+        }
+        // 已转到波形起点，沿用原范围开始循环
+        lo = s_sweep.lo;
+        hi = s_sweep.hi;
+    }
+    s_sweep.lo = lo;
+    s_sweep.hi = hi;
+    s_sweep.dirty = 0;
+
+    n = s_sweep_period_ms / HAL_PWM_StreamStepMs(HAL_PWM_SERVO);
+    if (n > HAL_PWM_LOOP_MAX) n = HAL_PWM_LOOP_MAX;
+    if (n < 4) n = 4;
+
+    // 从离当前位置最近的波形点开始
+    cur = HAL_PWM_GetCompare(HAL_PWM_SERVO);
+    k = 0;
+    best = 0xFFFF;
+    for (uint16_t i = 0; i < n; i++)
+    {
+        s_sweep_table[i] = (uint16_t)(lo + Servo_Sweep_Shape(i, n) * (hi - lo) + 0.5f);
+        uint16_t d = (uint16_t)abs((int)s_sweep_table[i] - (int)cur);
+        if (d < best)
+        {
+            best = d;
+            k = i;
+        }
+    }
+    if (best > SERVO_SWEEP_DEADBAND_US)
+    {
+        PwmRamp_To(HAL_PWM_SERVO, s_sweep_table[k]);
+        s_sweep.active = 0;
+        s_sweep.pending = 1;
+        return;
+    }
+
+    // 旋转波形使第一个点就是起点
+    static uint16_t rotated[HAL_PWM_LOOP_MAX];
+    for (uint16_t i = 0; i < n; i++)
+    {
+        rotated[i] = s_sweep_table[(i + k) % n];
+    }
+    if (HAL_PWM_StreamLoop(HAL_PWM_SERVO, rotated, n) == 0)
+    {
+        PwmRamp_Release(HAL_PWM_SERVO);
+        s_sweep.active = 1;
+        s_sweep.pending = 0;
+    }
 }
 
 float calculate_servo_angle(float target_height)
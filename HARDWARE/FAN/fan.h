@@ -10,8 +10,29 @@
 void Fan_TIM2_PWM_Init(void);
 void Fan_Set_Speed(uint8_t speed_percent);
 
+// 扫描轮廓：三角波匀速往复，正弦波在两端减速，端点停留型在两端各停 SERVO_SWEEP_DWELL_PCT/2 的周期
+typedef enum {
+    SERVO_SWEEP_TRIANGLE,
+    SERVO_SWEEP_SINE,
+    SERVO_SWEEP_DWELL_ENDS
+} Servo_Sweep_Profile_t;
+
+// 扫描周期与轮廓，可在编译时覆盖；周期上限为 HAL_PWM_LOOP_MAX x 20ms
+#ifndef SERVO_SWEEP_PERIOD_MS
+#define SERVO_SWEEP_PERIOD_MS       6000
+#endif
+#ifndef SERVO_SWEEP_PROFILE
+#define SERVO_SWEEP_PROFILE         SERVO_SWEEP_SINE
+#endif
+#define SERVO_SWEEP_DWELL_PCT       30      // 端点停留型：两端停留时间合计占周期的百分比
+#define SERVO_SWEEP_MIN_SPAN_US     22      // 范围不足约 2° 时直接定点指向中间
+#define SERVO_SWEEP_DEADBAND_US     12      // 范围变化小于约 1° 时不重启扫描
+
 void Servo_Init(void);
 void Set_Servo_Angle(uint16_t angle);
 float calculate_servo_angle(float target_height);
+// 在两个角度之间循环扫描 (循环 DMA 驱动)，Set_Servo_Angle() 结束扫描
+void Servo_Sweep(float lo_angle, float hi_angle);
+void Servo_Sweep_Config(uint16_t period_ms, Servo_Sweep_Profile_t profile);
 
 #endif
\ No newline at end of file
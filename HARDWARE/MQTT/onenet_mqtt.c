@@ -11,18 +11,25 @@
 #include "delay.h"
 #include "Relay.h"
 #include "fan.h"
+#include "actuator.h"
+#include "json_stream.h"
+#include "json_scan.h"
+#include "at_urc.h"
+#include "topic_trie.h"
+#include "telemetry_bin.h"
+#include "config_store.h"
 /*
  ===============================================================================
                             模块内部变量与宏定义
  ===============================================================================
 */
-#define CMD_BUFFER_SIZE   4096
-#define JSON_PAYLOAD_SIZE 4096
-
 // 内部静态全局变量，对外部文件隐藏
-static char g_cmd_buffer[CMD_BUFFER_SIZE];
-static char g_json_payload[JSON_PAYLOAD_SIZE]; 
+// 所有发往模组的指令都经这个流式写入器直接写入 USART1 发送环形缓冲区，不再整条暂存
+static JsonStream_t g_tx_stream;
 static unsigned int g_message_id = 0;
+
+// 本设备所有系统主题的公共前缀
+#define MQTT_SYS_TOPIC_PREFIX   "$sys/" MQTT_PRODUCT_ID "/" MQTT_DEVICE_NAME "/"
 /*
 int g_crop_stage = 0;           // 作物生长时期 (默认为0)
 int g_intervention_status = 0;  // 人工干预状态 (默认为0)
@@ -66,81 +73,954 @@ DeviceStatus g_device_status = {
  * @param  timeout_ms: 等待响应的超时时间，单位毫秒。
  * @return bool: true 代表成功，false 代表失败。
  */
+static void MQTT_Rx_Pump(void);
+static void MQTT_Prompt_Settle(void);
+static void MQTT_Reply_Flush(void);
+static void MQTT_Rx_Idle_Hook(void);
+
+// AT 指令应答窗口：自上次 MQTT_AT_Prepare() 以来收到的非 +QMTRECV 行，以 "\r\n" 分隔
+#define AT_RESPONSE_SIZE        512
+static char     s_at_response[AT_RESPONSE_SIZE + 1];
+static uint16_t s_at_response_len;
+
+static void MQTT_AT_Prepare(void)
+{
+    // 先把已经到达的数据分帧 (其中的下行消息进入队列，不会丢失)，再清空应答窗口；
+    // 必须在指令发出之前完成，否则可能丢掉模组的快速应答。
+    // 计长发布的负载尚未送完时模组仍在收数据，新指令会被当作负载，先等它结束
+    MQTT_Prompt_Settle();
+    MQTT_Rx_Pump();
+    // 快速通道排队的回复在这里优先发出：上报过程中每条指令之前都会经过这里
+    MQTT_Reply_Flush();
+    s_at_response_len = 0;
+    s_at_response[0] = '\0';
+}
+
+static bool MQTT_AT_Wait_Response(const char* expected_response, uint32_t timeout_ms);
+
 static bool MQTT_Send_AT_Command(const char* cmd, const char* expected_response, uint32_t timeout_ms)
 {
     // 步骤1：清空串口接收缓冲区
-    memset(xUSART.USART1ReceivedBuffer, 0, sizeof(xUSART.USART1ReceivedBuffer));
-    xUSART.USART1ReceivedNum = 0;
+    MQTT_AT_Prepare();
 
     // 步骤2：通过串口发送AT指令
     printf("SEND: %s", cmd);
     USART1_SendString((char*)cmd);
 
-    // 步骤3：使用SysTick获取当前时间作为超时判断的起点
+    // 步骤3：等待期望的响应
+    return MQTT_AT_Wait_Response(expected_response, timeout_ms);
+}
+
+/**
+ * @brief  在超时时间内等待模组回复中出现期望的关键字
+ */
+static bool MQTT_AT_Wait_Response(const char* expected_response, uint32_t timeout_ms)
+{
+    // 使用SysTick获取当前时间作为超时判断的起点
     uint64_t start_time = System_GetTimeMs();
 
     // 步骤4：在超时时间内循环等待
     while ((System_GetTimeMs() - start_time) < timeout_ms)
     {
-        // 检查串口是否收到了数据
-        if (xUSART.USART1ReceivedNum > 0)
-        {
-            xUSART.USART1ReceivedBuffer[xUSART.USART1ReceivedNum] = '\0';
+        // 把新收到的数据分帧，应答行进入应答窗口
+        MQTT_Rx_Pump();
 
-            // 检查收到的数据中是否包含期望的响应
-            if (strstr((char*)xUSART.USART1ReceivedBuffer, expected_response) != NULL)
-            {
-                printf("SUCCESS: Found response '%s'\r\n\r\n", expected_response);
-                return true; // 成功！
-            }
+        // 检查收到的应答中是否包含期望的响应
+        if (s_at_response_len > 0 && strstr(s_at_response, expected_response) != NULL)
+        {
+            printf("SUCCESS: Found response '%s'\r\n\r\n", expected_response);
+            return true; // 成功！
         }
         delay_ms(10); 
     }
 
     // 如果循环结束，说明已经超过了指定的 timeout_ms
-    printf("FAIL: Timeout. Did not receive '%s' in %lu ms.\r\n\r\n", expected_response, timeout_ms);
-    printf("Last received data: %s\r\n", (char*)xUSART.USART1ReceivedBuffer);
+    printf("FAIL: Timeout. Did not receive '%s' in %lu ms.\r\n\r\n", expected_response, (unsigned long)timeout_ms);
+    printf("Last received data: %s\r\n", s_at_response);
     return false; // 失败！
 }
 
 
+/*
+ ===============================================================================
+                            流式指令构建
+ ===============================================================================
+*/
+
+/*
+ * QoS 1 发布窗口：每条 QoS 1 发布占用一个在途槽位，直到模组报告 +QMTPUB: 0,<msgid>,0 (收到 PUBACK)。
+ * 模组回 "OK" 后即可发送下一条指令，不必等 PUBACK，因此最多 MQTT_INFLIGHT_WINDOW 条同时在途。
+ * 发出的完整指令在流式写入时同步保存到槽位中，超时未确认时由主循环原样重发。
+ */
+#define MQTT_INFLIGHT_WINDOW        4       // 同时等待 PUBACK 的 QoS 1 发布条数
+#define MQTT_INFLIGHT_CMD_SIZE      512     // 为重发保存的完整 AT+QMTPUB 指令长度上限
+#define MQTT_PUBACK_TIMEOUT_MS      15000   // 首次重发前等待 PUBACK 的时间，此后每次加倍
+#define MQTT_PUBLISH_MAX_RETRIES    3       // 普通发布的最大重发次数，告警事件不设上限
+#define MQTT_PUBLISH_OK_TIMEOUT_MS  1000    // 等待模组接受发布指令 ("OK") 的时间
+
+typedef struct {
+    uint16_t msgid;                         // 0 表示空闲
+    uint8_t  retries;
+    bool     critical;                      // 告警事件：重发不设上限，窗口满时最后被挤掉
+    bool     resend_now;                    // 模组报告发送失败，下次检查时立即重发
+    bool     prompt;                        // 计长发布：cmd 只保存指令头，负载在 s_prompt 暂存区
+    uint32_t sent_ms;
+    uint16_t cmd_len;                       // 0 表示指令超出保存长度，无法重发
+    char     cmd[MQTT_INFLIGHT_CMD_SIZE];
+} MqttInflight_t;
+
+static MqttInflight_t  s_inflight[MQTT_INFLIGHT_WINDOW];
+static MqttInflight_t* s_capture = NULL;    // 正在写入的发布指令同步保存到这个槽位
+static bool     s_capture_overflow = false;
+static uint16_t s_next_msgid = 1;
+static uint32_t s_puback_count = 0;
+static uint32_t s_retransmit_count = 0;
+static uint32_t s_publish_dropped = 0;
+
+/*
+ * 计长发布：AT+QMTPUB=...,<len> 发出后模组回 "> "，再原样发送 <len> 字节负载。
+ * 负载不在命令行内，没有单行长度限制，也不用考虑负载中的引号。
+ * 指令头发出后立即返回；分帧器检出 '>' 时在回调中把负载送入发送环形缓冲区，不阻塞等待。
+ * 暂存区保留到收到 PUBACK，以备超时重发，因此同一时刻只有一条计长发布在途。
+ * 只在 MQTT_PUBLISH_PROMPT 打开时编译，默认配置不占用 2KB 暂存区。
+ */
+#if MQTT_PUBLISH_PROMPT
+#define MQTT_PROMPT_PAYLOAD_SIZE    2048    // 计长发布负载上限 (模组单条上限为 4096)
+#define MQTT_PROMPT_TIMEOUT_MS      2000    // 等待 '>' 以及负载之后 "OK" 的时间
+
+typedef enum {
+    MQTT_PROMPT_IDLE,           // 暂存区空闲
+    MQTT_PROMPT_WAIT_PROMPT,    // 指令头已发出，等待 '>'
+    MQTT_PROMPT_WAIT_OK,        // 负载已送出，等待模组回 "OK"
+    MQTT_PROMPT_HELD            // 模组已接受，暂存区保留到 PUBACK
+} MqttPromptState_t;
+
+static struct {
+    volatile uint8_t state;     // MqttPromptState_t
+    bool     overflow;
+    bool     deferred;          // 暂存区仍被上一条占用，本条不发布
+    uint16_t len;
+    uint32_t since_ms;          // 进入当前等待状态的时间
+    MqttInflight_t* slot;
+    char     payload[MQTT_PROMPT_PAYLOAD_SIZE];
+} s_prompt;
+static JsonStream_t s_prompt_stream;
+#endif
+
+// 写入器的输出端：分块送入 USART1 发送环形缓冲区 (缓冲区满时 USART1_SendData 会等待)
+static void MQTT_Tx_Sink(const uint8_t* data, uint16_t len)
+{
+    USART1_SendData((uint8_t*)data, len);
+
+    if (s_capture != NULL && !s_capture_overflow)
+    {
+        if (s_capture->cmd_len + len <= MQTT_INFLIGHT_CMD_SIZE)
+        {
+            memcpy(&s_capture->cmd[s_capture->cmd_len], data, len);
+            s_capture->cmd_len += len;
+        }
+        else
+        {
+            s_capture->cmd_len = 0;     // 超长，放弃保存：这条只能依赖模组自身的重发
+            s_capture_overflow = true;
+        }
+    }
+}
+
+/**
+ * @brief  开始一条发往模组的指令
+ * @param  head: 指令头，原样输出
+ * @param  echo: 是否同时把指令打印到调试串口 (与 MQTT_Send_AT_Command 的 "SEND:" 日志一致)
+ */
+static JsonStream_t* MQTT_Cmd_Begin(const char* head, bool echo)
+{
+    JsonStream_t* w = &g_tx_stream;
+
+    JsonStream_Init(w, MQTT_Tx_Sink);
+    w->echo = echo;
+    if (echo)
+    {
+        printf("SEND: ");
+    }
+    JsonStream_Raw(w, head);
+    return w;
+}
+
+static void MQTT_Cmd_End(JsonStream_t* w, const char* tail)
+{
+    JsonStream_Raw(w, tail);
+    JsonStream_Flush(w);
+}
+
+// 写入 "$sys/{product_id}/{device_name}/" 主题前缀
+static void MQTT_Write_Sys_Topic_Prefix(JsonStream_t* w)
+{
+    JsonStream_Raw(w, MQTT_SYS_TOPIC_PREFIX);
+}
+
+/**
+ * @brief  开始一条 AT+QMTPUB 发布指令，写到负载起始引号为止
+ * @param  topic_tail: $sys/{product_id}/{device_name}/ 之后的主题部分
+ * @param  msgid/qos:  QoS 0 时 msgid 必须为 0
+ */
+static JsonStream_t* MQTT_Publish_Begin_Ex(const char* topic_tail, bool echo, uint16_t msgid, uint8_t qos)
+{
+    char head[32];
+
+    snprintf(head, sizeof(head), "AT+QMTPUB=0,%u,%u,0,\"", msgid, qos);
+    JsonStream_t* w = MQTT_Cmd_Begin(head, echo);
+    MQTT_Write_Sys_Topic_Prefix(w);
+    JsonStream_Raw(w, topic_tail);
+    JsonStream_Raw(w, "\",\"");
+    return w;
+}
+
+// QoS 0 发布：用于对云端请求的回复，回复本身由云端的请求超时兜底
+static JsonStream_t* MQTT_Publish_Begin(const char* topic_tail, bool echo)
+{
+    return MQTT_Publish_Begin_Ex(topic_tail, echo, 0, 0);
+}
+
+static void MQTT_Publish_End(JsonStream_t* w)
+{
+    MQTT_Cmd_End(w, "\"\r\n");
+}
+
+/*
+ ===============================================================================
+                            QoS 1 发布窗口
+ ===============================================================================
+*/
+
+static uint16_t MQTT_Next_Msgid(void)
+{
+    uint16_t id = s_next_msgid++;
+    if (s_next_msgid == 0)
+    {
+        s_next_msgid = 1;       // QoS 1 的 msgid 取值 1~65535
+    }
+    return id;
+}
+
+// 释放槽位；计长发布同时释放负载暂存区
+static void MQTT_Inflight_Free(MqttInflight_t* slot)
+{
+    slot->msgid = 0;
+#if MQTT_PUBLISH_PROMPT
+    if (slot->prompt)
+    {
+        slot->prompt = false;
+        s_prompt.slot = NULL;
+        s_prompt.state = MQTT_PROMPT_IDLE;
+    }
+#endif
+}
+
+static uint8_t MQTT_Inflight_Count(void)
+{
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < MQTT_INFLIGHT_WINDOW; i++)
+    {
+        if (s_inflight[i].msgid != 0) n++;
+    }
+    return n;
+}
+
+/**
+ * @brief  模组报告 +QMTPUB: <client>,<msgid>,<result>[,<value>]
+ * @note   在分帧回调中调用 (可能正处于等待 AT 应答)，只更新状态，重发留给 MQTT_Inflight_Service
+ */
+static void MQTT_Inflight_On_Result(uint16_t msgid, uint8_t result, uint16_t value)
+{
+    for (uint8_t i = 0; i < MQTT_INFLIGHT_WINDOW; i++)
+    {
+        MqttInflight_t* slot = &s_inflight[i];
+        if (slot->msgid != msgid)
+        {
+            continue;
+        }
+        switch (result)
+        {
+        case 0:     // 已收到 PUBACK
+            MQTT_Inflight_Free(slot);
+            s_puback_count++;
+            break;
+        case 1:     // 模组正在自行重发，重新计时
+            printf("DEBUG: Module is retransmitting message %u (%u times).\r\n", msgid, value);
+            slot->sent_ms = (uint32_t)System_GetTimeMs();
+            break;
+        default:    // 模组放弃发送
+            printf("WARN: Module failed to deliver message %u.\r\n", msgid);
+            slot->resend_now = true;
+            break;
+        }
+        return;
+    }
+}
+
+// 重新发送一个槽位中保存的指令，并等待模组接受
+static void MQTT_Inflight_Resend(MqttInflight_t* slot)
+{
+    slot->retries++;
+    s_retransmit_count++;
+    printf("WARN: Retransmitting message %u (attempt %u).\r\n", slot->msgid, slot->retries);
+
+    MQTT_AT_Prepare();
+    USART1_SendData((uint8_t*)slot->cmd, slot->cmd_len);
+    slot->sent_ms = (uint32_t)System_GetTimeMs();
+    slot->resend_now = false;
+#if MQTT_PUBLISH_PROMPT
+    if (slot->prompt)
+    {
+        // 计长发布只重发了指令头，负载在收到 '>' 时由回调送出
+        s_prompt.state = MQTT_PROMPT_WAIT_PROMPT;
+        s_prompt.since_ms = slot->sent_ms;
+        return;
+    }
+#endif
+    MQTT_AT_Wait_Response("OK", MQTT_PUBLISH_OK_TIMEOUT_MS);
+}
+
+/**
+ * @brief  检查在途发布：超时或失败的重发，超过重试上限的普通发布丢弃
+ * @note   会发送 AT 指令，只能在主循环上下文中调用
+ */
+static void MQTT_Inflight_Service(void)
+{
+    uint32_t now = (uint32_t)System_GetTimeMs();
+
+    if (!MQTT_Is_Online())
+    {
+        return;     // 断线期间不重发，上线时统一重发
+    }
+
+    for (uint8_t i = 0; i < MQTT_INFLIGHT_WINDOW; i++)
+    {
+        MqttInflight_t* slot = &s_inflight[i];
+        if (slot->msgid == 0)
+        {
+            continue;
+        }
+
+        uint8_t shift = (slot->retries < 3) ? slot->retries : 3;
+        uint32_t timeout = (uint32_t)MQTT_PUBACK_TIMEOUT_MS << shift;
+        if (!slot->resend_now && (now - slot->sent_ms) < timeout)
+        {
+            continue;
+        }
+
+        if (slot->cmd_len == 0 || (!slot->critical && slot->retries >= MQTT_PUBLISH_MAX_RETRIES))
+        {
+            printf("WARN: Message %u was not acknowledged after %u retransmissions, dropped.\r\n", slot->msgid, slot->retries);
+            MQTT_Inflight_Free(slot);
+            s_publish_dropped++;
+            continue;
+        }
+        MQTT_Inflight_Resend(slot);
+    }
+}
+
+/**
+ * @brief  取得一个空闲槽位；窗口满时立即挤掉最早的一条 (优先普通发布)，不等待 PUBACK
+ * @note   先把已到达的 URC 分帧，已确认的槽位随即释放；链路拥塞时丢掉过时的上报，
+ *         比让主循环停下来等更合适，丢弃计入 s_publish_dropped。
+ *         计长发布的指令头或负载还在与模组交互时先等这一段结束 (一次往返)，其槽位才可以被挤掉
+ */
+static MqttInflight_t* MQTT_Inflight_Acquire(void)
+{
+    MQTT_Prompt_Settle();
+    MQTT_Rx_Pump();
+    for (uint8_t i = 0; i < MQTT_INFLIGHT_WINDOW; i++)
+    {
+        if (s_inflight[i].msgid == 0)
+        {
+            return &s_inflight[i];
+        }
+    }
+
+    MqttInflight_t* victim = NULL;
+    for (uint8_t i = 0; i < MQTT_INFLIGHT_WINDOW; i++)
+    {
+        MqttInflight_t* slot = &s_inflight[i];
+        if (victim == NULL || (victim->critical && !slot->critical) ||
+            (victim->critical == slot->critical && (int32_t)(slot->sent_ms - victim->sent_ms) < 0))
+        {
+            victim = slot;
+        }
+    }
+    printf("%s: Publish window full, dropping unacknowledged message %u.\r\n",
+           victim->critical ? "ERROR" : "WARN", victim->msgid);
+    MQTT_Inflight_Free(victim);
+    s_publish_dropped++;
+    return victim;
+}
+
+/**
+ * @brief  为一条 QoS 1 发布占用在途槽位并开始保存指令，返回分配的 msgid
+ * @param  critical: 告警事件，重发不设上限
+ */
+static uint16_t MQTT_Inflight_Open(bool critical)
+{
+    MqttInflight_t* slot = MQTT_Inflight_Acquire();
+
+    slot->msgid = MQTT_Next_Msgid();
+    slot->retries = 0;
+    slot->critical = critical;
+    slot->resend_now = false;
+    slot->prompt = false;
+    slot->cmd_len = 0;
+
+    MQTT_AT_Prepare();
+    s_capture = slot;
+    s_capture_overflow = false;
+    return slot->msgid;
+}
+
+static JsonStream_t* MQTT_Publish_Begin_Reliable(const char* topic_tail, bool critical)
+{
+    uint16_t msgid = MQTT_Inflight_Open(critical);
+    return MQTT_Publish_Begin_Ex(topic_tail, false, msgid, 1);
+}
+
+/**
+ * @brief  结束 QoS 1 发布：等模组接受指令即返回，PUBACK 由 URC 异步确认
+ */
+static void MQTT_Publish_End_Reliable(JsonStream_t* w)
+{
+    MqttInflight_t* slot = s_capture;
+
+    MQTT_Publish_End(w);
+    s_capture = NULL;
+
+    slot->sent_ms = (uint32_t)System_GetTimeMs();
+    if (!MQTT_AT_Wait_Response("OK", MQTT_PUBLISH_OK_TIMEOUT_MS) && slot->msgid != 0)
+    {
+        slot->resend_now = true;    // 模组未接受 (忙或断线)，下次检查时重发
+    }
+}
+
+/*
+ ===============================================================================
+                            计长发布
+ ===============================================================================
+*/
+
+#if MQTT_PUBLISH_PROMPT
+// 写入器的输出端：负载写入暂存区，超出上限时整条作废
+static void MQTT_Prompt_Sink(const uint8_t* data, uint16_t len)
+{
+    if (s_prompt.overflow || s_prompt.len + len > MQTT_PROMPT_PAYLOAD_SIZE)
+    {
+        s_prompt.overflow = true;
+        return;
+    }
+    memcpy(&s_prompt.payload[s_prompt.len], data, len);
+    s_prompt.len += len;
+}
+
+/**
+ * @brief  分帧器检出 '>'：把暂存的负载送入发送环形缓冲区
+ * @note   在分帧回调中执行，只写发送缓冲区，不等待应答
+ */
+static void MQTT_On_Prompt(void)
+{
+    if (s_prompt.state != MQTT_PROMPT_WAIT_PROMPT)
+    {
+        return;
+    }
+    USART1_SendData((uint8_t*)s_prompt.payload, s_prompt.len);
+    s_prompt.state = MQTT_PROMPT_WAIT_OK;
+    s_prompt.since_ms = (uint32_t)System_GetTimeMs();
+}
+
+// 负载送出后模组的 "OK"；指令头或负载被拒绝时的 "ERROR"
+static void MQTT_Prompt_On_Line(const char* line, uint16_t len)
+{
+    if ((s_prompt.state != MQTT_PROMPT_WAIT_PROMPT && s_prompt.state != MQTT_PROMPT_WAIT_OK) || s_prompt.slot == NULL)
+    {
+        return;
+    }
+    if (s_prompt.state == MQTT_PROMPT_WAIT_OK && len == 2 && memcmp(line, "OK", 2) == 0)
+    {
+        s_prompt.state = MQTT_PROMPT_HELD;
+    }
+    else if (len == 5 && memcmp(line, "ERROR", 5) == 0)
+    {
+        s_prompt.state = MQTT_PROMPT_HELD;
+        s_prompt.slot->resend_now = true;
+    }
+}
 
 /**
- * @brief 使用同步发送-确认机制，可靠地初始化模块并连接到MQTT服务器
- * @return bool: true 代表所有步骤都成功，false 代表有任何一步失败。
+ * @brief  计长发布的指令头或负载还在与模组交互时，等这一段结束再发下一条指令
+ * @note   只在紧接着要发别的指令时才会等待，时长为一次模组往返；超时后按发送失败处理
  */
-bool Robust_Initialize_And_Connect_MQTT(void)
+static void MQTT_Prompt_Settle(void)
 {
-    // 1. 检查AT指令是否响应
-    if (!MQTT_Send_AT_Command("AT\r\n", "OK", 500)) 
+    while (s_prompt.state == MQTT_PROMPT_WAIT_PROMPT || s_prompt.state == MQTT_PROMPT_WAIT_OK)
+    {
+        MQTT_Rx_Pump();
+        if ((uint32_t)System_GetTimeMs() - s_prompt.since_ms >= MQTT_PROMPT_TIMEOUT_MS)
+        {
+            printf("WARN: Module did not %s length-prefixed publish in time.\r\n",
+                   s_prompt.state == MQTT_PROMPT_WAIT_PROMPT ? "prompt for" : "accept");
+            s_prompt.state = MQTT_PROMPT_HELD;
+            if (s_prompt.slot != NULL)
+            {
+                s_prompt.slot->resend_now = true;
+            }
+            break;
+        }
+        if (s_prompt.state == MQTT_PROMPT_WAIT_PROMPT || s_prompt.state == MQTT_PROMPT_WAIT_OK)
+        {
+            delay_ms(2);
+        }
+    }
+}
+
+// 推迟的上报：写入器照常走一遍，输出丢弃
+static void MQTT_Discard_Sink(const uint8_t* data, uint16_t len)
+{
+    (void)data;
+    (void)len;
+}
+
+/**
+ * @brief  开始一条计长发布：返回写入负载暂存区的写入器
+ * @note   上一条计长发布仍在等 PUBACK 时不等待也不放弃它：暂存区保留给它的超时重发，
+ *         本条只走一遍写入器、不发布，属性在下一轮以最新值上报，主循环不停顿
+ */
+static JsonStream_t* MQTT_Publish_Prompt_Begin(void)
+{
+    MQTT_Prompt_Settle();
+    MQTT_Rx_Pump();
+    s_prompt.deferred = (s_prompt.state != MQTT_PROMPT_IDLE);
+    if (s_prompt.deferred)
+    {
+        JsonStream_Init(&s_prompt_stream, MQTT_Discard_Sink);
+        return &s_prompt_stream;
+    }
+
+    s_prompt.len = 0;
+    s_prompt.overflow = false;
+    JsonStream_Init(&s_prompt_stream, MQTT_Prompt_Sink);
+    return &s_prompt_stream;
+}
+
+/**
+ * @brief  结束计长发布：发出 AT+QMTPUB=0,<msgid>,1,0,"<topic>",<len> 后立即返回
+ * @param  topic_tail: $sys/{product_id}/{device_name}/ 之后的主题部分
+ * @return false: 负载超出暂存区或上一条仍在途，未发布
+ */
+static bool MQTT_Publish_Prompt_End(const char* topic_tail, bool critical)
+{
+    char tail[16];
+
+    JsonStream_Flush(&s_prompt_stream);
+    if (s_prompt.deferred)
+    {
+        printf("DEBUG: Length-prefixed message %u still awaiting PUBACK, this post skipped.\r\n",
+               s_prompt.slot != NULL ? s_prompt.slot->msgid : 0);
         return false;
-    
-    // 2. 获取SIM卡信息 (IMSI)
-    if (!MQTT_Send_AT_Command("AT+CIMI\r\n", "OK", 1000)) 
+    }
+    if (s_prompt.overflow || s_prompt.len == 0)
+    {
+        printf("ERROR: Length-prefixed payload exceeds %u bytes, not published.\r\n", MQTT_PROMPT_PAYLOAD_SIZE);
+        s_prompt.state = MQTT_PROMPT_IDLE;
         return false;
+    }
 
-    // 3. 设置GPRS附着
-    if (!MQTT_Send_AT_Command("AT+CGATT=1\r\n", "OK", 1000)) 
-        return false;
+    uint16_t msgid = MQTT_Inflight_Open(critical);
+    MqttInflight_t* slot = s_capture;
+
+    slot->prompt = true;
+    JsonStream_t* w = MQTT_Cmd_Begin("AT+QMTPUB=0,", false);
+    snprintf(tail, sizeof(tail), "%u,1,0,\"", msgid);
+    JsonStream_Raw(w, tail);
+    MQTT_Write_Sys_Topic_Prefix(w);
+    JsonStream_Raw(w, topic_tail);
+    snprintf(tail, sizeof(tail), "\",%u\r\n", s_prompt.len);
+    MQTT_Cmd_End(w, tail);
+    s_capture = NULL;
+
+    s_prompt.slot = slot;
+    slot->sent_ms = (uint32_t)System_GetTimeMs();
+    s_prompt.since_ms = slot->sent_ms;
+    s_prompt.state = MQTT_PROMPT_WAIT_PROMPT;
+    printf("DEBUG: Length-prefixed publish %u queued, %u byte payload\r\n", msgid, s_prompt.len);
+    return true;
+}
 
-    // 4. 查询GPRS附着状态，期望回复是 "+CGATT: 1"
-    if (!MQTT_Send_AT_Command("AT+CGATT?\r\n", "+CGATT: 1", 3000)) 
-        return false;
+#else
+static void MQTT_On_Prompt(void) {}
+static void MQTT_Prompt_On_Line(const char* line, uint16_t len) { (void)line; (void)len; }
+static void MQTT_Prompt_Settle(void) {}
+#endif
 
-    // 5. 配置MQTT协议版本为 3.1.1
-    if (!MQTT_Send_AT_Command("AT+QMTCFG=\"version\",0,4\r\n", "OK", 1000)) 
-        return false;
+// 写入消息 ID 字段，OneNET 要求其为字符串
+static void MQTT_Write_Message_Id(JsonStream_t* w)
+{
+    char id[12];
+    snprintf(id, sizeof(id), "%u", g_message_id);
+    JsonStream_String(w, "id", id);
+}
+
+/**
+ * @brief  开始一条属性上报：{"id":"n","version":"1.0","params":{
+ * @note   MQTT_PUBLISH_PROMPT 打开时走计长发布
+ */
+static JsonStream_t* MQTT_Property_Post_Begin(void)
+{
+#if MQTT_PUBLISH_PROMPT
+    JsonStream_t* w = MQTT_Publish_Prompt_Begin();
+#else
+    JsonStream_t* w = MQTT_Publish_Begin_Reliable("thing/property/post", false);
+#endif
+
+    g_message_id++;
+    JsonStream_Object_Begin(w, NULL);
+    MQTT_Write_Message_Id(w);
+    JsonStream_String(w, "version", "1.0");
+    JsonStream_Object_Begin(w, "params");
+    return w;
+}
+
+static void MQTT_Property_Post_End(JsonStream_t* w)
+{
+    JsonStream_Object_End(w);   // params
+    JsonStream_Object_End(w);
+#if MQTT_PUBLISH_PROMPT
+    (void)w;
+    MQTT_Publish_Prompt_End("thing/property/post", false);
+#else
+    MQTT_Publish_End_Reliable(w);
+#endif
+}
+
+// 单个属性："name":{"value":v}
+static void MQTT_Property_Fixed(JsonStream_t* w, const char* name, float value, uint8_t decimals)
+{
+    JsonStream_Object_Begin(w, name);
+    JsonStream_Fixed(w, "value", value, decimals);
+    JsonStream_Object_End(w);
+}
+
+static void MQTT_Property_Int(JsonStream_t* w, const char* name, int32_t value)
+{
+    JsonStream_Object_Begin(w, name);
+    JsonStream_Int(w, "value", value);
+    JsonStream_Object_End(w);
+}
+
+static void MQTT_Property_Uint(JsonStream_t* w, const char* name, uint32_t value)
+{
+    JsonStream_Object_Begin(w, name);
+    JsonStream_Uint(w, "value", value);
+    JsonStream_Object_End(w);
+}
+
+// 各统计通道摘要对应的结构体属性名，顺序与 SensorStats_Channel_t 一致
+static const char* const s_stats_property[STATS_CH_COUNT] = {
+    "temp1_stats", "temp2_stats", "temp3_stats", "temp4_stats",
+    "ambient_temp_stats", "humidity_stats", "wind_speed_stats"
+};
+
+/**
+ * @brief  写出 [first, first+count) 通道的窗口摘要：{"xxx_stats":{"value":{"min":..,"max":..,"std":..,"n":..}}}
+ * @note   均值已作为原属性 (temp1 等) 的值上报，这里不重复；窗口内没有有效样本的通道跳过
+ */
+static void MQTT_Property_Window_Stats(JsonStream_t* w, const SensorWindow_t* win, uint8_t first, uint8_t count)
+{
+    for (uint8_t i = first; i < first + count && i < STATS_CH_COUNT; i++)
+    {
+        const SensorStats_Summary_t* c = &win->ch[i];
+        if (c->n == 0)
+        {
+            continue;
+        }
+        JsonStream_Object_Begin(w, s_stats_property[i]);
+        JsonStream_Object_Begin(w, "value");
+        JsonStream_Fixed(w, "min", c->min, 1);
+        JsonStream_Fixed(w, "max", c->max, 1);
+        JsonStream_Fixed(w, "std", c->stddev, 2);
+        JsonStream_Uint(w, "n", c->n);
+        JsonStream_Object_End(w);
+        JsonStream_Object_End(w);
+    }
+}
+
+/*
+ ===============================================================================
+                            连接监管状态机
+ ===============================================================================
+*/
+
+/*
+ * 后台连接：每次 MQTT_Connection_Service() 最多发出一条 AT 指令，随后只检查应答窗口，
+ * 不在原地等待，感知与控制不会被联网卡住。
+ * +QMTSTAT (模组报告连接断开) 与 +QMTOPEN/+QMTCONN/+QMTSUB 的结果都从 URC 中得到。
+ * 失败后按带抖动的指数退避重试：从 AT+QMTOPEN 开始，连续失败 MQTT_CONN_FULL_RESET_FAILS 次后
+ * 从 AT 探测开始重走全部步骤。全部主题在一条 AT+QMTSUB 中一次订阅。
+ */
+#define MQTT_BACKOFF_BASE_MS        1000    // 首次重试的退避时间
+#define MQTT_BACKOFF_MAX_MS         64000   // 退避时间上限
+#define MQTT_CONN_FULL_RESET_FAILS  3       // 连续失败这么多次后从 AT 探测重新开始
+
+typedef enum {
+    MQTT_CONN_IDLE,             // 未启动或已主动断开
+    MQTT_CONN_PROBE,            // AT
+    MQTT_CONN_SIM,              // AT+CIMI
+    MQTT_CONN_ATTACH,           // AT+CGATT=1
+    MQTT_CONN_ATTACH_CHECK,     // AT+CGATT?
+    MQTT_CONN_CONFIG,           // AT+QMTCFG="version"
+    MQTT_CONN_OPEN,             // AT+QMTOPEN，等 +QMTOPEN URC
+    MQTT_CONN_CONNECT,          // AT+QMTCONN，等 +QMTCONN URC
+    MQTT_CONN_SUBSCRIBE,        // AT+QMTSUB 一次订阅全部主题，等 +QMTSUB URC
+    MQTT_CONN_ONLINE,
+    MQTT_CONN_BACKOFF           // 等待下一次重试
+} MqttConnState_t;
+
+typedef struct {
+    const char* cmd;            // NULL 表示指令由 MQTT_Conn_Send_Step 拼接
+    const char* expect;         // NULL 表示期望串由 MQTT_Conn_Send_Step 生成
+    const char* fail;           // 出现即失败的结果 URC 前缀 (在 expect 之后判断)，NULL 表示只看 ERROR
+    uint16_t    timeout_ms;
+} MqttConnStep_t;
+
+static const MqttConnStep_t s_conn_steps[] = {
+    [MQTT_CONN_PROBE]        = { "AT\r\n",                                        "OK",              NULL,            500  },
+    [MQTT_CONN_SIM]          = { "AT+CIMI\r\n",                                   "OK",              NULL,            1000 },
+    [MQTT_CONN_ATTACH]       = { "AT+CGATT=1\r\n",                                "OK",              NULL,            1000 },
+    [MQTT_CONN_ATTACH_CHECK] = { "AT+CGATT?\r\n",                                 "+CGATT: 1",       NULL,            3000 },
+    [MQTT_CONN_CONFIG]       = { "AT+QMTCFG=\"version\",0,4\r\n",                 "OK",              NULL,            1000 },
+    [MQTT_CONN_OPEN]         = { "AT+QMTOPEN=0,\"mqtts.heclouds.com\",1883\r\n", "+QMTOPEN: 0,0",   "+QMTOPEN: 0,",  5000 },
+    [MQTT_CONN_CONNECT]      = { NULL,                                            "+QMTCONN: 0,0,0", "+QMTCONN: 0,",  5000 },
+    [MQTT_CONN_SUBSCRIBE]    = { NULL,                                            NULL,              "+QMTSUB: 0,",   5000 },
+};
+
+// 需要接收消息的主题 ($sys/{product_id}/{device_name}/ 之后的部分)
+static const char* const s_subscribe_topics[] = {
+    "cmd/request/+",
+    "thing/property/set",
+    "thing/service/+/invoke",
+    "thing/property/get",
+    "thing/property/desired/get/reply",     // 获取期望属性的回复
+};
+
+static struct {
+    MqttConnState_t state;
+    MqttConnState_t resume;     // 退避结束后从哪一步开始
+    uint8_t  failures;          // 连续失败次数
+    bool     waiting;           // 当前步骤的指令已发出，等待结果
+    uint32_t deadline_ms;       // 当前步骤超时或退避结束的时刻
+    uint32_t jitter;            // 退避抖动的伪随机状态
+    char     expect[24];
+    uint32_t reconnects;
+} s_conn = { MQTT_CONN_IDLE, MQTT_CONN_PROBE, 0, false, 0, 0, "", 0 };
+
+// 断线期间产生的霜冻告警，上线后补发
+static bool  s_alert_pending = false;
+static float s_alert_temp = 0.0f;
+
+static const char* const s_conn_state_names[] = {
+    "IDLE", "PROBE", "SIM", "ATTACH", "ATTACH_CHECK", "CONFIG", "OPEN", "CONNECT", "SUBSCRIBE", "ONLINE", "BACKOFF"
+};
+
+bool MQTT_Is_Online(void)
+{
+    return s_conn.state == MQTT_CONN_ONLINE;
+}
+
+// 发出当前步骤的指令，只写发送缓冲区，不等待
+static void MQTT_Conn_Send_Step(void)
+{
+    const MqttConnStep_t* step = &s_conn_steps[s_conn.state];
+
+    MQTT_AT_Prepare();
+    strncpy(s_conn.expect, step->expect != NULL ? step->expect : "", sizeof(s_conn.expect) - 1);
+
+    if (s_conn.state == MQTT_CONN_CONNECT)
+    {
+        // 使用三元组连接MQTT Broker
+        MQTT_Cmd_End(MQTT_Cmd_Begin("AT+QMTCONN=0,\"" MQTT_DEVICE_NAME "\",\"" MQTT_PRODUCT_ID "\",\"" MQTT_PASSWORD_SIGNATURE "\"", true), "\r\n");
+    }
+    else if (s_conn.state == MQTT_CONN_SUBSCRIBE)
+    {
+        // AT+QMTSUB=0,<msgid>,"<topic1>",1,"<topic2>",1,...：一条指令订阅全部主题，只等一次确认
+        char head[24];
+        uint16_t msgid = MQTT_Next_Msgid();
+
+        snprintf(head, sizeof(head), "AT+QMTSUB=0,%u", msgid);
+        snprintf(s_conn.expect, sizeof(s_conn.expect), "+QMTSUB: 0,%u,0", msgid);
+        JsonStream_t* w = MQTT_Cmd_Begin(head, true);
+        for (size_t i = 0; i < sizeof(s_subscribe_topics) / sizeof(s_subscribe_topics[0]); i++)
+        {
+            JsonStream_Raw(w, ",\"");
+            MQTT_Write_Sys_Topic_Prefix(w);
+            JsonStream_Raw(w, s_subscribe_topics[i]);
+            JsonStream_Raw(w, "\",1");
+        }
+        MQTT_Cmd_End(w, "\r\n");
+    }
+    else
+    {
+        printf("SEND: %s", step->cmd);
+        USART1_SendString((char*)step->cmd);
+    }
+
+    s_conn.waiting = true;
+    s_conn.deadline_ms = (uint32_t)System_GetTimeMs() + step->timeout_ms;
+}
+
+// 带抖动的指数退避：[d/2, d) 之间随机，避免多台设备在服务器恢复时同时重连
+static uint32_t MQTT_Conn_Backoff_Ms(void)
+{
+    uint8_t shift = (s_conn.failures > 7) ? 6 : (uint8_t)(s_conn.failures - 1);
+    uint32_t d = (uint32_t)MQTT_BACKOFF_BASE_MS << shift;
+
+    if (d > MQTT_BACKOFF_MAX_MS)
+    {
+        d = MQTT_BACKOFF_MAX_MS;
+    }
+    s_conn.jitter ^= (uint32_t)System_GetTimeMs();
+    s_conn.jitter ^= s_conn.jitter << 13;
+    s_conn.jitter ^= s_conn.jitter >> 17;
+    s_conn.jitter ^= s_conn.jitter << 5;
+    return d / 2 + s_conn.jitter % (d / 2);
+}
+
+// 进入退避：前几次从 AT+QMTOPEN 重试，连续失败较多时从头开始
+static void MQTT_Conn_Fail(const char* reason)
+{
+    uint32_t wait_ms;
+
+    if (s_conn.failures < 255)
+    {
+        s_conn.failures++;
+    }
+    s_conn.resume = (s_conn.failures >= MQTT_CONN_FULL_RESET_FAILS) ? MQTT_CONN_PROBE : MQTT_CONN_OPEN;
+    wait_ms = MQTT_Conn_Backoff_Ms();
+    printf("WARN: MQTT %s in state %s, retrying from %s in %lu ms (failure %u).\r\n", reason,
+           s_conn_state_names[s_conn.state], s_conn_state_names[s_conn.resume], (unsigned long)wait_ms, s_conn.failures);
+
+    s_conn.state = MQTT_CONN_BACKOFF;
+    s_conn.waiting = false;
+    s_conn.deadline_ms = (uint32_t)System_GetTimeMs() + wait_ms;
+}
+
+// 连接建立：断线前未确认的 QoS 1 发布全部重发，补发断线期间的告警
+static void MQTT_Conn_On_Online(void)
+{
+    s_conn.state = MQTT_CONN_ONLINE;
+    s_conn.failures = 0;
+    s_conn.reconnects++;
+    printf("SUCCESS: MQTT online, all topics subscribed (connection %lu).\r\n", (unsigned long)s_conn.reconnects);
+
+    for (uint8_t i = 0; i < MQTT_INFLIGHT_WINDOW; i++)
+    {
+        if (s_inflight[i].msgid != 0)
+        {
+            s_inflight[i].resend_now = true;
+        }
+    }
+#if MQTT_PUBLISH_PROMPT
+    if (s_prompt.state == MQTT_PROMPT_WAIT_PROMPT || s_prompt.state == MQTT_PROMPT_WAIT_OK)
+    {
+        s_prompt.state = MQTT_PROMPT_HELD;
+    }
+#endif
+    if (s_alert_pending)
+    {
+        s_alert_pending = false;
+        MQTT_Post_Frost_Alert_Event(s_alert_temp);
+    }
+}
+
+/**
+ * @brief  模组主动上报的连接状态变化 (在分帧回调中调用，只改状态)
+ * @note   +QMTSTAT: <client>,<err>：连接已被关闭 (对端断开、PINGREQ 超时、链路失效等)
+ */
+static void MQTT_Conn_On_Line(const char* line, uint16_t len)
+{
+    if (len > 10 && memcmp(line, "+QMTSTAT: ", 10) == 0 && s_conn.state != MQTT_CONN_IDLE)
+    {
+        printf("WARN: Module reported %s\r\n", line);
+        s_conn.failures = 0;
+        MQTT_Conn_Fail("connection closed");
+    }
+}
+
+/**
+ * @brief  推进连接状态机，在主循环中反复调用；每次最多发出一条指令，从不等待
+ */
+static void MQTT_Connection_Service(void)
+{
+    uint32_t now = (uint32_t)System_GetTimeMs();
+
+    switch (s_conn.state)
+    {
+    case MQTT_CONN_IDLE:
+    case MQTT_CONN_ONLINE:
+        return;
+
+    case MQTT_CONN_BACKOFF:
+        if ((int32_t)(now - s_conn.deadline_ms) >= 0)
+        {
+            s_conn.state = s_conn.resume;
+            MQTT_Conn_Send_Step();
+        }
+        return;
 
-    // 6. 打开MQTT网络 (连接到OneNET服务器)
-    sprintf(g_cmd_buffer, "AT+QMTOPEN=0,\"mqtts.heclouds.com\",1883\r\n");
-    if (!MQTT_Send_AT_Command(g_cmd_buffer, "+QMTOPEN: 0,0", 5000)) 
-        return false; 
+    default:
+        break;
+    }
 
-    // 7. 使用三元组连接MQTT Broker
-    sprintf(g_cmd_buffer, "AT+QMTCONN=0,\"%s\",\"%s\",\"%s\"\r\n", MQTT_DEVICE_NAME, MQTT_PRODUCT_ID, MQTT_PASSWORD_SIGNATURE);
-    if (!MQTT_Send_AT_Command(g_cmd_buffer, "+QMTCONN: 0,0,0", 5000)) 
-        return false; 
-    return true; // 所有步骤都成功了！
+    if (!s_conn.waiting)
+    {
+        MQTT_Conn_Send_Step();
+        return;
+    }
+
+    const MqttConnStep_t* step = &s_conn_steps[s_conn.state];
+    if (strstr(s_at_response, s_conn.expect) != NULL ||
+        (s_conn.state == MQTT_CONN_OPEN && strstr(s_at_response, "+QMTOPEN: 0,2") != NULL))  // 2: 客户端已打开
+    {
+        s_conn.waiting = false;
+        if (s_conn.state == MQTT_CONN_SUBSCRIBE)
+        {
+            MQTT_Conn_On_Online();
+            return;
+        }
+        s_conn.state = (MqttConnState_t)(s_conn.state + 1);
+        MQTT_Conn_Send_Step();
+        return;
+    }
+
+    if (strstr(s_at_response, "ERROR") != NULL || (step->fail != NULL && strstr(s_at_response, step->fail) != NULL))
+    {
+        printf("Last received data: %s\r\n", s_at_response);
+        MQTT_Conn_Fail("step failed");
+    }
+    else if ((int32_t)(now - s_conn.deadline_ms) >= 0)
+    {
+        MQTT_Conn_Fail("step timed out");
+    }
+}
+
+/**
+ * @brief  在后台开始连接 OneNET，立即返回；之后由 Handle_Serial_Reception() 推进
+ */
+void MQTT_Connection_Start(void)
+{
+    if (s_conn.state != MQTT_CONN_IDLE)
+    {
+        return;
+    }
+    printf("INFO: Starting background MQTT connection.\r\n");
+    delay_set_idle_hook(MQTT_Rx_Idle_Hook);
+    s_conn.state = MQTT_CONN_PROBE;
+    s_conn.failures = 0;
+    s_conn.waiting = false;
 }
 
 
@@ -148,27 +1028,33 @@ bool Robust_Initialize_And_Connect_MQTT(void)
 /**
  * @brief 上报霜冻风险警告事件
  * @param current_temp: 触发告警时的当前温度
+ * @note  QoS 1 且重发不设上限，直到收到 PUBACK；断线期间只保留最新一条，上线后补发
  */
 void MQTT_Post_Frost_Alert_Event(float current_temp)
 {
-    char json_payload[256]; 
-    g_message_id++;
-
-    sprintf(json_payload, 
-        "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
-        "\"frost_alert\":{\"value\":{\"current_temp\":%.1f}}"
-        "}}",
-        g_message_id,
-        current_temp
-    );
+    if (!MQTT_Is_Online())
+    {
+        printf("WARN: MQTT offline, frost alert (%.1f C) held until reconnected.\r\n", current_temp);
+        s_alert_pending = true;
+        s_alert_temp = current_temp;
+        return;
+    }
 
-    sprintf(g_cmd_buffer, "AT+QMTPUB=0,0,0,0,\"$sys/%s/%s/thing/event/post\",\"%s\"\r\n",
-            MQTT_PRODUCT_ID, 
-            MQTT_DEVICE_NAME,
-            json_payload);
+    JsonStream_t* w = MQTT_Publish_Begin_Reliable("thing/event/post", true);
+    g_message_id++;
 
-    USART1_SendString(g_cmd_buffer);
-    delay_ms(1000);
+    JsonStream_Object_Begin(w, NULL);
+    MQTT_Write_Message_Id(w);
+    JsonStream_String(w, "version", "1.0");
+    JsonStream_Object_Begin(w, "params");
+    JsonStream_Object_Begin(w, "frost_alert");
+    JsonStream_Object_Begin(w, "value");
+    JsonStream_Fixed(w, "current_temp", current_temp, 1);
+    JsonStream_Object_End(w);
+    JsonStream_Object_End(w);
+    JsonStream_Object_End(w);
+    JsonStream_Object_End(w);
+    MQTT_Publish_End_Reliable(w);
 }
 
 
@@ -181,612 +1067,706 @@ void MQTT_Post_Frost_Alert_Event(float current_temp)
  
 void MQTT_Get_Desired_Crop_Stage(void)
 {
-    char json_payload[256]; 
+    if (!MQTT_Is_Online())
+    {
+        return;
+    }
+
+    // Topic 必须使用 'thing/property/desired/get'
+    JsonStream_t* w = MQTT_Publish_Begin_Reliable("thing/property/desired/get", false);
     g_message_id++;
 
+    JsonStream_Object_Begin(w, NULL);
+    MQTT_Write_Message_Id(w);
+    JsonStream_String(w, "version", "1.0");
     // params 是一个只包含字符串 "crop_stage" 的数组
-    sprintf(json_payload, 
-        "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":[\"crop_stage\"]}",
-        g_message_id
-    );
+    JsonStream_Array_Begin(w, "params");
+    JsonStream_String(w, NULL, "crop_stage");
+    JsonStream_Array_End(w);
+    JsonStream_Object_End(w);
+    MQTT_Publish_End_Reliable(w);
+}
 
-    // Topic 必须使用 'thing/property/desired/get'
-    sprintf(g_cmd_buffer, "AT+QMTPUB=0,0,0,0,\"$sys/%s/%s/thing/property/desired/get\",\"%s\"\r\n",
-            MQTT_PRODUCT_ID, 
-            MQTT_DEVICE_NAME,
-            json_payload);
 
-    USART1_SendString(g_cmd_buffer);
-    delay_ms(1000);
+// 云端设置的参数同时交给参数存储，延迟合并写入 EEPROM，重启后不必等联网即可恢复
+static void MQTT_Store_Crop_Stage(int crop_stage)
+{
+    DeviceConfig_t cfg = *ConfigStore_Get();
+    cfg.crop_stage = (uint8_t)crop_stage;
+    ConfigStore_Set(&cfg, (uint32_t)System_GetTimeMs());
 }
 
+static void MQTT_Store_Pressure(int pressure)
+{
+    DeviceConfig_t cfg = *ConfigStore_Get();
+    cfg.pressure = (uint16_t)pressure;
+    ConfigStore_Set(&cfg, (uint32_t)System_GetTimeMs());
+}
 
 /**
- * @brief  订阅云端下发命令的主题，并等待确认
- * @return bool: true 代表订阅成功, false 代表失败
+ * @brief 根据回复类型生成不同的JSON
  */
-static bool MQTT_Subscribe_Command_Topic(void)
+static bool MQTT_Send_Reply(const char* request_id, ReplyType reply_type, const char* identifier, int code, const char* msg)
 {
-    // 目标Topic: $sys/{product_id}/{device_name}/cmd/request/+
-    sprintf(g_cmd_buffer, "AT+QMTSUB=0,1,\"$sys/%s/%s/cmd/request/+\",1\r\n", 
-            MQTT_PRODUCT_ID, 
-            MQTT_DEVICE_NAME);
-            
-    // 发送指令并等待模块返回 "+QMTSUB: 0,1,0" 表示成功
-    return MQTT_Send_AT_Command(g_cmd_buffer, "+QMTSUB: 0,1,0", 3000);
-}
+    JsonStream_t* w;
+
+    if (reply_type != REPLY_TO_PROPERTY_SET && reply_type != REPLY_TO_SERVICE_INVOKE) {
+        return false;
+    }
+    if (reply_type == REPLY_TO_SERVICE_INVOKE && (identifier == NULL || identifier[0] == '\0')) {
+        return false;
+    }
+
+    MQTT_AT_Prepare();
+
+    //Topic构建部分
+    if (reply_type == REPLY_TO_PROPERTY_SET) {
+        w = MQTT_Publish_Begin("thing/property/set_reply", true);
+    } else {
+        // 动态构建包含 identifier 的回复Topic
+        w = MQTT_Cmd_Begin("AT+QMTPUB=0,0,0,0,\"", true);
+        MQTT_Write_Sys_Topic_Prefix(w);
+        JsonStream_Raw(w, "thing/service/");
+        JsonStream_Raw(w, identifier);
+        JsonStream_Raw(w, "/invoke_reply\",\"");
+    }
 
+    // 根据回复类型，智能构建JSON
+    JsonStream_Object_Begin(w, NULL);
+    JsonStream_String(w, "id", request_id);
+    JsonStream_Int(w, "code", code);
+    JsonStream_String(w, "msg", (code == 200) ? "success" : msg);
+    if (reply_type == REPLY_TO_SERVICE_INVOKE) {
+        // 服务调用的回复带空的 data 对象，属性设置的回复【不带】data字段
+        JsonStream_Object_Begin(w, "data");
+        JsonStream_Object_End(w);
+    }
+    JsonStream_Object_End(w);
+    MQTT_Publish_End(w);
+
+    return MQTT_AT_Wait_Response("OK", 5000);
+}
 
 /**
- * @brief 订阅“属性设置”的主题，并等待确认
- * @return bool: true 代表订阅成功, false 代表失败
+ * @brief 处理“属性获取”请求，并回复当前设备状态
+ * @param request_id: 请求的唯一标识符
+ * @param params_str: 请求中包含的参数字符串 (JSON格式)
+ * @return bool: true 代表回复成功, false 代表失败
+ * @note  此函数动态构建 data 对象，仅包含请求中指定的属性，避免冗余数据。
  */
-static bool MQTT_Subscribe_Property_Set_Topic(void)
-{
-    // Topic: $sys/{product_id}/{device_name}/thing/property/set
-    sprintf(g_cmd_buffer, "AT+QMTSUB=0,1,\"$sys/%s/%s/thing/property/set\",1\r\n", 
-            MQTT_PRODUCT_ID, MQTT_DEVICE_NAME);
+// 可被 thing/property/get 读取的属性：X(属性名, 写出语句)，顺序即回复中的顺序
+#define MQTT_READABLE_PROPERTIES(X) \
+    X("ambient_temp",         JsonStream_Fixed(w, "ambient_temp", g_device_status.ambient_temp, 1)) \
+    X("humidity",             JsonStream_Fixed(w, "humidity", g_device_status.humidity, 1)) \
+    X("crop_stage",           JsonStream_Int(w, "crop_stage", g_device_status.crop_stage)) \
+    X("wind_speed",           JsonStream_Fixed(w, "wind_speed", g_device_status.wind_speed, 1)) \
+    X("temp1",                JsonStream_Fixed(w, "temp1", g_device_status.temp1, 1)) \
+    X("temp2",                JsonStream_Fixed(w, "temp2", g_device_status.temp2, 1)) \
+    X("temp3",                JsonStream_Fixed(w, "temp3", g_device_status.temp3, 1)) \
+    X("temp4",                JsonStream_Fixed(w, "temp4", g_device_status.temp4, 1)) \
+    X("pressure",             JsonStream_Int(w, "pressure", g_device_status.pressure)) \
+    X("sprinklers_available", JsonStream_Int(w, "sprinklers_available", g_device_status.sprinklers_available)) \
+    X("fans_available",       JsonStream_Int(w, "fans_available", g_device_status.fans_available)) \
+    X("heaters_available",    JsonStream_Int(w, "heaters_available", g_device_status.heaters_available)) \
+    X("intervention_status",  JsonStream_Int(w, "intervention_status", g_device_status.intervention_status)) \
+    X("fan_power",            JsonStream_Int(w, "fan_power", g_device_status.fan_power)) \
+    X("heater_power",         JsonStream_Int(w, "heater_power", g_device_status.heater_power)) \
+    X("sprinkler_power",      JsonStream_Int(w, "sprinkler_power", g_device_status.sprinkler_power)) \
+    X("actuator_switches",    JsonStream_Uint(w, "actuator_switches", g_device_status.actuator_switches))
 
-    // 发送指令并等待模块返回 "+QMTSUB: 0,1,0" 表示成功
-    return MQTT_Send_AT_Command(g_cmd_buffer, "+QMTSUB: 0,1,0", 3000);
+static bool MQTT_Reply_To_Property_Get_Refactored(const char* request_id, const char* params_str)
+{
+    uint32_t requested = 0;
+    uint32_t bit = 1;
+
+    // params_str 指向下行队列中的消息副本，处理完才出队，发送回复期间到达的新消息不会覆盖它
+    #define CHECK_REQUESTED(name, emit)  if (strstr(params_str, "\"" name "\"") != NULL) requested |= bit; bit <<= 1;
+    MQTT_READABLE_PROPERTIES(CHECK_REQUESTED)
+    #undef CHECK_REQUESTED
+
+    MQTT_AT_Prepare();
+    JsonStream_t* w = MQTT_Publish_Begin("thing/property/get_reply", true);
+
+    JsonStream_Object_Begin(w, NULL);
+    JsonStream_String(w, "id", request_id);
+    JsonStream_Int(w, "code", 200);
+    JsonStream_String(w, "msg", "success");
+
+    //构建 data 对象，仅包含请求中点名的属性
+    JsonStream_Object_Begin(w, "data");
+    bit = 1;
+    #define WRITE_REQUESTED(name, emit)  if (requested & bit) { emit; } bit <<= 1;
+    MQTT_READABLE_PROPERTIES(WRITE_REQUESTED)
+    #undef WRITE_REQUESTED
+    JsonStream_Object_End(w);   // data
+
+    JsonStream_Object_End(w);
+    MQTT_Publish_End(w);
+
+    return MQTT_AT_Wait_Response("OK", 5000);
 }
 
-/**
- * @brief  订阅“服务调用”的主题
- * @return bool: true 代表订阅成功, false 代表失败
+/*
+ * 快速通道执行完的命令在这里排队等待回复。执行发生在分帧回调中，那时可能正有一条指令在等应答，
+ * 不能发送；回复在下一个安全点 (下一条指令发出前，或主循环的 Handle_Serial_Reception) 发出。
  */
-static bool MQTT_Subscribe_Service_Invoke_Topic(void)
+#define MQTT_REPLY_QUEUE_DEPTH  4       // 必须是2的幂
+
+typedef struct {
+    ReplyType   type;
+    int16_t     code;
+    const char* msg;                    // 只指向字符串常量
+    char        request_id[32];
+    char        identifier[32];
+} MqttPendingReply_t;
+
+static MqttPendingReply_t s_reply_queue[MQTT_REPLY_QUEUE_DEPTH];
+static uint8_t s_reply_head = 0;        // 下一条写入位置 (自由增长)
+static uint8_t s_reply_tail = 0;        // 下一条发送位置 (自由增长)
+static bool    s_reply_flushing = false;
+
+static bool MQTT_Reply_Queue(const char* request_id, ReplyType reply_type, const char* identifier, int code, const char* msg)
 {
-    // Topic: $sys/{product_id}/{device_name}/thing/service/+/invoke
-    sprintf(g_cmd_buffer, "AT+QMTSUB=0,1,\"$sys/%s/%s/thing/service/+/invoke\",1\r\n", 
-            MQTT_PRODUCT_ID, MQTT_DEVICE_NAME);
+    if ((uint8_t)(s_reply_head - s_reply_tail) >= MQTT_REPLY_QUEUE_DEPTH)
+    {
+        printf("WARN: Reply queue full, reply for request_id '%s' dropped.\r\n", request_id);
+        return false;
+    }
 
-    // 发送指令并等待模块返回 "+QMTSUB: 0,1,0" 表示成功
-    return MQTT_Send_AT_Command(g_cmd_buffer, "+QMTSUB: 0,1,0", 3000);
+    MqttPendingReply_t* r = &s_reply_queue[s_reply_head % MQTT_REPLY_QUEUE_DEPTH];
+    r->type = reply_type;
+    r->code = (int16_t)code;
+    r->msg = msg;
+    strncpy(r->request_id, request_id, sizeof(r->request_id) - 1);
+    r->request_id[sizeof(r->request_id) - 1] = '\0';
+    strncpy(r->identifier, (identifier != NULL) ? identifier : "", sizeof(r->identifier) - 1);
+    r->identifier[sizeof(r->identifier) - 1] = '\0';
+    s_reply_head++;
+    return true;
 }
 
 /**
- * @brief  订阅“属性获取”的主题，并等待确认
- * @return bool: true 代表订阅成功, false 代表失败
+ * @brief  发出排队的回复
+ * @note   离线时保留到上线后再发；发送中等待应答时新排入的回复一并发出
  */
-static bool MQTT_Subscribe_Property_Get_Topic(void)
+static void MQTT_Reply_Flush(void)
 {
-    // Topic: $sys/{product_id}/{device_name}/thing/property/get
-    sprintf(g_cmd_buffer, "AT+QMTSUB=0,1,\"$sys/%s/%s/thing/property/get\",1\r\n", 
-            MQTT_PRODUCT_ID, MQTT_DEVICE_NAME);
+    if (s_reply_flushing || !MQTT_Is_Online())
+    {
+        return;
+    }
+    s_reply_flushing = true;
+    while (s_reply_tail != s_reply_head)
+    {
+        const MqttPendingReply_t* r = &s_reply_queue[s_reply_tail % MQTT_REPLY_QUEUE_DEPTH];
 
-    // 发送指令并等待模块返回 "+QMTSUB: 0,1,0" 表示成功
-    return MQTT_Send_AT_Command(g_cmd_buffer, "+QMTSUB: 0,1,0", 3000);
+        if (MQTT_Send_Reply(r->request_id, r->type, r->identifier, r->code, r->msg))
+        {
+            printf("INFO: Reply for request_id '%s' was successfully sent to the 4G module.\r\n\r\n", r->request_id);
+        }
+        else
+        {
+            printf("FATAL ERROR: FAILED to send reply for request_id '%s' to the 4G module. The module did not respond with 'OK' within the timeout period. This is the likely cause of the platform timeout!\r\n\r\n", r->request_id);
+        }
+        s_reply_tail++;
+    }
+    s_reply_flushing = false;
 }
 
+/*
+ ===============================================================================
+                            下行命令解析
+ ===============================================================================
+*/
+
+// 下行消息的类型，由主题决定
+typedef enum {
+    DOWNLINK_UNKNOWN,
+    DOWNLINK_PROPERTY_SET,          // thing/property/set
+    DOWNLINK_SERVICE_INVOKE,        // thing/service/{identifier}/invoke
+    DOWNLINK_PROPERTY_GET,          // thing/property/get
+    DOWNLINK_DESIRED_GET_REPLY      // thing/property/desired/get/reply
+} DownlinkKind_t;
+
+// 下行消息中关心的字段
+typedef enum {
+    DL_FIELD_ID,
+    DL_FIELD_CROP_STAGE,
+    DL_FIELD_FAN_POWER,
+    DL_FIELD_HEATER_POWER,
+    DL_FIELD_SPRINKLER_POWER,
+    DL_FIELD_PRESSURE,
+    DL_FIELD_METHOD,
+    DL_FIELD_COUNT
+} DownlinkField_t;
+
+// 一次扫描得到的全部字段
+typedef struct {
+    char     request_id[32];
+    int32_t  value[DL_FIELD_COUNT];
+    uint32_t present;               // 第 n 位表示字段 n 已解析
+} DownlinkMessage_t;
+
+#define DL_HAS(msg, field)   (((msg)->present >> (field)) & 1u)
+
+typedef void (*DownlinkSetter_t)(DownlinkMessage_t* msg, DownlinkField_t field, const JsonScan_Token_t* tok);
+
+typedef struct {
+    const char*      name;
+    DownlinkField_t  field;
+    DownlinkSetter_t setter;
+} DownlinkKey_t;
+
+// 字符串字段：目前只有顶层的 "id"
+static void Downlink_Set_String(DownlinkMessage_t* msg, DownlinkField_t field, const JsonScan_Token_t* tok)
+{
+    if (tok->type != JSON_SCAN_STRING || tok->depth != 1)
+    {
+        return;
+    }
+    uint16_t len = tok->value.len;
+    if (len >= sizeof(msg->request_id))
+    {
+        len = sizeof(msg->request_id) - 1;
+    }
+    memcpy(msg->request_id, tok->value.ptr, len);
+    msg->request_id[len] = '\0';
+    msg->present |= 1u << field;
+}
 
+static void Downlink_Set_Int(DownlinkMessage_t* msg, DownlinkField_t field, const JsonScan_Token_t* tok)
+{
+    int32_t v;
+    if (JsonScan_To_Int(tok, &v))
+    {
+        msg->value[field] = v;
+        msg->present |= 1u << field;
+    }
+}
 
-/**
- * @brief  订阅“获取期望属性”的回复主题
- * @return bool: true 代表订阅成功, false 代表失败
+/*
+ * 键名完美哈希表：槽位 = FNV-1a(键名) 的高 4 位，表中键名两两不冲突，查找只需一次比较。
+ * 由 TOOLS/keyhash/keyhash.py 生成，增加下行属性时先在脚本中加入键名再重新生成。
  */
-static bool MQTT_Subscribe_Desired_Property_Get_Reply_Topic(void)
- {
-     // 回复主题的官方格式为: $sys/{product_id}/{device_name}/thing/property/desired/get/reply
-     sprintf(g_cmd_buffer, "AT+QMTSUB=0,1,\"$sys/%s/%s/thing/property/desired/get/reply\",1\r\n",
-             MQTT_PRODUCT_ID, MQTT_DEVICE_NAME);
- 
-     // 发送指令并等待模块返回 "+QMTSUB: 0,1,0" 表示成功
-     return MQTT_Send_AT_Command(g_cmd_buffer, "+QMTSUB: 0,1,0", 3000);
- }
+#define DOWNLINK_KEY_SLOTS      16
+#define DOWNLINK_KEY_SHIFT      28
+#define DOWNLINK_KEY_HASH_SEED  2166136261u
+
+static const DownlinkKey_t s_downlink_keys[DOWNLINK_KEY_SLOTS] = {
+    [ 3] = { "id",              DL_FIELD_ID,              Downlink_Set_String },
+    [ 5] = { "crop_stage",      DL_FIELD_CROP_STAGE,      Downlink_Set_Int },
+    [ 7] = { "sprinkler_power", DL_FIELD_SPRINKLER_POWER, Downlink_Set_Int },
+    [ 8] = { "fan_power",       DL_FIELD_FAN_POWER,       Downlink_Set_Int },
+    [10] = { "method",          DL_FIELD_METHOD,          Downlink_Set_Int },
+    [11] = { "heater_power",    DL_FIELD_HEATER_POWER,    Downlink_Set_Int },
+    [12] = { "pressure",        DL_FIELD_PRESSURE,        Downlink_Set_Int },
+};
 
+static uint32_t Downlink_Key_Hash(const char* key, uint16_t len)
+{
+    uint32_t h = DOWNLINK_KEY_HASH_SEED;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        h ^= (uint8_t)key[i];
+        h *= 16777619u;
+    }
+    return h;
+}
 
-/**
- * @brief  一次性订阅所有需要接收消息的主题，并检查每一步的结果
- * @return bool: true 代表所有主题都订阅成功, false 代表有任何一个失败
- */
-bool MQTT_Subscribe_All_Topics(void)
+// 扫描器回调：按键名查表，交给对应的类型化处理函数
+static void Downlink_On_Token(const JsonScan_Token_t* tok, void* ctx)
 {
-    printf("INFO: Subscribing to all topics...\r\n");
+    const JsonScan_Slice_t* key = &tok->key;
 
-    if (!MQTT_Subscribe_Command_Topic()) {
-        printf("ERROR: Failed to subscribe to Command Topic.\r\n");
-        return false;
-    }
-    
-    if (!MQTT_Subscribe_Property_Set_Topic()) {
-        printf("ERROR: Failed to subscribe to Property Set Topic.\r\n");
-        return false;
+    // {"crop_stage":{"value":2}} 形式的值归到外层键名
+    if (JsonScan_Slice_Equals(key, "value") && tok->parent.ptr != NULL)
+    {
+        key = &tok->parent;
     }
-    
-    if (!MQTT_Subscribe_Service_Invoke_Topic()) {
-        printf("ERROR: Failed to subscribe to Service Invoke Topic.\r\n");
-        return false;
+    if (key->ptr == NULL)
+    {
+        return;
     }
 
-    if (!MQTT_Subscribe_Property_Get_Topic()) {
-        printf("ERROR: Failed to subscribe to Property Get Topic.\r\n");
-        return false;
-    }
-    
-    if (!MQTT_Subscribe_Desired_Property_Get_Reply_Topic()) {
-        printf("ERROR: Failed to subscribe to Desired Property Get Reply Topic.\r\n");
-        return false;
+    const DownlinkKey_t* entry = &s_downlink_keys[Downlink_Key_Hash(key->ptr, key->len) >> DOWNLINK_KEY_SHIFT];
+    if (entry->name != NULL && JsonScan_Slice_Equals(key, entry->name))
+    {
+        entry->setter((DownlinkMessage_t*)ctx, entry->field, tok);
     }
-
-    printf("INFO: All topics subscribed successfully.\r\n\r\n");
-    return true; 
 }
 
+/*
+ ===============================================================================
+                            串口接收：分帧、路由与排队
+ ===============================================================================
+*/
+#define DOWNLINK_QUEUE_DEPTH    4       // 等待处理的下行消息条数，必须是2的幂
+#define DOWNLINK_PAYLOAD_SIZE   768     // 单条下行消息负载的最大长度
+
+// 已按主题路由、等待处理的一条下行消息
+typedef struct {
+    DownlinkKind_t kind;
+    uint16_t       msgid;
+    char           identifier[32];      // 服务标识符，取自主题中 '+' 匹配的一层
+    uint16_t       payload_len;
+    char           payload[DOWNLINK_PAYLOAD_SIZE + 1];
+} DownlinkQueued_t;
+
+static AtUrc_Framer_t   s_urc_framer;
+static TopicTrie_t      s_topic_trie;
+static bool             s_rx_ready = false;
+
+static DownlinkQueued_t s_downlink_queue[DOWNLINK_QUEUE_DEPTH];
+static uint8_t  s_downlink_head = 0;    // 下一条写入位置 (自由增长)
+static uint8_t  s_downlink_tail = 0;    // 下一条处理位置 (自由增长)
+static uint32_t s_downlink_dropped = 0;
+
+// 订阅的主题过滤器与下行消息类型的对应关系，与 MQTT_Subscribe_All_Topics 保持一致
+static const struct {
+    const char*    filter;
+    DownlinkKind_t kind;
+} s_downlink_routes[] = {
+    { MQTT_SYS_TOPIC_PREFIX "thing/property/set",               DOWNLINK_PROPERTY_SET },
+    { MQTT_SYS_TOPIC_PREFIX "thing/property/get",               DOWNLINK_PROPERTY_GET },
+    { MQTT_SYS_TOPIC_PREFIX "thing/property/desired/get/reply", DOWNLINK_DESIRED_GET_REPLY },
+    { MQTT_SYS_TOPIC_PREFIX "thing/service/+/invoke",           DOWNLINK_SERVICE_INVOKE },
+};
 
-
-
-/**
- * @brief  使用“数据模式”发送MQTT消息
- * @param topic:   要发布到的主题
- * @param payload: 要发送的JSON负载 (注意：是干净的JSON，不带C语言转义符)
- * @return bool:   true 代表发布成功, false 代表失败
- * @note   此函数使用 AT+QMTPUB 的“提示符”模式，先发送指令头，等待模块返回">"，
- *         然后再发送数据负载。这是发送较长或包含特殊字符数据的最稳定方法。
- */
- /*
-static bool MQTT_Publish_Message_Prompt_Mode(const char* topic, const char* payload)
+// 非 +QMTRECV 的行进入 AT 应答窗口，窗口满时丢弃较早的一半
+static void MQTT_On_Response_Line(const char* line, uint16_t len)
 {
-    // 1. 计算负载的长度
-    size_t payload_len = strlen(payload);
+    MQTT_Prompt_On_Line(line, len);
+    MQTT_Conn_On_Line(line, len);
 
-    // 2. 构建第一部分AT指令，包含主题和数据长度
-    snprintf(g_cmd_buffer, CMD_BUFFER_SIZE, "AT+QMTPUB=0,0,0,0,\"%s\",%u\r\n", topic, payload_len);
-
-    // 3. 发送指令头，并等待模块返回数据输入提示符 ">"
-    //    这是一个关键的握手步骤。我们给它1秒的超时时间。
-    if (!MQTT_Send_AT_Command(g_cmd_buffer, ">", 1000))
+    // +QMTPUB: <client>,<msgid>,<result>[,<value>]：QoS 1 发布的确认，msgid 0 是 QoS 0 发布的回显
+    if (len > 9 && memcmp(line, "+QMTPUB: ", 9) == 0)
     {
-        printf("ERROR: Did not receive prompt '>' from module for publishing.\r\n");
-        return false;
+        uint16_t field[4] = {0, 0, 0, 0};
+        uint8_t  n = 0;
+        for (uint16_t i = 9; i < len && n < 4; i++)
+        {
+            if (line[i] == ',')
+            {
+                n++;
+            }
+            else if (line[i] >= '0' && line[i] <= '9')
+            {
+                field[n] = (uint16_t)(field[n] * 10 + (line[i] - '0'));
+            }
+        }
+        if (n >= 2 && field[1] != 0)
+        {
+            MQTT_Inflight_On_Result(field[1], (uint8_t)field[2], field[3]);
+        }
     }
 
-    // 4. 成功收到了 ">"，现在直接发送原始的 payload 数据
-    //    注意：这里我们不再使用 MQTT_Send_AT_Command，因为我们不需要等待特定的回复，
-    //    而是要等待最终的发布确认 "+QMTPUB: 0,0,0"。
-    printf("SEND_PAYLOAD: %s\r\n", payload);
-    USART1_SendString((char*)payload);
-
-    // 5. 发送完数据后，模块会进行网络操作，并最终返回发布结果。
-    //    我们等待 "+QMTPUB: 0,0,0" 作为成功的标志。网络操作需要更长的时间。
-    if (!MQTT_Send_AT_Command("\r\n", "+QMTPUB: 0,0,0", 5000)) // 发送一个换行符触发模块响应
+    if (len > AT_RESPONSE_SIZE - 2)
     {
-        printf("ERROR: Did not receive publish confirmation after sending payload.\r\n");
-        return false;
+        len = AT_RESPONSE_SIZE - 2;
     }
-
-    printf("INFO: Message on topic '%s' published successfully using prompt mode.\r\n", topic);
-    return true;
+    if (s_at_response_len + len + 2 > AT_RESPONSE_SIZE)
+    {
+        uint16_t keep = s_at_response_len / 2;
+        if (keep + len + 2 > AT_RESPONSE_SIZE)
+        {
+            keep = 0;
+        }
+        memmove(s_at_response, s_at_response + s_at_response_len - keep, keep);
+        s_at_response_len = keep;
+    }
+    memcpy(s_at_response + s_at_response_len, line, len);
+    s_at_response_len += len;
+    s_at_response[s_at_response_len++] = '\r';
+    s_at_response[s_at_response_len++] = '\n';
+    s_at_response[s_at_response_len] = '\0';
 }
-*/
-
-
-
-
 
+static void Process_MQTT_Message_Robust(DownlinkKind_t kind, const char* method, const char* payload, uint16_t payload_len);
 
 /**
- * @brief 根据回复类型生成不同的JSON
+ * @brief  分帧器交来一条完整的 +QMTRECV：按主题路由
+ * @note   可能在等待 AT 应答的过程中被调用，因此这里不发送任何指令：
+ *         属性设置与服务调用 (快速通道) 就地执行，回复排队；其余消息拷贝进队列由主循环处理
  */
-static bool MQTT_Send_Reply(const char* request_id, ReplyType reply_type, const char* identifier, int code, const char* msg)
+static void MQTT_On_Recv(const AtUrc_Recv_t* recv)
 {
-    char reply_topic[128];
-    char clean_json_payload[256];
+    const char* level = NULL;
+    uint16_t level_len = 0;
+    uint8_t route = TopicTrie_Match(&s_topic_trie, recv->topic, recv->topic_len, &level, &level_len);
 
-    // 根据回复类型，智能构建JSON
-    if (reply_type == REPLY_TO_PROPERTY_SET) {
-        // 属性设置的回复，【不带】data字段
-        snprintf(clean_json_payload, sizeof(clean_json_payload),
-                 "{\"id\":\"%s\",\"code\":%d,\"msg\":\"%s\"}",
-                 request_id, code, (code == 200) ? "success" : msg);
-    } else { // 适用于 REPLY_TO_SERVICE_INVOKE
-        // 服务调用的回复
-        snprintf(clean_json_payload, sizeof(clean_json_payload),
-                 "{\"id\":\"%s\",\"code\":%d,\"msg\":\"%s\",\"data\":{}}",
-                 request_id, code, (code == 200) ? "success" : msg);
+    if (route == TOPIC_TRIE_NO_ROUTE)
+    {
+        printf("DEBUG: Received a message on unhandled topic '%s'. No reply needed.\r\n", recv->topic);
+        return;
     }
-
-    //Topic构建部分
-    switch (reply_type)
+    if (route == DOWNLINK_PROPERTY_SET || route == DOWNLINK_SERVICE_INVOKE)
     {
-        case REPLY_TO_PROPERTY_SET:
-            snprintf(reply_topic, sizeof(reply_topic),
-                     "$sys/%s/%s/thing/property/set_reply",
-                     MQTT_PRODUCT_ID, MQTT_DEVICE_NAME);
-            break;
-        case REPLY_TO_SERVICE_INVOKE:
-            if (identifier == NULL || identifier[0] == '\0') {
-                return false;
-            }
-            // 动态构建包含 identifier 的回复Topic
-            snprintf(reply_topic, sizeof(reply_topic),
-                     "$sys/%s/%s/thing/service/%s/invoke_reply",
-                     MQTT_PRODUCT_ID, MQTT_DEVICE_NAME, identifier);
-            break;
-        default:
-            return false;
+        char identifier[32];
+        if (level_len >= sizeof(identifier))
+        {
+            level_len = sizeof(identifier) - 1;
+        }
+        memcpy(identifier, level, level_len);
+        identifier[level_len] = '\0';
+        printf("INFO: Downlink message %u received.\r\n", recv->msgid);
+        Process_MQTT_Message_Robust((DownlinkKind_t)route, identifier, recv->payload, recv->payload_len);
+        return;
+    }
+    if (recv->payload_len > DOWNLINK_PAYLOAD_SIZE)
+    {
+        s_downlink_dropped++;
+        printf("WARN: Downlink payload of %u bytes on '%s' exceeds %u bytes, dropped.\r\n",
+               recv->payload_len, recv->topic, (unsigned)DOWNLINK_PAYLOAD_SIZE);
+        return;
+    }
+    if ((uint8_t)(s_downlink_head - s_downlink_tail) >= DOWNLINK_QUEUE_DEPTH)
+    {
+        s_downlink_dropped++;
+        printf("WARN: Downlink queue full, message %u on '%s' dropped (%lu dropped so far).\r\n",
+               recv->msgid, recv->topic, (unsigned long)s_downlink_dropped);
+        return;
     }
 
-    //AT指令发送部分
-    snprintf(g_cmd_buffer, CMD_BUFFER_SIZE, 
-             "AT+QMTPUB=0,0,0,0,\"%s\",\"%s\"\r\n",
-             reply_topic, clean_json_payload);
-
-    return MQTT_Send_AT_Command(g_cmd_buffer, "OK", 5000);
+    DownlinkQueued_t* m = &s_downlink_queue[s_downlink_head % DOWNLINK_QUEUE_DEPTH];
+    m->kind = (DownlinkKind_t)route;
+    m->msgid = recv->msgid;
+    if (level_len >= sizeof(m->identifier))
+    {
+        level_len = sizeof(m->identifier) - 1;
+    }
+    memcpy(m->identifier, level, level_len);
+    m->identifier[level_len] = '\0';
+    memcpy(m->payload, recv->payload, recv->payload_len);
+    m->payload[recv->payload_len] = '\0';
+    m->payload_len = recv->payload_len;
+    s_downlink_head++;
 }
 
-/**
- * @brief 处理“属性获取”请求，并回复当前设备状态
- * @param request_id: 请求的唯一标识符
- * @param params_str: 请求中包含的参数字符串 (JSON格式)
- * @return bool: true 代表回复成功, false 代表失败
- * @note  此函数动态构建 data 对象，仅包含请求中指定的属性，避免冗余数据。
- */
-static bool MQTT_Reply_To_Property_Get_Refactored(const char* request_id, const char* params_str)
+static void MQTT_Rx_Init(void)
 {
-    static char data_payload[4096] = {0};
-    static char final_json[2048] = {0};
-    static char reply_topic[256] = {0};
-
-    //构建 data 对象
-    char* p = data_payload;
-    size_t remaining_len = sizeof(data_payload);
-    int written_len = 0;
-    bool first_item_added = false; // 用于控制逗号
-
-    // 写入起始的 '{'
-    written_len = snprintf(p, remaining_len, "{");
-    p += written_len;
-    remaining_len -= written_len;
-
-    // 宏定义一个帮助函数，减少重复代码
-    // __VA_ARGS__ 用于处理可变参数
-    #define ADD_PROPERTY(param_name, format, ...) \
-    if (remaining_len > 1 && strstr(params_str, "\"" param_name "\"") != NULL) { \
-        if (first_item_added) { \
-            written_len = snprintf(p, remaining_len, ","); \
-            p += written_len; \
-            remaining_len -= written_len; \
-        } \
-        written_len = snprintf(p, remaining_len, "\"" param_name "\":" format, __VA_ARGS__); \
-        p += written_len; \
-        remaining_len -= written_len; \
-        first_item_added = true; \
-    }
-
-    // 使用宏来添加各个属性
-    ADD_PROPERTY("ambient_temp", "%.1f", g_device_status.ambient_temp);
-    ADD_PROPERTY("humidity", "%.1f", g_device_status.humidity);
-    ADD_PROPERTY("crop_stage", "%d", g_device_status.crop_stage);
-    ADD_PROPERTY("wind_speed", "%.1f", g_device_status.wind_speed);
-    ADD_PROPERTY("temp1", "%.1f", g_device_status.temp1);
-    ADD_PROPERTY("temp2", "%.1f", g_device_status.temp2);
-    ADD_PROPERTY("temp3", "%.1f", g_device_status.temp3);
-    ADD_PROPERTY("temp4", "%.1f", g_device_status.temp4);
-    ADD_PROPERTY("pressure", "%d", g_device_status.pressure);
-
-    ADD_PROPERTY("sprinklers_available", "%d", g_device_status.sprinklers_available);
-    ADD_PROPERTY("fans_available", "%d", g_device_status.fans_available);
-    ADD_PROPERTY("heaters_available", "%d", g_device_status.heaters_available);
-
-    ADD_PROPERTY("intervention_status", "%d", g_device_status.intervention_status);
-    ADD_PROPERTY("fan_power", "%d", g_device_status.fan_power);
-    ADD_PROPERTY("heater_power", "%d", g_device_status.heater_power);
-    ADD_PROPERTY("sprinkler_power", "%d", g_device_status.sprinkler_power);
-
-    if (remaining_len > 1) {
-        snprintf(p, remaining_len, "}");
-    } else {
-        data_payload[sizeof(data_payload) - 2] = '}';
-        data_payload[sizeof(data_payload) - 1] = '\0';
+    AtUrc_Init(&s_urc_framer, MQTT_On_Response_Line, MQTT_On_Recv, MQTT_On_Prompt);
+    TopicTrie_Init(&s_topic_trie);
+    for (size_t i = 0; i < sizeof(s_downlink_routes) / sizeof(s_downlink_routes[0]); i++)
+    {
+        if (TopicTrie_Insert(&s_topic_trie, s_downlink_routes[i].filter, (uint8_t)s_downlink_routes[i].kind) != 0)
+        {
+            printf("ERROR: Topic trie is full, increase TOPIC_TRIE_MAX_NODES.\r\n");
+        }
     }
-
-    // --- 构建完整的回复JSON ---
-    snprintf(final_json, sizeof(final_json),
-        "{\"id\":\"%s\",\"code\":200,\"msg\":\"success\",\"data\":%s}",
-        request_id,
-        data_payload);
-
-    // --- 构建回复Topic ---
-    snprintf(reply_topic, sizeof(reply_topic),
-        "$sys/%s/%s/thing/property/get_reply",
-        MQTT_PRODUCT_ID, MQTT_DEVICE_NAME);
-
-    // --- 构建并发送AT指令 ---
-    snprintf(g_cmd_buffer, CMD_BUFFER_SIZE,
-             "AT+QMTPUB=0,0,0,0,\"%s\",\"%s\"\r\n",
-             reply_topic, final_json);
-
-    return MQTT_Send_AT_Command(g_cmd_buffer, "OK", 5000);
-
+    s_rx_ready = true;
 }
 
 /**
- * @brief  从一个JSON格式的字符串中查找指定的键(key)，并解析其对应的字符串值。
- * @param buffer: 包含JSON内容的字符串。
- * @param key:    要查找的JSON键名。
- * @param result: 如果解析成功，字符串值将被存放在这个缓冲区中。
- * @param max_len: result缓冲区的最大长度，防止溢出。
- * @return int:   如果成功找到并解析了字符串，返回1；否则返回0。
+ * @brief  把串口接收环形缓冲区中的新数据全部交给分帧器
+ * @note   主循环、AT 指令等待与 delay_ms 的空闲钩子都调用它；每个字节只经过分帧器一次
  */
-static int find_and_parse_json_string(const char* buffer, const char* key, char* result, int max_len)
+static void MQTT_Rx_Pump(void)
 {
-    char search_key[64];
-    snprintf(search_key, sizeof(search_key), "\"%s\":", key);
-
-    char* p_key = strstr(buffer, search_key);
-    if (p_key == NULL) return 0;
-
-    char* p_val_start = p_key + strlen(search_key);
-
-    while (*p_val_start && isspace((unsigned char)*p_val_start)) p_val_start++;
-    if (*p_val_start != '\"') return 0;
-    p_val_start++;
-
-    char* p_val_end = strchr(p_val_start, '\"');
-    if (p_val_end == NULL) return 0;
-
-    int val_len = p_val_end - p_val_start;
-    if (val_len >= max_len) val_len = max_len - 1;
-
-    memcpy(result, p_val_start, val_len);
-    result[val_len] = '\0';
+    static bool pumping = false;
+    uint8_t chunk[64];
+    uint16_t n;
 
-    return 1;
+    if (!s_rx_ready)
+    {
+        MQTT_Rx_Init();
+    }
+    if (pumping)
+    {
+        return;
+    }
+    pumping = true;
+    while ((n = USART1_ReadRx(chunk, sizeof(chunk))) > 0)
+    {
+        AtUrc_Feed(&s_urc_framer, chunk, n);
+    }
+    pumping = false;
 }
 
-
 /**
- * @brief  从一个JSON格式的字符串中查找指定的键(key)，并解析其对应的整数值。
- * @param buffer: 包含JSON内容的字符串。
- * @param key:    要查找的JSON键名。
- * @param result: 如果解析成功，整数值将被存放在这个指针指向的地址。
- * @return int:   如果成功找到并解析了整数，返回1；否则返回0。
+ * @brief  delay_ms 的空闲钩子：任何等待期间 (传感器转换、蜂鸣、AT 应答) 每毫秒唤醒一次分帧器，
+ *         属性设置与服务调用因此不必等主循环转回 Handle_Serial_Reception 才执行
  */
-static int find_and_parse_json_int(const char* buffer, const char* key, int* result)
+static void MQTT_Rx_Idle_Hook(void)
 {
-    char search_key[64];
-    // 1. 构造要搜索的键格式
-    snprintf(search_key, sizeof(search_key), "\"%s\"", key);
-
-    // 2. 查找键的位置
-    char* p_key = strstr(buffer, search_key);
-    if (p_key == NULL) {
-        return 0; // 没找到键
-    }
-
-    // 3. 移动指针到键的末尾
-    char* p_val = p_key + strlen(search_key);
-
-    // 4. 跳过键和冒号之间的所有空格
-    while (*p_val && isspace((unsigned char)*p_val)) {
-        p_val++;
+    if (s_rx_ready)
+    {
+        MQTT_Rx_Pump();
     }
+}
 
-    // 5. 检查后面是否是冒号
-    if (*p_val != ':') {
-        return 0; // 格式错误，键后面不是冒号
+// 功率类属性的范围限制
+static int32_t MQTT_Clamp_Power(int32_t value, const char* name)
+{
+    if (value < MIN_POWER) {
+        printf("WARN: %s value below minimum, clamped to %d%%\r\n", name, MIN_POWER);
+        return MIN_POWER;
     }
-    p_val++; // 跳过冒号
-
-    // 6. 使用strtol进行安全的字符串到长整型转换
-    char* end_ptr;
-    long parsed_value = strtol(p_val, &end_ptr, 10);
-
-    // 7. 验证转换是否成功
-    // 如果p_val和end_ptr指向同一个地址，说明冒号后面第一个字符就不是数字，转换失败。
-    if (p_val == end_ptr) {
-        return 0; // 转换失败
+    if (value > MAX_POWER) {
+        printf("WARN: %s value above maximum, clamped to %d%%\r\n", name, MAX_POWER);
+        return MAX_POWER;
     }
-
-    // 8. 如果成功，将结果存入result指针
-    *result = (int)parsed_value;
-    return 1; // 成功
+    return value;
 }
 
-
-static int find_and_parse_json_float(const char* buffer, const char* key, float* result)
+/**
+ * @brief 云端直接控制三个继电器 (经执行器影子层，与主循环的写入保持一致)
+ */
+static void MQTT_Apply_Relays(uint8_t pump, uint8_t heater, uint8_t fan)
 {
-    char search_key[64];
-    snprintf(search_key, sizeof(search_key), "\"%s\"", key);
-
-    char* p_key = strstr(buffer, search_key);
-    if (p_key == NULL) return 0;
-
-    char* p_val = p_key + strlen(search_key);
-    while (*p_val && isspace((unsigned char)*p_val)) p_val++;
-    if (*p_val != ':') return 0;
-    p_val++;
-
-    char* end_ptr;
-    // 使用 strtof 函数将字符串转换为 float
-    float parsed_value = strtof(p_val, &end_ptr);
-
-    if (p_val == end_ptr) return 0; // 转换失败
-
-    *result = parsed_value;
-    return 1; // 成功
+    Actuator_Set(ACTUATOR_PUMP, pump);
+    Actuator_Set(ACTUATOR_HEATER, heater);
+    Actuator_Set(ACTUATOR_FAN, fan);
 }
 
 
 /**
  * @brief 统一处理所有从云平台接收到的MQTT消息，并增加回复状态检查
- * @param buffer: 指向串口接收缓冲区的指针
- * @note  此版本对每一次调用 MQTT_Send_Reply 都进行了返回值检查，
- *        并通过日志明确反馈回复指令是否成功发送给了4G模块。
+ * @param kind/method: 由主题路由得到的消息类型与服务标识符
+ * @param payload:     以 '\0' 结尾的负载
+ * @note  主题已由前缀树路由，负载只扫描一遍：每个键经完美哈希表交给对应的类型化处理函数，
+ *        解析耗时与报文长度成正比，与物模型中的属性数量无关。
+ *        属性设置与服务调用在分帧回调中执行，回复经 MQTT_Reply_Queue 排队；
+ *        属性获取与期望值回复由主循环处理，回复直接发送并检查返回值。
  */
-static void Process_MQTT_Message_Robust(const char* buffer)
+static void Process_MQTT_Message_Robust(DownlinkKind_t kind, const char* method, const char* payload, uint16_t payload_len)
 {
     // 定义一个布尔变量，用于统一记录回复指令的发送结果
     bool reply_sent_successfully = false;
+    DownlinkMessage_t msg;
+
     // 打印收到的原始消息，这是调试的第一步
-    printf("RECV: %s\r\n", buffer);
+    printf("RECV: %s\r\n", payload);
+
+    // 单遍扫描负载，收集所有关心的字段
+    memset(&msg, 0, sizeof(msg));
+    if (JsonScan_Parse(payload, payload_len, Downlink_On_Token, &msg) != 0)
+    {
+        printf("WARN: Downlink payload is not well-formed JSON, using fields parsed so far.\r\n");
+    }
 
-    // 尝试从消息中解析出 "id"，这是所有回复的凭证
-    char request_id[32] = {0};
-    if (!find_and_parse_json_string(buffer, "id", request_id, sizeof(request_id)))
+    // "id" 是所有回复的凭证
+    const char* request_id = msg.request_id;
+    if (!DL_HAS(&msg, DL_FIELD_ID))
     {
         // 如果消息里连 "id" 字段都没有，说明它不是一条需要回复的命令，直接忽略
         printf("DEBUG: Message received, but it has no 'id' field. No reply needed.\r\n");
         return;
     }
-	
-	delay_ms(200); 
-
-    
 
     // --- 判断是哪种命令，并处理 ---
-
-    // 1. 是不是“属性设置”命令？ (Topic 包含 /thing/property/set)
-    if (strstr(buffer, "/thing/property/set") != NULL)
+    switch (kind)
+    {
+    // 1. “属性设置”命令
+    case DOWNLINK_PROPERTY_SET:
     {
         printf("DEBUG: Received a 'Property Set' command.\r\n");
-        int parsed_value;
-
         char any_property_updated = 0;
 
-        // 尝试解析 crop_stage 参数
-        if (find_and_parse_json_int(buffer, "crop_stage", &parsed_value))
+        if (DL_HAS(&msg, DL_FIELD_CROP_STAGE))
         {
-            g_device_status.crop_stage=parsed_value;
+            g_device_status.crop_stage = msg.value[DL_FIELD_CROP_STAGE];
             printf("ACTION: Cloud set 'crop_stage' to %d\r\n", g_device_status.crop_stage);
-            any_property_updated=1;
+            MQTT_Store_Crop_Stage(g_device_status.crop_stage);
+            any_property_updated = 1;
         }
-
-        // 尝试解析 fan_power 参数
-        if (find_and_parse_json_int(buffer, "fan_power", &parsed_value))
+        if (DL_HAS(&msg, DL_FIELD_FAN_POWER))
         {
-            //  对接收到的值进行范围检查和限制
-            if (parsed_value < MIN_POWER) {
-                parsed_value = MIN_POWER;
-                printf("WARN: Fan power value below minimum, clamped to %d%%\r\n", MIN_POWER);
-            } else if (parsed_value > MAX_POWER) {
-                parsed_value = MAX_POWER;
-                printf("WARN: Fan power value above maximum, clamped to %d%%\r\n", MAX_POWER);
-            }
-
-            // 执行命令：更新全局变量
-            g_device_status.fan_power = parsed_value; 
+            g_device_status.fan_power = MQTT_Clamp_Power(msg.value[DL_FIELD_FAN_POWER], "Fan power");
             printf("ACTION: Cloud set 'fan_power' to %d%%\r\n", g_device_status.fan_power);
-            Fan_Set_Speed(g_device_status.fan_power); // 立即应用新的风扇功率设置
+            Actuator_Set(ACTUATOR_FAN_POWER, g_device_status.fan_power); // 立即应用新的风扇功率设置
             printf("ACTION: Fan speed adjusted to %d%%\r\n", g_device_status.fan_power);
-            any_property_updated=1;
+            any_property_updated = 1;
         }
-        // 尝试解析 heater_power 参数
-        if (find_and_parse_json_int(buffer, "heater_power", &parsed_value))
+        if (DL_HAS(&msg, DL_FIELD_HEATER_POWER))
         {
-            // 对接收到的值进行范围检查和限制
-            if (parsed_value < MIN_POWER) {parsed_value = MIN_POWER;printf("WARN: Heater power value below minimum, clamped to %d%%\r\n", MIN_POWER);} 
-            if (parsed_value > MAX_POWER) {parsed_value = MAX_POWER;printf("WARN: Heater power value above maximum, clamped to %d%%\r\n", MAX_POWER);}
-            // 执行命令：更新全局变量
-            g_device_status.heater_power = parsed_value; 
+            g_device_status.heater_power = MQTT_Clamp_Power(msg.value[DL_FIELD_HEATER_POWER], "Heater power");
             printf("ACTION: Cloud set 'heater_power' to %d%%\r\n", g_device_status.heater_power);
-            Heater_Set_Power(g_device_status.heater_power); // 立即应用新的加热器功率设置
+            Actuator_Set(ACTUATOR_HEATER_POWER, g_device_status.heater_power); // 立即应用新的加热器功率设置
             printf("ACTION: Heater power adjusted to %d%%\r\n", g_device_status.heater_power);
-            any_property_updated=1;
+            any_property_updated = 1;
         }
-        // 尝试解析 sprinkler_power 参数
-        if (find_and_parse_json_int(buffer, "sprinkler_power", &parsed_value))
+        if (DL_HAS(&msg, DL_FIELD_SPRINKLER_POWER))
         {
-            // 对接收到的值进行范围检查和限制
-            if (parsed_value < MIN_POWER) {parsed_value = MIN_POWER;printf("WARN: Sprinkler power value below minimum, clamped to %d%%\r\n", MIN_POWER);}
-            if (parsed_value > MAX_POWER) {parsed_value = MAX_POWER;printf("WARN: Sprinkler power value above maximum, clamped to %d%%\r\n", MAX_POWER);}
-            // 执行命令：更新全局变量
-            g_device_status.sprinkler_power = parsed_value; 
+            g_device_status.sprinkler_power = MQTT_Clamp_Power(msg.value[DL_FIELD_SPRINKLER_POWER], "Sprinkler power");
             printf("ACTION: Cloud set 'sprinkler_power' to %d%%\r\n", g_device_status.sprinkler_power);
-            Sprinkler_Set_Power(g_device_status.sprinkler_power); // 立即应用新的洒水器功率设置
+            Actuator_Set(ACTUATOR_SPRINKLER_POWER, g_device_status.sprinkler_power); // 立即应用新的洒水器功率设置
             printf("ACTION: Sprinkler power adjusted to %d%%\r\n", g_device_status.sprinkler_power);
-            any_property_updated=1;
+            any_property_updated = 1;
         }
-        if (find_and_parse_json_int(buffer, "pressure", &parsed_value)) 
+        if (DL_HAS(&msg, DL_FIELD_PRESSURE))
         {
+            int32_t parsed_value = msg.value[DL_FIELD_PRESSURE];
             //范围限制
             if (parsed_value<pressure_MIN) {parsed_value = pressure_MIN;printf("WARN: Pressure value below minimum, clamped to %d hPa\r\n", (int)pressure_MIN);}
             if (parsed_value>pressure_MAX) {parsed_value = pressure_MAX;printf("WARN: Pressure value above maximum, clamped to %d hPa\r\n", (int)pressure_MAX);}
-            // 执行命令：更新全局变量
-            g_device_status.pressure=parsed_value;
+            g_device_status.pressure = parsed_value;
             printf("ACTION: Cloud set 'pressure' to %d%%\r\n", g_device_status.pressure);
-            any_property_updated=1;
+            MQTT_Store_Pressure(g_device_status.pressure);
+            any_property_updated = 1;
         }
+
         if (any_property_updated)
         {
             // 只要至少有一个参数被成功设置，就回复成功
-            reply_sent_successfully = MQTT_Send_Reply(request_id, REPLY_TO_PROPERTY_SET, NULL, 200, "Success");
+            reply_sent_successfully = MQTT_Reply_Queue(request_id, REPLY_TO_PROPERTY_SET, NULL, 200, "Success");
         }
         else
         {
             // 如果消息中一个可识别的参数都没有，说明是无效请求
             printf("WARN: Property Set command received, but no valid parameters found.\r\n");
-            reply_sent_successfully = MQTT_Send_Reply(request_id, REPLY_TO_PROPERTY_SET, NULL, 400, "Bad Request");
+            reply_sent_successfully = MQTT_Reply_Queue(request_id, REPLY_TO_PROPERTY_SET, NULL, 400, "Bad Request");
         }
+        break;
     }
-    // 2.是不是“服务调用”命令？
-    // 判断逻辑：只要同时包含 "/thing/service/" 和 "/invoke"，就认为是服务调用
-    else if (strstr(buffer, "/thing/service/") != NULL && strstr(buffer, "/invoke") != NULL)
+
+    // 2. “服务调用”命令，服务标识符取自主题
+    case DOWNLINK_SERVICE_INVOKE:
     {
         printf("DEBUG: Received a 'Service Invoke' command.\r\n");
-        char method[64] = {0};
-
-        // 尝试从 Topic 中提取 method (服务标识符)
-        // 这是一个更稳健的方法，直接从Topic获取服务名
-        const char *p_start = strstr(buffer, "/thing/service/");
-        if (p_start != NULL) {
-            p_start += strlen("/thing/service/"); // 移动指针到服务名开始的位置
-            const char *p_end = strstr(p_start, "/invoke");
-            if (p_end != NULL) {
-                int len = p_end - p_start;
-                if (len < sizeof(method)) {
-                    strncpy(method, p_start, len);
-                    method[len] = '\0';
-                }
-            }
-        }
 
-        // 判断具体是哪个服务
         if (strcmp(method, "set_intervention") == 0)
         {
             printf("DEBUG: Service is 'set_intervention'.\r\n");
-            int parsed_status;
 
-            // 尝试解析该服务需要的参数
-            if (find_and_parse_json_int(buffer, "method", &parsed_status))
+            if (DL_HAS(&msg, DL_FIELD_METHOD))
             {
-                g_device_status.intervention_status = parsed_status; 
+                g_device_status.intervention_status = msg.value[DL_FIELD_METHOD];
                 printf("ACTION: Cloud invoked 'set_intervention' with status %d\r\n", g_device_status.intervention_status);
                 printf("ACTION: Executing hardware control...\r\n");
                 switch (g_device_status.intervention_status)
                 {
-                    case 0: Water_Pump_OFF(); Heater_OFF(); Fan_OFF(); break;
-                    case 1: Water_Pump_ON(); Heater_OFF(); Fan_OFF(); break;
-                    case 2: Water_Pump_OFF(); Heater_OFF(); Fan_ON(); break;
-                    case 3: Water_Pump_OFF(); Heater_ON(); Fan_OFF(); break;
-                    case 4: Water_Pump_OFF(); Heater_ON(); Fan_ON(); break;
+                    case 0: MQTT_Apply_Relays(0, 0, 0); break;
+                    case 1: MQTT_Apply_Relays(1, 0, 0); break;
+                    case 2: MQTT_Apply_Relays(0, 0, 1); break;
+                    case 3: MQTT_Apply_Relays(0, 1, 0); break;
+                    case 4: MQTT_Apply_Relays(0, 1, 1); break;
                     default: printf("WARN: Unknown intervention status %d\r\n", g_device_status.intervention_status);
                 }
-                // 尝试发送“成功”的回复，并记录结果
-                reply_sent_successfully = MQTT_Send_Reply(request_id, REPLY_TO_SERVICE_INVOKE, method, 200, "Intervention status updated");
+                // 排队“成功”的回复，并记录结果
+                reply_sent_successfully = MQTT_Reply_Queue(request_id, REPLY_TO_SERVICE_INVOKE, method, 200, "Intervention status updated");
             }
             else
             {
                 // 如果没找到 method 参数，这是客户端的请求错误
                 printf("WARN: 'method' parameter not found for 'set_intervention' service.\r\n");
-                reply_sent_successfully = MQTT_Send_Reply(request_id, REPLY_TO_SERVICE_INVOKE, method, 400, "Bad Request");
+                reply_sent_successfully = MQTT_Reply_Queue(request_id, REPLY_TO_SERVICE_INVOKE, method, 400, "Bad Request");
             }
         }
         else
         {
             // 如果服务名不认识，回复404错误
             printf("WARN: Received invoke for an unknown or unparsed service: '%s'.\r\n", method);
-            reply_sent_successfully = MQTT_Send_Reply(request_id, REPLY_TO_SERVICE_INVOKE, method, 404, "Service not found");
+            reply_sent_successfully = MQTT_Reply_Queue(request_id, REPLY_TO_SERVICE_INVOKE, method, 404, "Service not found");
         }
+        break;
     }
 
-    // 3.是不是“属性获取”命令？
-    else if (strstr(buffer, "/thing/property/get") != NULL)
+    // 3. “属性获取”命令
+    case DOWNLINK_PROPERTY_GET:
     {
         printf("DEBUG: Received a 'Property Get' command.\r\n");
         // 尝试找到 "params" 字段的位置
-        char* params_start = strstr(buffer, "\"params\":");
+        const char* params_start = strstr(payload, "\"params\":");
         if (params_start != NULL)
         {
             // 找到了 "params" 字段，调用处理函数来构建回复
@@ -796,23 +1776,23 @@ static void Process_MQTT_Message_Robust(const char* buffer)
         {
             // 如果没找到 params 字段，这是客户端的请求错误
             printf("WARN: 'params' array not found in Property Get command.\r\n");
-            // 发送“请求错误”的回复，并记录结果
-            //reply_sent_successfully = MQTT_Send_Reply(request_id, REPLY_TO_PROPERTY_GET, NULL, 400, "Bad Request");
             reply_sent_successfully = MQTT_Send_Reply(request_id, REPLY_TO_SERVICE_INVOKE, NULL, 400, "Bad Request");
         }
+        break;
     }
-    // 4.是不是“期望属性获取回复”消息？
-    else if (strstr(buffer, "/thing/property/desired/get/reply") != NULL)
+
+    // 4. “期望属性获取回复”消息
+    case DOWNLINK_DESIRED_GET_REPLY:
     {
         printf("DEBUG: Received a 'Desired Property Get Reply'.\r\n");
-        int parsed_value;
 
-        // 尝试从回复的 data 对象中解析 crop_stage 的值
-        if (find_and_parse_json_int(buffer, "crop_stage", &parsed_value))
+        // 回复的 data 对象中 crop_stage 可以是数字，也可以是 {"value":n} 形式
+        if (DL_HAS(&msg, DL_FIELD_CROP_STAGE))
         {
             // 解析成功，立即更新本地状态
-            g_device_status.crop_stage = parsed_value;
+            g_device_status.crop_stage = msg.value[DL_FIELD_CROP_STAGE];
             printf("ACTION: Synchronized 'crop_stage' from cloud, new value is %d\r\n\r\n", g_device_status.crop_stage);
+            MQTT_Store_Crop_Stage(g_device_status.crop_stage);
         }
         else
         {
@@ -821,20 +1801,27 @@ static void Process_MQTT_Message_Robust(const char* buffer)
         return;
     }
 
-    else
-    {
-        // 如果收到的消息包含了 "id"，但 Topic 既不是 property/set 也不是 service/invoke
-        // 这可能是其他我们尚未处理的系统消息，比如 property/post/reply 等
+    default:
+        // 路由表中有、但这里尚未处理的消息类型
         printf("DEBUG: Received a message with 'id' on an unhandled topic. No reply needed.\r\n");
         return; // 直接返回，不进入最后的日志打印环节
     }
     // --- 结束命令处理部分 ---
+    // 快速通道的回复已排队，发送结果由 MQTT_Reply_Flush 打印
+    if (kind != DOWNLINK_PROPERTY_GET)
+    {
+        if (!reply_sent_successfully)
+        {
+            printf("ERROR: Reply for request_id '%s' could not be queued.\r\n\r\n", request_id);
+        }
+        return;
+    }
     // 在函数的最后，根据 reply_sent_successfully 的值，打印最终的执行结果日志
-    if (reply_sent_successfully) 
+    if (reply_sent_successfully)
     {
         printf("INFO: Reply for request_id '%s' was successfully sent to the 4G module.\r\n\r\n", request_id);
-    } 
-    else 
+    }
+    else
     {
         printf("FATAL ERROR: FAILED to send reply for request_id '%s' to the 4G module. The module did not respond with 'OK' within the timeout period. This is the likely cause of the platform timeout!\r\n\r\n", request_id);
     }
@@ -845,32 +1832,15 @@ static void Process_MQTT_Message_Robust(const char* buffer)
  */
 static void MQTT_Publish_Only_Temperatures(float temp1, float temp2, float temp3, float temp4)
 {
-    // 每次调用都增加消息ID，确保与云端同步
-    g_message_id++;
-    // 1. 构建只包含四个温度属性的 'params' JSON 负载
-    sprintf(g_json_payload, 
-        "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
-        "\"temp1\":{\"value\":%.1f},"
-        "\"temp2\":{\"value\":%.1f},"
-        "\"temp3\":{\"value\":%.1f},"
-        "\"temp4\":{\"value\":%.1f}"
-        "}}",
-        g_message_id,
-        temp1, temp2, temp3, temp4
-    );
-
-    // 2. 构建 AT+QMTPUB 指令，Topic 保持不变
-    //    "$sys/{product_id}/{device_name}/thing/property/post"
-    sprintf(g_cmd_buffer, "AT+QMTPUB=0,0,0,0,\"$sys/%s/%s/thing/property/post\",\"%s\"\r\n",
-            MQTT_PRODUCT_ID, 
-            MQTT_DEVICE_NAME,
-            g_json_payload);
-
-    // 3. 通过串口发送指令
-    USART1_SendString(g_cmd_buffer);
-
-    // 4. 等待模块处理和发送
-    delay_ms(1100); // 因为报文变短了，延时可以适当缩短
+    // 1. 每次调用都增加消息ID，确保与云端同步；Topic 为 "$sys/{product_id}/{device_name}/thing/property/post"
+    JsonStream_t* w = MQTT_Property_Post_Begin();
+
+    // 2. 只包含四个温度属性的 'params'，直接写入串口发送缓冲区
+    MQTT_Property_Fixed(w, "temp1", temp1, 1);
+    MQTT_Property_Fixed(w, "temp2", temp2, 1);
+    MQTT_Property_Fixed(w, "temp3", temp3, 1);
+    MQTT_Property_Fixed(w, "temp4", temp4, 1);
+    MQTT_Property_Post_End(w);
 }
 
 
@@ -881,33 +1851,31 @@ static void MQTT_Publish_Only_Temperatures(float temp1, float temp2, float temp3
  */
 static void MQTT_Publish_Environment_Data(float ambient_temp, float humidity, int pressure, float wind_speed)
 {
-    // 每次调用都增加消息ID
-    g_message_id++;
-    // 1. 构建包含四个环境属性的 'params' JSON 负载
-    snprintf(g_json_payload, JSON_PAYLOAD_SIZE, 
-        "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
-        "\"ambient_temp\":{\"value\":%.1f},"
-        "\"humidity\":{\"value\":%.1f},"
-        "\"pressure\":{\"value\":%d},"
-        "\"wind_speed\":{\"value\":%.1f}"
-        "}}",
-        g_message_id,
-        ambient_temp, humidity, pressure, wind_speed
-    );
+    // 1. 包含四个环境属性的 'params'
+    JsonStream_t* w = MQTT_Property_Post_Begin();
+
+    MQTT_Property_Fixed(w, "ambient_temp", ambient_temp, 1);
+    MQTT_Property_Fixed(w, "humidity", humidity, 1);
+    MQTT_Property_Int(w, "pressure", pressure);
+    MQTT_Property_Fixed(w, "wind_speed", wind_speed, 1);
+    MQTT_Property_Post_End(w);
+}
 
-    // 2. 构建 AT+QMTPUB 指令，Topic 保持不变
-    //    "$sys/{product_id}/{device_name}/thing/property/post"
-    snprintf(g_cmd_buffer, CMD_BUFFER_SIZE, 
-            "AT+QMTPUB=0,0,0,0,\"$sys/%s/%s/thing/property/post\",\"%s\"\r\n",
-            MQTT_PRODUCT_ID, 
-            MQTT_DEVICE_NAME,
-            g_json_payload);
 
-    // 3. 通过串口发送指令
-    USART1_SendString(g_cmd_buffer);
 
-    // 4. 等待模块处理和发送
-    delay_ms(1100); // 这是一个中等长度的报文，延时1.5秒
+/**
+ * @brief 上报一个统计窗口内各通道的摘要，温度通道与环境通道各一条
+ */
+static void MQTT_Publish_Window_Stats(const SensorWindow_t* win)
+{
+    JsonStream_t* w = MQTT_Property_Post_Begin();
+    MQTT_Property_Window_Stats(w, win, STATS_CH_TEMP1, 4);
+    MQTT_Property_Post_End(w);
+
+    w = MQTT_Property_Post_Begin();
+    MQTT_Property_Window_Stats(w, win, STATS_CH_AMBIENT, STATS_CH_COUNT - STATS_CH_AMBIENT);
+    MQTT_Property_Uint(w, "window_s", win->duration_ms / 1000);
+    MQTT_Property_Post_End(w);
 }
 
 
@@ -918,44 +1886,11 @@ static void MQTT_Publish_Environment_Data(float ambient_temp, float humidity, in
  */
 static void MQTT_Publish_Intervention_Status(int intervention_status)
 {
-    
-    // 每次调用都增加消息ID，确保每个消息的ID唯一
-    g_message_id++;
-    
-
-    // 1. 构建包含 intervention_status 属性的 'params' JSON 负载
-    int json_len = snprintf(g_json_payload, JSON_PAYLOAD_SIZE, 
-        "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
-        "\"intervention_status\":{\"value\":%d}"
-        "}}",
-        g_message_id,
-        intervention_status
-    );
-    
-    
-    //暂时注释掉
-    /*
-    if (json_len < 0 || json_len >= JSON_PAYLOAD_SIZE) {
-        USART1_SendString("ERROR: Intervention status JSON buffer overflow!\r\n");
-        return;
-    }
-    */
+    // 1. 包含 intervention_status 属性的 'params'
+    JsonStream_t* w = MQTT_Property_Post_Begin();
 
-    // 2. 构建 AT+QMTPUB 指令，Topic 保持不变
-    //    "$sys/{product_id}/{device_name}/thing/property/post"
-    snprintf(g_cmd_buffer, CMD_BUFFER_SIZE, 
-            "AT+QMTPUB=0,0,0,0,\"$sys/%s/%s/thing/property/post\",\"%s\"\r\n",
-            MQTT_PRODUCT_ID, 
-            MQTT_DEVICE_NAME,
-            g_json_payload);
-    
-
-    // 3. 通过串口发送指令
-    USART1_SendString(g_cmd_buffer);
-    
-
-    // 4. 等待模块处理和发送 (对于短报文，可以适当缩短延时)
-    delay_ms(1100); 
+    MQTT_Property_Int(w, "intervention_status", intervention_status);
+    MQTT_Property_Post_End(w);
 }
 
 
@@ -970,82 +1905,168 @@ static void MQTT_Publish_Intervention_Status(int intervention_status)
  */
 static void MQTT_Publish_Devices_Availability(int sprinklers_available, int fans_available, int heaters_available)
 {
-    // 每次调用都增加消息ID
-    g_message_id++;
-
-    // 1. 构建包含三个可用性属性的 'params' JSON 负载
-    //    直接使用 %d 格式化整数 0 或 1
-    int json_len = snprintf(g_json_payload, JSON_PAYLOAD_SIZE, 
-        "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
-        "\"sprinklers_available\":{\"value\":%d},"
-        "\"fans_available\":{\"value\":%d},"
-        "\"heaters_available\":{\"value\":%d}"
-        "}}",
-        g_message_id,
-        sprinklers_available, fans_available, heaters_available
-    );
-
-    // [健壮性检查]
-    if (json_len < 0 || json_len >= JSON_PAYLOAD_SIZE) {
-        printf("ERROR: Devices availability JSON buffer overflow!\r\n");
-        return;
-    }
-
-    // 打印生成的Payload供调试查看，确保格式为 {"value":1} 或 {"value":0}
-    printf("DEBUG: Generated Payload: %s\r\n", g_json_payload);
-
-    // 2. 构建 AT+QMTPUB 指令 (保持不变)
-    snprintf(g_cmd_buffer, CMD_BUFFER_SIZE, 
-            "AT+QMTPUB=0,0,0,0,\"$sys/%s/%s/thing/property/post\",\"%s\"\r\n",
-            MQTT_PRODUCT_ID, 
-            MQTT_DEVICE_NAME,
-            g_json_payload);
+    // 1. 包含三个可用性属性的 'params'，取值为整数 0 或 1
+    JsonStream_t* w = MQTT_Property_Post_Begin();
 
-    // 3. 通过串口发送指令
-    USART1_SendString(g_cmd_buffer);
+    MQTT_Property_Int(w, "sprinklers_available", sprinklers_available);
+    MQTT_Property_Int(w, "fans_available", fans_available);
+    MQTT_Property_Int(w, "heaters_available", heaters_available);
+    MQTT_Property_Post_End(w);
 
-    // 4. 等待模块处理和发送
-    delay_ms(1100); 
+    // 打印报文长度供调试查看 (报文本身已直接进入发送缓冲区)
+    printf("DEBUG: Devices availability published, %lu bytes\r\n", (unsigned long)w->total);
 }
 
 
 /**
- * @brief 上报风扇、加热器和洒水器的当前功率
+ * @brief 上报风扇、加热器和洒水器的当前功率，以及执行器累计开关次数
  * @param fan_power         当前风扇功率值
  * @param heater_power      当前加热器功率值
  * @param sprinkler_power   当前洒水器功率值
+ * @param actuator_switches 执行器累计开关次数
  */
- static void MQTT_Publish_Device_Powers(int fan_power, int heater_power, int sprinkler_power)
+ static void MQTT_Publish_Device_Powers(int fan_power, int heater_power, int sprinkler_power, uint32_t actuator_switches)
  {
-     g_message_id++;
-     // 构建包含三个设备功率属性的 'params' JSON 负载
-     snprintf(g_json_payload, JSON_PAYLOAD_SIZE, 
-         "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
-         "\"fan_power\":{\"value\":%d},"
-         "\"heater_power\":{\"value\":%d},"
-         "\"sprinkler_power\":{\"value\":%d}"
-         "}}",
-         g_message_id,
-         fan_power,
-         heater_power,
-         sprinkler_power
-     );
- 
-     // 构建 AT+QMTPUB 指令
-     snprintf(g_cmd_buffer, CMD_BUFFER_SIZE, 
-             "AT+QMTPUB=0,0,0,0,\"$sys/%s/%s/thing/property/post\",\"%s\"\r\n",
-             MQTT_PRODUCT_ID, 
-             MQTT_DEVICE_NAME,
-             g_json_payload);
- 
-     // 通过串口发送指令
-     USART1_SendString(g_cmd_buffer);
-     delay_ms(1100); 
+     // 包含三个设备功率属性与执行器切换次数的 'params'
+     JsonStream_t* w = MQTT_Property_Post_Begin();
+
+     MQTT_Property_Int(w, "fan_power", fan_power);
+     MQTT_Property_Int(w, "heater_power", heater_power);
+     MQTT_Property_Int(w, "sprinkler_power", sprinkler_power);
+     MQTT_Property_Uint(w, "actuator_switches", actuator_switches);
+     MQTT_Property_Post_End(w);
  }
 
 
 
 
+// actuator_usage 属性 (结构体类型)
+static void MQTT_Property_Actuator_Usage(JsonStream_t* w)
+{
+    JsonStream_Object_Begin(w, "actuator_usage");
+    JsonStream_Object_Begin(w, "value");
+    Actuator_Write_Json(w);
+    JsonStream_Object_End(w);
+    JsonStream_Object_End(w);
+}
+
+/**
+ * @brief 上报各执行器的切换次数、累计开启时间与折算满功率时间 (actuator_usage 属性，结构体类型)
+ * @note  计长发布模式下已并入 MQTT_Publish_All_Properties 的同一条上报：暂存区只有一个，
+ *        紧接着的第二条计长发布总会赶上第一条还在等 PUBACK
+ */
+void MQTT_Publish_Actuator_Usage(void)
+{
+    if (!MQTT_Is_Online() || (MQTT_PUBLISH_PROMPT && !MQTT_TELEMETRY_BINARY))
+    {
+        return;
+    }
+
+    JsonStream_t* w = MQTT_Property_Post_Begin();
+    MQTT_Property_Actuator_Usage(w);
+    MQTT_Property_Post_End(w);
+}
+
+
+#if PROFILE_ENABLE
+/**
+ * @brief 上报主循环各阶段耗时统计 (loop_profile 属性，结构体类型)
+ */
+void MQTT_Publish_Loop_Profile(void)
+{
+    if (!MQTT_Is_Online())
+    {
+        return;
+    }
+
+    JsonStream_t* w = MQTT_Property_Post_Begin();
+
+    JsonStream_Object_Begin(w, "loop_profile");
+    JsonStream_Object_Begin(w, "value");
+    Profile_Write_Json(w);
+    JsonStream_Object_End(w);
+    JsonStream_Object_End(w);
+    MQTT_Property_Post_End(w);
+}
+#endif
+
+
+/**
+ * @brief 计长发布模式下把全部属性 (含 actuator_usage) 合并为一条上报
+ * @note  负载约 850 字节，超过单行 AT 指令能容纳的长度，只能走计长发布
+ */
+static void MQTT_Publish_All_Properties(const DeviceStatus* status)
+{
+    JsonStream_t* w = MQTT_Property_Post_Begin();
+
+    MQTT_Property_Fixed(w, "ambient_temp", status->ambient_temp, 1);
+    MQTT_Property_Fixed(w, "humidity", status->humidity, 1);
+    MQTT_Property_Int(w, "pressure", status->pressure);
+    MQTT_Property_Fixed(w, "wind_speed", status->wind_speed, 1);
+    MQTT_Property_Fixed(w, "temp1", status->temp1, 1);
+    MQTT_Property_Fixed(w, "temp2", status->temp2, 1);
+    MQTT_Property_Fixed(w, "temp3", status->temp3, 1);
+    MQTT_Property_Fixed(w, "temp4", status->temp4, 1);
+    MQTT_Property_Int(w, "intervention_status", status->intervention_status);
+    MQTT_Property_Int(w, "fan_power", status->fan_power);
+    MQTT_Property_Int(w, "heater_power", status->heater_power);
+    MQTT_Property_Int(w, "sprinkler_power", status->sprinkler_power);
+    MQTT_Property_Uint(w, "actuator_switches", status->actuator_switches);
+    MQTT_Property_Int(w, "sprinklers_available", status->sprinklers_available);
+    MQTT_Property_Int(w, "fans_available", status->fans_available);
+    MQTT_Property_Int(w, "heaters_available", status->heaters_available);
+    if (status->window != NULL)
+    {
+        MQTT_Property_Window_Stats(w, status->window, 0, STATS_CH_COUNT);
+        MQTT_Property_Uint(w, "window_s", status->window->duration_ms / 1000);
+    }
+    MQTT_Property_Actuator_Usage(w);
+    MQTT_Property_Post_End(w);
+}
+
+
+static uint16_t s_telemetry_seq = 0;
+
+/**
+ * @brief 以一条二进制记录上报全部属性 (Base64 编码后发布到自定义主题)
+ * @note  32 字节记录编码后 44 字符，整条指令约 110 字节，而五条文本 JSON 上报合计约 1 KB
+ */
+static void MQTT_Publish_Telemetry_Binary(const DeviceStatus* status)
+{
+    TelemetryBin_Record_t r;
+    uint8_t record[TELEMETRY_BIN_SIZE];
+    char text[TELEMETRY_BIN_BASE64_SIZE + 1];
+
+    r.seq = s_telemetry_seq++;
+    r.temps[0] = status->temp1;
+    r.temps[1] = status->temp2;
+    r.temps[2] = status->temp3;
+    r.temps[3] = status->temp4;
+    r.ambient_temp = status->ambient_temp;
+    r.humidity = status->humidity;
+    r.pressure = status->pressure;
+    r.wind_speed = status->wind_speed;
+    r.intervention_status = (uint8_t)status->intervention_status;
+    r.crop_stage = (uint8_t)status->crop_stage;
+    r.fan_power = (uint8_t)status->fan_power;
+    r.heater_power = (uint8_t)status->heater_power;
+    r.sprinkler_power = (uint8_t)status->sprinkler_power;
+    r.available = (status->sprinklers_available ? TELEMETRY_AVAIL_SPRINKLERS : 0) |
+                  (status->fans_available ? TELEMETRY_AVAIL_FANS : 0) |
+                  (status->heaters_available ? TELEMETRY_AVAIL_HEATERS : 0);
+    r.actuator_switches = status->actuator_switches;
+    TelemetryBin_Base64(record, TelemetryBin_Encode(&r, record), text);
+
+    char head[24];
+    snprintf(head, sizeof(head), "AT+QMTPUB=0,%u,1,0,\"", MQTT_Inflight_Open(false));
+    JsonStream_t* w = MQTT_Cmd_Begin(head, false);
+    JsonStream_Raw(w, MQTT_TELEMETRY_BIN_TOPIC "\",\"");
+    JsonStream_Raw(w, text);
+    MQTT_Publish_End_Reliable(w);
+    printf("DEBUG: Binary telemetry record %u published, %lu bytes\r\n", r.seq, (unsigned long)w->total);
+}
+
+
 /**
  * @brief 统一上报所有传感器和状态数据
  * @param temp1                 监测点1温度
@@ -1061,104 +2082,81 @@ static void MQTT_Publish_Devices_Availability(int sprinklers_available, int fans
  * @param sprinklers_available  喷淋系统是否可用
  * @param fans_available        风机系统是否可用
  * @param heaters_available     加热系统是否可用
- * @note  此函数按顺序调用各个独立的数据上报函数，并在每次调用后加入短暂延时，
- *        以确保模块有足够的时间处理和发送每条消息。
+ * @note  各条上报均为 QoS 1：模组接受指令 ("OK") 后即发下一条，PUBACK 在后台确认，
+ *        最多 MQTT_INFLIGHT_WINDOW 条同时在途，不再在每条之后固定延时。
  */
  void MQTT_Publish_All_Data(const DeviceStatus* status)
  {
+     if (!MQTT_Is_Online())
+     {
+         printf("DEBUG: MQTT offline (%s), skipping this publish round.\r\n", s_conn_state_names[s_conn.state]);
+         return;
+     }
      printf("INFO: === Begin publishing all data from status struct ===\r\n");
-     // 1. 上报环境数据
-     printf("INFO: Publishing environment data...\r\n");
-     // 使用 -> 操作符通过指针访问结构体成员
-     MQTT_Publish_Environment_Data(status->ambient_temp, status->humidity, status->pressure, status->wind_speed);
-     // 2. 上报四个监测点温度
-     printf("INFO: Publishing point temperatures...\r\n");
-     MQTT_Publish_Only_Temperatures(status->temp1, status->temp2, status->temp3, status->temp4);
-     // 3. 上报人工干预状态
-     printf("INFO: Publishing intervention status...\r\n");
-     MQTT_Publish_Intervention_Status(status->intervention_status);
-     // 4. 上报设备功率
-     printf("INFO: Publishing device powers...\r\n");
-     MQTT_Publish_Device_Powers(status->fan_power, status->heater_power, status->sprinkler_power);
-     // 5. 上报设备可用性
-     printf("INFO: Publishing devices availability...\r\n");
-     MQTT_Publish_Devices_Availability(status->sprinklers_available, status->fans_available, status->heaters_available);
-     printf("INFO: === Finished publishing all data ===\r\n\r\n");
- }
-
-
-/**
- * @brief 处理串口接收的下行消息 (带空闲检测)
- * @note  此函数通过检测串口总线在一定时间内的“空闲”状态，来判断一条消息是否已完整接收。
- *        它应该在主循环中被持续调用。
- */
- /*
- void Handle_Serial_Reception(void)
- {
-     static unsigned int last_recv_num = 0;
-     static uint64_t last_recv_time = 0;
-     const uint32_t recv_idle_timeout_ms = 50; // 定义50毫秒为总线空闲超时
- 
-     // 检查串口接收缓冲区是否有数据
-     if (xUSART.USART1ReceivedNum > 0)
+     // 紧凑模式：全部属性合并为一条二进制记录 (用常量条件而非预处理，两条路径都参与编译检查)
+     if (MQTT_TELEMETRY_BINARY)
      {
-         // 如果当前的接收字节数 > 上次记录的字节数，说明有新数据进来
-         if (xUSART.USART1ReceivedNum > last_recv_num)
-         {
-             // 更新“最后一次接收到数据的时间戳”
-             last_recv_time = System_GetTimeMs();
-             // 更新“上次记录的字节数”
-             last_recv_num = xUSART.USART1ReceivedNum;
-         }
-         
-         // 检查“当前时间”与“最后一次接收到数据的时间”之差是否超过了空闲超时阈值
-         // 并且确保接收缓冲区里确实有数据 (last_recv_num > 0)
-         if ((last_recv_num > 0) && (System_GetTimeMs() - last_recv_time > recv_idle_timeout_ms))
+         printf("INFO: Publishing binary telemetry record...\r\n");
+         MQTT_Publish_Telemetry_Binary(status);
+     }
+     else if (MQTT_PUBLISH_PROMPT)
+     {
+         printf("INFO: Publishing all properties in one length-prefixed message...\r\n");
+         MQTT_Publish_All_Properties(status);
+     }
+     else
+     {
+         // 1. 上报环境数据
+         printf("INFO: Publishing environment data...\r\n");
+         // 使用 -> 操作符通过指针访问结构体成员
+         MQTT_Publish_Environment_Data(status->ambient_temp, status->humidity, status->pressure, status->wind_speed);
+         // 2. 上报四个监测点温度
+         printf("INFO: Publishing point temperatures...\r\n");
+         MQTT_Publish_Only_Temperatures(status->temp1, status->temp2, status->temp3, status->temp4);
+         // 2a. 窗口模式下上报各通道的最小/最大值与标准差 (温度一条，环境一条，避免超出单行指令长度)
+         if (status->window != NULL)
          {
-             // 如果超过了50ms没有新数据进来，我们判定这是一条完整的消息
-             printf("INFO: Full message received after idle period.\r\n");
-             
-             // --- 开始处理 ---
-             // 1. 在数据末尾添加字符串结束符
-             xUSART.USART1ReceivedBuffer[xUSART.USART1ReceivedNum] = '\0';
-             // 2. 调用统一的消息处理函数
-             Process_MQTT_Message_Robust((char*)xUSART.USART1ReceivedBuffer);                
-             
-             // --- 处理完毕后，彻底清零所有状态，为接收下一条消息做准备 ---
-             xUSART.USART1ReceivedNum = 0;
-             last_recv_num = 0;
+             printf("INFO: Publishing window %lu statistics...\r\n", (unsigned long)status->window->seq);
+             MQTT_Publish_Window_Stats(status->window);
          }
+         // 3. 上报人工干预状态
+         printf("INFO: Publishing intervention status...\r\n");
+         MQTT_Publish_Intervention_Status(status->intervention_status);
+         // 4. 上报设备功率
+         printf("INFO: Publishing device powers...\r\n");
+         MQTT_Publish_Device_Powers(status->fan_power, status->heater_power, status->sprinkler_power, status->actuator_switches);
+         // 5. 上报设备可用性
+         printf("INFO: Publishing devices availability...\r\n");
+         MQTT_Publish_Devices_Availability(status->sprinklers_available, status->fans_available, status->heaters_available);
      }
+     printf("INFO: === Finished publishing all data (%u awaiting PUBACK, acked %lu, retransmitted %lu, dropped %lu) ===\r\n\r\n",
+            MQTT_Inflight_Count(), (unsigned long)s_puback_count,
+            (unsigned long)s_retransmit_count, (unsigned long)s_publish_dropped);
  }
 
-*/
-
-
 
 /**
  * @brief 处理串口接收的下行消息
+ * @note  不再以一次 IDLE 中断为一帧：收到的字节流经分帧器切成完整的 URC，
+ *        +QMTRECV 按主题路由：属性设置与服务调用在分帧回调中立即执行 (delay_ms 的空闲钩子也会驱动分帧器)，
+ *        其余消息排队在这里逐条处理，排队的回复也在这里发出。它应该在主循环中被持续调用。
  */
 void Handle_Serial_Reception(void)
 {
-    // 步骤1：检查由IDLE中断服务程序设置的数据帧接收完成标志
-    if (xUSART.USART1RxFrameFlag == 1)
+    // 步骤1：把串口环形缓冲区中的新数据交给分帧器，命令就地执行，其余下行消息进入队列
+    MQTT_Rx_Pump();
+    MQTT_Connection_Service();
+    MQTT_Inflight_Service();
+    MQTT_Reply_Flush();
+
+    // 步骤2：逐条处理；处理中发送回复时到达的新消息排在队尾，处理完当前这条再出队
+    while (s_downlink_tail != s_downlink_head)
     {
-        // --- 开始处理接收到的完整数据帧 ---
-        printf("INFO: Full message received (IDLE interrupt detected).\r\n");
-        
-        // 步骤2：在数据末尾添加字符串结束符 '\0'
-        // 这对于后续使用strstr()等字符串函数至关重要
-        xUSART.USART1ReceivedBuffer[xUSART.USART1ReceivedNum] = '\0';
-        
-        // 步骤3：调用重量级的消息处理函数
-        Process_MQTT_Message_Robust((char*)xUSART.USART1ReceivedBuffer);                
-        
-        // 步骤4：处理完毕后，清空缓冲区计数和标志位，为接收下一帧做准备
-        // 必须在临界区内执行此操作，防止在清零期间被新的RXNE中断干扰
-        __disable_irq();
-        xUSART.USART1ReceivedNum = 0;
-        xUSART.USART1RxFrameFlag = 0; // 清除标志位，等待下一次中断
-        __enable_irq();
+        const DownlinkQueued_t* m = &s_downlink_queue[s_downlink_tail % DOWNLINK_QUEUE_DEPTH];
+
+        printf("INFO: Downlink message %u received.\r\n", m->msgid);
+        Process_MQTT_Message_Robust(m->kind, m->identifier, m->payload, m->payload_len);
+        s_downlink_tail++;
     }
 }
 
@@ -1177,16 +2175,20 @@ void MQTT_Publish_All_Data_Adapt(const SystemStatus_t* system_status)
         return;
     }
 
-    // 步骤1: 同步环境传感器数据
+    // 步骤1: 同步环境传感器数据；有统计窗口时温湿度与风速改用窗口均值 (窗口内无有效样本的通道仍用瞬时值)
     const EnvironmentalData_t* env = system_status->env_data;
-    g_device_status.temp1 = env->temperatures[0];
-    g_device_status.temp2 = env->temperatures[1];
-    g_device_status.temp3 = env->temperatures[2];
-    g_device_status.temp4 = env->temperatures[3];
-    g_device_status.ambient_temp = env->ambient_temp;
-    g_device_status.humidity = env->humidity;
-    g_device_status.wind_speed = env->wind_speed;
+    const SensorWindow_t* win = system_status->window;
+    #define MQTT_WINDOW_OR(c, instant)  ((win != NULL && win->ch[c].n > 0) ? win->ch[c].mean : (instant))
+    g_device_status.temp1 = MQTT_WINDOW_OR(STATS_CH_TEMP1, env->temperatures[0]);
+    g_device_status.temp2 = MQTT_WINDOW_OR(STATS_CH_TEMP2, env->temperatures[1]);
+    g_device_status.temp3 = MQTT_WINDOW_OR(STATS_CH_TEMP3, env->temperatures[2]);
+    g_device_status.temp4 = MQTT_WINDOW_OR(STATS_CH_TEMP4, env->temperatures[3]);
+    g_device_status.ambient_temp = MQTT_WINDOW_OR(STATS_CH_AMBIENT, env->ambient_temp);
+    g_device_status.humidity = MQTT_WINDOW_OR(STATS_CH_HUMIDITY, env->humidity);
+    g_device_status.wind_speed = MQTT_WINDOW_OR(STATS_CH_WIND, env->wind_speed);
+    #undef MQTT_WINDOW_OR
     g_device_status.pressure = env->pressure;
+    g_device_status.window = win;
 
     // 步骤2: 同步系统决策状态
     g_device_status.intervention_status = (int)system_status->method;
@@ -1194,6 +2196,7 @@ void MQTT_Publish_All_Data_Adapt(const SystemStatus_t* system_status)
     g_device_status.heater_power = system_status->Powers->heater_power;
     g_device_status.sprinkler_power = system_status->Powers->sprinkler_power;
     g_device_status.crop_stage = system_status->crop_stage;
+    g_device_status.actuator_switches = system_status->actuator_switches;
 
     // 步骤3: 同步设备可用性
     const SystemCapabilities_t* caps = system_status->capabilities;
@@ -1206,63 +2209,51 @@ void MQTT_Publish_All_Data_Adapt(const SystemStatus_t* system_status)
     MQTT_Publish_All_Data(&g_device_status);
 }
 
-
 /**
- * @brief  检查MQTT连接状态，如果断开则自动重连并重新订阅所有主题
- * @return bool: true 代表当前连接正常或重连成功, false 代表重连失败
- * @note   此函数应在主循环中定期调用。
+ * @brief  模组是否空闲：没有等待结果的连接步骤、未确认的发布、待发的回复与待处理的下行消息
+ * @note   供主循环安排会使 CPU 停顿的操作 (片内 Flash 擦除)，空闲时错过的只可能是主动上报的 URC
  */
-bool MQTT_Check_And_Reconnect(void)
+bool MQTT_Modem_Idle(void)
 {
-    // 步骤1：发送查询指令 "AT+QMTCONN?" 来获取客户端0的连接状态
-    // 根据Quectel手册，对于已连接的客户端，模块会回复 "+QMTCONN: 0,3"
-    // 如果未连接或状态异常，则不会包含这个特定的回复。
-    if (MQTT_Send_AT_Command("AT+QMTCONN?\r\n", "+QMTCONN: 0,3", 2000))
-    {
-        // 成功收到了预期的“已连接”回复，说明一切正常，直接返回true
-        printf("DEBUG: MQTT connection is active.\r\n");
-        return true;
-    }
-    // 备用检查：有时模块可能返回 "+QMTCONN: 0,2" 来表示连接已建立
-    // 但为了保险起见，我们也接受这个状态作为“连接正常”的标志
-    if (MQTT_Send_AT_Command("AT+QMTCONN?\r\n", "+QMTCONN: 0,2", 2000))
+    if (s_conn.waiting)
     {
-        // 成功收到了预期的“已连接”回复，说明一切正常，直接返回true
-        printf("DEBUG: MQTT connection is active.\r\n");
-        return true;
+        return false;
     }
-
-    // 步骤2：如果上面的指令失败或超时，说明连接已断开
-    printf("WARN: MQTT connection lost! Attempting to reconnect...\r\n");
-    
-    // 步骤3：执行完整的初始化和连接流程
-    if (Robust_Initialize_And_Connect_MQTT())
+    for (uint8_t i = 0; i < MQTT_INFLIGHT_WINDOW; i++)
     {
-        printf("SUCCESS: Reconnected to MQTT server.\r\n");
-        
-        // 步骤4：连接成功后，必须重新订阅所有需要的主题
-        printf("INFO: Resubscribing to all topics...\r\n");
-        if (MQTT_Subscribe_All_Topics())
-        {
-            printf("SUCCESS: All topics resubscribed.\r\n");
-            return true; // 整个恢复流程成功
-        }
-        else
+        if (s_inflight[i].msgid != 0)
         {
-            printf("FATAL: Reconnected but failed to resubscribe to topics.\r\n");
-            return false; // 重新订阅失败
+            return false;
         }
     }
-    else
+#if MQTT_PUBLISH_PROMPT
+    if (s_prompt.state != MQTT_PROMPT_IDLE)
+    {
+        return false;
+    }
+#endif
+    return s_reply_head == s_reply_tail && s_downlink_head == s_downlink_tail;
+}
+
+/**
+ * @brief  查询 MQTT 连接状态，未启动时开始后台连接
+ * @return bool: true 代表当前在线
+ * @note   不再发送 AT+QMTCONN? 探测：断线由模组的 +QMTSTAT 通知，重连由后台状态机完成，本函数立即返回。
+ */
+bool MQTT_Check_And_Reconnect(void)
+{
+    if (s_conn.state == MQTT_CONN_IDLE)
     {
-        printf("FATAL: Failed to reconnect to MQTT server. Will try again later.\r\n");
-        return false; // 重新连接失败
+        MQTT_Connection_Start();
     }
+    return MQTT_Is_Online();
 }
 
 void MQTT_Disconnect(void)
 {
     // 步骤1：发送断开指令 "AT+QMTDISC=0" 来断开客户端0的连接
+    s_conn.state = MQTT_CONN_IDLE;      // 主动断开，不再自动重连
+    s_conn.waiting = false;
     if (MQTT_Send_AT_Command("AT+QMTDISC=0\r\n", "+QMTDISC: 0,0", 2000))
     {
         printf("SUCCESS: MQTT connection successfully disconnected.\r\n");
@@ -4,6 +4,7 @@
 #include <stdbool.h> 
 #include <stdint.h>  
 #include "Frost_Detection.h" 
+#include "profile.h"
 /*
  ===============================================================================
                             1. 用户配置区域
@@ -15,6 +16,21 @@
 #define MQTT_DEVICE_NAME        "Yushuang_Tower_007"
 #define MQTT_PASSWORD_SIGNATURE "version=2018-10-31&res=products%2F30w1g93kaf%2Fdevices%2FYushuang_Tower_007&et=1790671501&method=md5&sign=F48CON9W%2FTkD6dPXA%2FKxgQ%3D%3D"
 
+// --- 紧凑二进制遥测 (make TELEMETRY_BIN=1) ---
+// 打开后每轮上报改为一条 32 字节二进制记录 (格式见 telemetry_bin.h)，代替五条文本 JSON 属性上报
+#ifndef MQTT_TELEMETRY_BINARY
+#define MQTT_TELEMETRY_BINARY   0
+#endif
+// 自定义主题：需在 OneNET 控制台为产品添加该主题并授予设备发布权限，由云端按 decode_telemetry.py 解码
+#define MQTT_TELEMETRY_BIN_TOPIC  MQTT_PRODUCT_ID "/" MQTT_DEVICE_NAME "/telemetry/bin"
+
+// --- 计长发布 (make PROMPT_PUB=1) ---
+// 打开后属性上报改用 AT+QMTPUB=...,<len> 加 '>' 提示符的方式，负载不在命令行内，
+// 每轮全部属性合并为一条上报
+#ifndef MQTT_PUBLISH_PROMPT
+#define MQTT_PUBLISH_PROMPT     0
+#endif
+
 /*
 #define FAN_MIN_POWER    20  // 最小功率 (%)
 #define FAN_MAX_POWER    80  // 最大功率 (%)
@@ -55,6 +71,10 @@ typedef struct {
     int heater_power; // 加热器当前功率 (%)
     // 灌溉器功率控制
     int sprinkler_power; // 灌溉器当前功率 (%)
+    // 执行器累计开关次数
+    uint32_t actuator_switches;
+    // 刚结束的统计窗口：非 NULL 时上面的温湿度与风速为窗口均值，并另外上报各通道的统计摘要
+    const SensorWindow_t* window;
 } DeviceStatus;
 
 // 声明一个全局的设备状态实例，供其他文件访问
@@ -66,8 +86,9 @@ extern DeviceStatus g_device_status;
                             3. 公开函数原型
  ===============================================================================
 */
-bool Robust_Initialize_And_Connect_MQTT(void);
-bool MQTT_Subscribe_All_Topics(void);
+void MQTT_Connection_Start(void);
+bool MQTT_Is_Online(void);
+bool MQTT_Modem_Idle(void);
 bool MQTT_Check_And_Reconnect(void);
 void MQTT_Disconnect(void);
 
@@ -79,5 +100,10 @@ void Handle_Serial_Reception(void);
 
 
 void MQTT_Publish_All_Data_Adapt(const SystemStatus_t* system_status);
+void MQTT_Publish_Actuator_Usage(void);
+
+#if PROFILE_ENABLE
+void MQTT_Publish_Loop_Profile(void);
+#endif
 
 #endif // __ONENET_MQTT_H
@@ -220,6 +220,29 @@ void DisplayButtonUp(u16 x1,u16 y1,u16 x2,u16 y2)
 }
 
 
+/**************************************************************************************
+功能描述: 连续写一个 16 行字模：整块只设一次显示窗口，再逐像素推送前景/背景色，
+          省去逐点绘制时每个像素都要重设窗口的 11 字节命令
+输    入: w 字宽 (8 或 16)，msk 每行 w/8 字节
+输    出: 无
+**************************************************************************************/
+static void Gui_Stream_Glyph16(u16 x, u16 y, u16 fc, u16 bc, const unsigned char *msk, u8 w)
+{
+	unsigned char i,j;
+	u16 bits;
+
+	// Lcd_SetRegion 的结束坐标会再加 2 列、1 行，这里先减去，使窗口正好是 w x 16
+	Lcd_SetRegion(x, y, x + w - 3, y + 14);
+	for(i=0;i<16;i++)
+	{
+		bits = (w == 16) ? ((msk[i*2] << 8) | msk[i*2+1]) : (msk[i] << 8);
+		for(j=0;j<w;j++)
+		{
+			LCD_WriteData_16Bit((bits & (0x8000 >> j)) ? fc : bc);
+		}
+	}
+}
+
 void Gui_DrawFont_GBK16(u16 x, u16 y, u16 fc, u16 bc, char *s)
 {
 	unsigned char i,j;
@@ -240,15 +263,17 @@ void Gui_DrawFont_GBK16(u16 x, u16 y, u16 fc, u16 bc, char *s)
 			{
 				if (k>32) k-=32; else k=0;
 	
-			    for(i=0;i<16;i++)
-				for(j=0;j<8;j++) 
-					{
-				    	if(asc16[k*16+i]&(0x80>>j))	Gui_DrawPoint(x+j,y+i,fc);
-						else 
-						{
-							if (fc!=bc) Gui_DrawPoint(x+j,y+i,bc);
-						}
-					}
+				if (fc!=bc)
+				{
+					Gui_Stream_Glyph16(x, y, fc, bc, &asc16[k*16], 8);
+				}
+				else
+				{
+					// 透明背景只画前景点
+					for(i=0;i<16;i++)
+						for(j=0;j<8;j++)
+							if(asc16[k*16+i]&(0x80>>j))	Gui_DrawPoint(x+j,y+i,fc);
+				}
 				x+=8;
 			}
 			s++;
@@ -262,26 +287,22 @@ void Gui_DrawFont_GBK16(u16 x, u16 y, u16 fc, u16 bc, char *s)
 			{
 			  if ((hz16[k].Index[0]==*(s))&&(hz16[k].Index[1]==*(s+1)))
 			  { 
+				if (fc!=bc)
+				{
+					Gui_Stream_Glyph16(x, y, fc, bc, (const unsigned char *)hz16[k].Msk, 16);
+				}
+				else
+				{
 				    for(i=0;i<16;i++)
 				    {
 						for(j=0;j<8;j++) 
-							{
-						    	if(hz16[k].Msk[i*2]&(0x80>>j))	Gui_DrawPoint(x+j,y+i,fc);
-								else {
-									if (fc!=bc) Gui_DrawPoint(x+j,y+i,bc);
-								}
-							}
+							if(hz16[k].Msk[i*2]&(0x80>>j))	Gui_DrawPoint(x+j,y+i,fc);
 						for(j=0;j<8;j++) 
-							{
-						    	if(hz16[k].Msk[i*2+1]&(0x80>>j))	Gui_DrawPoint(x+j+8,y+i,fc);
-								else 
-								{
-									if (fc!=bc) Gui_DrawPoint(x+j+8,y+i,bc);
-								}
-							}
+							if(hz16[k].Msk[i*2+1]&(0x80>>j))	Gui_DrawPoint(x+j+8,y+i,fc);
 				    }
 				}
 			  }
+			}
 			s+=2;x+=16;
 		} 
 		
@@ -58,7 +58,6 @@ xUSATR_TypeDef  xUSART;         // 声明为全局变量,方便记录信息、
 	 USART1->SR = ~(0x00F0);                                         // 清理中断
  
 	 xUSART.USART1InitFlag = 1;                                      // 标记初始化标志
-	 xUSART.USART1ReceivedNum = 0;                                   // 接收字节数清零
  }
  
 /******************************************************************************
@@ -75,6 +74,11 @@ xUSATR_TypeDef  xUSART;         // 声明为全局变量,方便记录信息、
 static volatile uint16_t U1TxCounter = 0;
 static volatile uint16_t U1TxCount   = 0;
 
+// 接收环形缓冲区的读写计数，与发送方向一样自由增长，差值即待读字节数
+// 中断只写 U1RxCount，主循环只写 U1RxCounter，因此读写两侧都不需要关中断
+static volatile uint16_t U1RxCounter = 0;
+static volatile uint16_t U1RxCount   = 0;
+
 
 /*
  void USART1_IRQHandler(void)
@@ -148,33 +152,25 @@ void USART1_IRQHandler(void)
 
     // ... (接收中断和空闲中断部分保持不变) ...
 
-    // 接收中断
+    // 接收中断：只把字节写入环形缓冲区，分帧由主循环中的 URC 分帧器完成
     if (USART_GetITStatus(USART1, USART_IT_RXNE) != RESET)
     {
-        // 检查缓冲区是否已满，防止溢出
-        if(xUSART.USART1ReceivedNum != U1_RX_BUF_SIZE)
+        uint8_t data = (uint8_t)USART_ReceiveData(USART1);     // 读DR同时清除RXNE标志
+        // 检查缓冲区是否已满，防止覆盖尚未读取的数据
+        if ((uint16_t)(U1RxCount - U1RxCounter) < U1_RX_BUF_SIZE)
         {
-            // 直接将接收到的数据追加到全局缓冲区的末尾
-            xUSART.USART1ReceivedBuffer[xUSART.USART1ReceivedNum++] = USART_ReceiveData(USART1);
+            xUSART.USART1ReceivedBuffer[U1RxCount % U1_RX_BUF_SIZE] = data;
+            U1RxCount++;
         }
         else
         {
-            // 缓冲区满了，丢弃数据，但要读一下DR来清除中断标志
-            USART_ReceiveData(USART1);
+            xUSART.USART1RxOverflow++;
         }
-        // 注意：RXNE标志在读取DR后会自动清除
     }
 
-    // 空闲中断
+    // 空闲中断：不再作为一帧结束的依据 (模组会把多条 URC 连在一起发，也会把一条拆开发)
     if(USART_GetITStatus(USART1, USART_IT_IDLE) != RESET)
 	{
-        // 检查是否确实收到了数据
-        if (xUSART.USART1ReceivedNum > 0)
-        {
-            // 不再调用任何处理函数，只设置标志位！
-            xUSART.USART1RxFrameFlag = 1;
-        }
-
 		// 严格按照手册顺序清除IDLE标志位
 		(void)USART1->SR;
 		(void)USART1->DR;
@@ -204,6 +200,26 @@ void USART1_IRQHandler(void)
 
 
 
+ /******************************************************************************
+  * 函  数： USART1_ReadRx
+  * 功  能： 从接收环形缓冲区取出数据
+  * 参  数： uint8_t* buffer   数据存放缓存地址
+  *          uint16_t max      最多取出的字节数
+  * 返回值： 实际取出的字节数，0表示没有新数据
+  ******************************************************************************/
+ uint16_t USART1_ReadRx(uint8_t *buffer, uint16_t max)
+ {
+	 uint16_t n = 0;
+	 uint16_t count = U1RxCount;                                                 // 只读一次，之后到达的数据留给下次
+
+	 while (U1RxCounter != count && n < max)
+	 {
+		 buffer[n++] = xUSART.USART1ReceivedBuffer[U1RxCounter % U1_RX_BUF_SIZE];
+		 U1RxCounter++;
+	 }
+	 return n;
+ }
+
  /******************************************************************************
   * 函  数： USART1_GetBuffer
   * 功  能： 获取UART所接收到的数据
@@ -213,14 +229,8 @@ void USART1_IRQHandler(void)
   ******************************************************************************/
  uint8_t USART1_GetBuffer(uint8_t *buffer, uint8_t *cnt)
  {
-	 if (xUSART.USART1ReceivedNum > 0)                                           // 判断是否有新数据
-	 {
-		 memcpy(buffer, xUSART.USART1ReceivedBuffer, xUSART.USART1ReceivedNum);  // 把新数据复制到指定位置
-		 *cnt = xUSART.USART1ReceivedNum;                                        // 把新数据的字节数，存放指定变量
-		 xUSART.USART1ReceivedNum = 0;                                           // 接收标记置0
-		 return *cnt;                                                            // 返回所接收到新数据的字节数
-	 }
-	 return 0;                                                                   // 返回0, 表示没有接收到新数据
+	 *cnt = (uint8_t)USART1_ReadRx(buffer, 255);                                 // 受 cnt 类型限制，单次最多取255字节
+	 return *cnt;
  }
  
  /******************************************************************************
@@ -177,6 +177,17 @@ int Get_Humidity_Value(void)
 	return air_receved_flag;
 }
 
+// 只发出问询码并进入 BUSY，不等待：应答由 USART3 中断接收，启动阶段用它让第一帧风速在其他外设初始化期间到达
+void ModBUS_Start_Query(void)
+{
+	if (FREE == air_receved_flag)
+	{
+		USART3_SendString(ASK_SENSOR_CMD, 8);
+		air_receved_flag = BUSY;
+		busy_count = 0;
+	}
+}
+
 void Get_Wind_Data(float *speed, uint16_t *power)
 {
 	if( air_error_count > 5 )
@@ -29,5 +29,6 @@ void Execute_Sensor_Humidity(void);
 void Execute_Sensor_CO2(void);
 
 void Get_Wind_Data(float *speed, uint16_t *power);
+void ModBUS_Start_Query(void);      // 非阻塞问询，应答到达后 Get_Wind_Data() 直接取用
 
 #endif
@@ -0,0 +1,159 @@
+#include "actuator.h"
+#include "Relay.h"
+#include "fan.h"
+#include "delay.h"
+#include <stdio.h>
+
+#define SHADOW_UNKNOWN      0xFFFF
+
+/* 只有紧急停止按键 (PC13, EXTI15_10) 会在中断中写执行器，临界区只屏蔽这一路中断，
+ * 串口接收、SysTick、看门狗与定时器中断照常响应 */
+#define ACTUATOR_LOCK()     NVIC_DisableIRQ(EXTI15_10_IRQn)
+#define ACTUATOR_UNLOCK()   NVIC_EnableIRQ(EXTI15_10_IRQn)
+
+static void Write_Pump(uint16_t v)      { if (v) Water_Pump_ON(); else Water_Pump_OFF(); }
+static void Write_Heater(uint16_t v)    { if (v) Heater_ON(); else Heater_OFF(); }
+static void Write_Fan(uint16_t v)       { if (v) Fan_ON(); else Fan_OFF(); }
+static void Write_Heater_Power(uint16_t v)    { Heater_Set_Power((uint8_t)v); }
+static void Write_Sprinkler_Power(uint16_t v) { Sprinkler_Set_Power((uint8_t)v); }
+static void Write_Fan_Power(uint16_t v)       { Fan_Set_Speed((uint8_t)v); }
+static void Write_Servo(uint16_t v)     { Set_Servo_Angle(v); }
+
+/* 通道表，顺序与 Actuator_t 一致；full 为满功率对应的值，0 表示不折算占空比 */
+typedef struct {
+    const char* name;
+    uint16_t    full;
+    void        (*write)(uint16_t value);
+} Actuator_Map_t;
+
+static const Actuator_Map_t s_map[ACTUATOR_COUNT] = {
+    { "pump",            1,   Write_Pump },
+    { "heater",          1,   Write_Heater },
+    { "fan",             1,   Write_Fan },
+    { "heater_power",    100, Write_Heater_Power },
+    { "sprinkler_power", 100, Write_Sprinkler_Power },
+    { "fan_power",       100, Write_Fan_Power },
+    { "servo",           0,   Write_Servo },
+};
+
+static uint16_t s_shadow[ACTUATOR_COUNT];
+static uint32_t s_since_ms[ACTUATOR_COUNT];     // 上次计入统计的时刻
+static uint32_t s_transitions[ACTUATOR_COUNT];
+static uint32_t s_on_ms[ACTUATOR_COUNT];
+static uint64_t s_duty_acc[ACTUATOR_COUNT];     // 输出值 x 毫秒
+
+/**
+ * @brief  把上次计入以来的时间按当前输出值累加到统计中
+ */
+static void Accrue(Actuator_t a, uint32_t now)
+{
+    uint32_t dt = now - s_since_ms[a];
+    uint16_t v = s_shadow[a];
+
+    s_since_ms[a] = now;
+    if (v == SHADOW_UNKNOWN || v == 0)
+    {
+        return;
+    }
+    s_on_ms[a] += dt;
+    if (s_map[a].full != 0)
+    {
+        s_duty_acc[a] += (uint64_t)v * dt;
+    }
+}
+
+void Actuator_Init(void)
+{
+    uint32_t now = (uint32_t)System_GetTimeMs();
+
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        s_shadow[i] = SHADOW_UNKNOWN;
+        s_since_ms[i] = now;
+        s_transitions[i] = 0;
+        s_on_ms[i] = 0;
+        s_duty_acc[i] = 0;
+    }
+}
+
+/**
+ * @brief  值变化时才写外设，并在写之前结算上一个值的持续时间
+ * @note   紧急停止按键在中断中经 System_CloseAll() 调用本函数。比较、更新影子值与写外设
+ *         须在屏蔽该按键中断时一起完成：否则中断落在主循环更新影子值与写外设之间时，
+ *         继电器会保持吸合而影子值已是 0，之后的关断请求都被当作重复写入忽略。
+ *         写外设可能耗时数十微秒 (PwmRamp_To、TIM1 重新交错)，舵机扫描要生成波形表并重设 DMA，
+ *         可达数毫秒，所以不关总中断，期间按下的急停在解除屏蔽后立即执行
+ */
+uint8_t Actuator_Set(Actuator_t a, uint16_t value)
+{
+    if (a >= ACTUATOR_COUNT)
+    {
+        return 0;
+    }
+    ACTUATOR_LOCK();
+    if (s_shadow[a] == value)
+    {
+        ACTUATOR_UNLOCK();
+        return 0;
+    }
+    Accrue(a, (uint32_t)System_GetTimeMs());
+    if (s_shadow[a] != SHADOW_UNKNOWN)
+    {
+        s_transitions[a]++;
+    }
+    s_shadow[a] = value;
+    s_map[a].write(value);
+    ACTUATOR_UNLOCK();
+    return 1;
+}
+
+void Actuator_Servo_Sweep(float lo_angle, float hi_angle)
+{
+    ACTUATOR_LOCK();
+    if (s_shadow[ACTUATOR_SERVO] != ACTUATOR_SERVO_SWEEP)
+    {
+        Accrue(ACTUATOR_SERVO, (uint32_t)System_GetTimeMs());
+        if (s_shadow[ACTUATOR_SERVO] != SHADOW_UNKNOWN)
+        {
+            s_transitions[ACTUATOR_SERVO]++;
+        }
+        s_shadow[ACTUATOR_SERVO] = ACTUATOR_SERVO_SWEEP;
+    }
+    Servo_Sweep(lo_angle, hi_angle);
+    ACTUATOR_UNLOCK();
+}
+
+uint16_t Actuator_Get(Actuator_t a)
+{
+    return s_shadow[a];
+}
+
+void Actuator_Get_Stats(Actuator_t a, Actuator_Stats_t* out)
+{
+    ACTUATOR_LOCK();
+    Accrue(a, (uint32_t)System_GetTimeMs());
+    out->transitions = s_transitions[a];
+    out->on_ms = s_on_ms[a];
+    out->duty_ms = (s_map[a].full != 0) ? (uint32_t)(s_duty_acc[a] / s_map[a].full) : 0;
+    ACTUATOR_UNLOCK();
+}
+
+void Actuator_Write_Json(JsonStream_t* w)
+{
+    char key[32];
+    Actuator_Stats_t st;
+
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        Actuator_Get_Stats((Actuator_t)i, &st);
+        snprintf(key, sizeof(key), "%s_switches", s_map[i].name);
+        JsonStream_Uint(w, key, st.transitions);
+        snprintf(key, sizeof(key), "%s_on_s", s_map[i].name);
+        JsonStream_Uint(w, key, st.on_ms / 1000);
+        if (s_map[i].full > 1)
+        {
+            snprintf(key, sizeof(key), "%s_duty_s", s_map[i].name);
+            JsonStream_Uint(w, key, st.duty_ms / 1000);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ ******************************************************************************
+ * @ 名称  执行器影子寄存器层
+ * @ 描述  为每路输出 (三个继电器、三路功率 PWM、舵机) 保存最近一次写入的值，
+ *         只有新值与影子值不同时才调用 Relay.c / fan.c 的驱动写外设：主循环每轮重复下发
+ *         的 "关水泵、关加热器、舵机归零" 不再产生 GPIO/定时器写入。
+ *         同时统计每路输出的变化次数、非零输出的累计时间与按占空比折算的满功率时间，
+ *         作为 actuator_usage 属性随窗口统计上报，用于能耗核算。
+ * @ 注意  Actuator_Init() 之后的第一次写入总会到达硬件；绕过本层直接调用驱动会使影子值失效。
+ ******************************************************************************
+ */
+#ifndef __ACTUATOR_H
+#define __ACTUATOR_H
+
+#include <stdint.h>
+#include "json_stream.h"
+
+// 输出通道
+typedef enum {
+    ACTUATOR_PUMP,              // 水泵继电器       0 断开 / 1 吸合
+    ACTUATOR_HEATER,            // 加热器继电器
+    ACTUATOR_FAN,               // 风机继电器
+    ACTUATOR_HEATER_POWER,      // 加热器功率       0~100 (%)
+    ACTUATOR_SPRINKLER_POWER,   // 洒水器功率
+    ACTUATOR_FAN_POWER,         // 风机转速
+    ACTUATOR_SERVO,             // 舵机角度         0~180 (°)，ACTUATOR_SERVO_SWEEP 表示正在扫描
+    ACTUATOR_COUNT
+} Actuator_t;
+
+#define ACTUATOR_SERVO_SWEEP    0xFFFE
+
+typedef struct {
+    uint32_t transitions;       // 输出值变化 (实际写外设) 的次数
+    uint32_t on_ms;             // 输出非零的累计时间
+    uint32_t duty_ms;           // 折算为满功率的累计时间 (继电器等于 on_ms，舵机不统计)
+} Actuator_Stats_t;
+
+// 清空影子值与统计，之后每路的第一次写入都会到达硬件
+void    Actuator_Init(void);
+// 写一路输出，值与影子值相同时直接返回；返回 1 表示写了外设
+uint8_t Actuator_Set(Actuator_t a, uint16_t value);
+// 舵机在两个角度之间循环扫描；范围未变时由 Servo_Sweep() 自身的死区忽略
+void    Actuator_Servo_Sweep(float lo_angle, float hi_angle);
+uint16_t Actuator_Get(Actuator_t a);
+// 统计截至当前时刻
+void    Actuator_Get_Stats(Actuator_t a, Actuator_Stats_t* out);
+// 写出 actuator_usage 的成员：<通道>_switches、<通道>_on_s，功率通道另有 <通道>_duty_s
+void    Actuator_Write_Json(JsonStream_t* w);
+
+#endif
@@ -0,0 +1,124 @@
+#include "alarm.h"
+#include "hal.h"
+#include "led.h"
+#include "beep.h"
+#include "supervisor.h"
+
+/* 一个步骤：指示灯是否点亮 (颜色由严重等级决定)、蜂鸣器是否鸣叫、持续的节拍数 */
+typedef struct {
+    uint8_t led;
+    uint8_t buzzer;
+    uint8_t ticks;
+} Alarm_Step_t;
+
+typedef struct {
+    const Alarm_Step_t* steps;
+    uint8_t             count;
+    uint8_t             loop;       // 0：放完停在最后一步
+} Alarm_Sequence_t;
+
+#define MS_TO_TICKS(ms)     ((ms) / ALARM_TICK_MS)
+
+static const Alarm_Step_t s_off[]    = { { 0, 0, 1 } };
+static const Alarm_Step_t s_steady[] = { { 1, 0, 1 } };
+static const Alarm_Step_t s_blink[]  = {
+    { 1, 0, MS_TO_TICKS(500) },
+    { 0, 0, MS_TO_TICKS(500) },
+};
+static const Alarm_Step_t s_beep3[]  = {
+    { 1, 1, MS_TO_TICKS(150) }, { 1, 0, MS_TO_TICKS(150) },
+    { 1, 1, MS_TO_TICKS(150) }, { 1, 0, MS_TO_TICKS(150) },
+    { 1, 1, MS_TO_TICKS(150) }, { 1, 0, MS_TO_TICKS(2000) },
+};
+
+#define SEQ(table, loop)    { table, sizeof(table) / sizeof(table[0]), loop }
+
+/* 顺序与 Alarm_Pattern_t 一致 */
+static const Alarm_Sequence_t s_sequence[ALARM_PATTERN_COUNT] = {
+    SEQ(s_off,    0),
+    SEQ(s_steady, 0),
+    SEQ(s_blink,  1),
+    SEQ(s_beep3,  1),
+};
+
+/* 顺序与 Alarm_Severity_t 一致 */
+static const LED_Color s_color[ALARM_SEV_COUNT] = { COLOR_GREEN, COLOR_BLUE, COLOR_RED };
+
+#define REQUEST(pattern, severity)  ((uint16_t)(((pattern) << 8) | (severity)))
+#define REQUEST_NONE                0xFFFFu
+
+static volatile uint16_t s_request = REQUEST(ALARM_PATTERN_OFF, ALARM_SEV_NORMAL);
+static uint16_t s_playing = REQUEST_NONE;   // 以下仅在节拍中断中访问
+static uint8_t  s_step;
+static uint8_t  s_left;
+
+static void Apply_Step(void)
+{
+    const Alarm_Step_t* step = &s_sequence[s_playing >> 8].steps[s_step];
+
+    LED_SetColor(step->led ? s_color[s_playing & 0xFF] : COLOR_BLACK);
+    if (step->buzzer)
+    {
+        Buzzer_On();
+    }
+    else
+    {
+        Buzzer_Off();
+    }
+    s_left = step->ticks;
+}
+
+/**
+ * @brief  10ms 节拍 (中断上下文)：有新的投递时从第一步开始，否则在步骤结束时前进一步
+ * @note   只在步骤切换时写 GPIO，停在最后一步的图案此后不再触碰引脚
+ */
+static void Alarm_Tick(void)
+{
+    uint16_t request = s_request;
+    const Alarm_Sequence_t* seq;
+
+    Supervisor_Beat(SUP_TASK_ALARM);
+    if (request != s_playing)
+    {
+        s_playing = request;
+        s_step = 0;
+        Apply_Step();
+        return;
+    }
+
+    if (s_left > 1)
+    {
+        s_left--;
+        return;
+    }
+
+    seq = &s_sequence[s_playing >> 8];
+    if (s_step + 1 < seq->count)
+    {
+        s_step++;
+    }
+    else if (seq->loop)
+    {
+        s_step = 0;
+    }
+    else
+    {
+        s_left = 0;
+        return;
+    }
+    Apply_Step();
+}
+
+void Alarm_Init(void)
+{
+    HAL_Timer_StartPeriodic(HAL_TIMER_ALARM, ALARM_TICK_MS * 2, Alarm_Tick);
+}
+
+void Alarm_Post(Alarm_Pattern_t pattern, Alarm_Severity_t severity)
+{
+    if (pattern >= ALARM_PATTERN_COUNT || severity >= ALARM_SEV_COUNT)
+    {
+        return;
+    }
+    s_request = REQUEST(pattern, severity);
+}
@@ -0,0 +1,40 @@
+/**
+ ******************************************************************************
+ * @ 名称  声光告警引擎
+ * @ 描述  蜂鸣器与 RGB 指示灯的节奏 (蜂鸣次数、闪烁码) 写成步骤表，由 TIM7 的 10ms
+ *         周期中断逐步播放；主循环只需投递 "以某严重等级播放某图案"，不再为鸣叫调用 delay_ms。
+ *         严重等级决定指示灯颜色：正常绿、提示蓝、告警红。
+ * @ 注意  投递相同的图案与等级不会重新开始播放，可以每轮调用；投递不同的组合在下一个节拍
+ *         (10ms 内) 从第一步开始播放。投递只是一次半字写入，中断 (如紧急停止按键) 中同样可用。
+ ******************************************************************************
+ */
+#ifndef __ALARM_H
+#define __ALARM_H
+
+#include <stdint.h>
+
+#define ALARM_TICK_MS       10      // 播放节拍，步骤时长以节拍为单位
+
+// 告警图案
+typedef enum {
+    ALARM_PATTERN_OFF = 0,          // 灯灭、静音
+    ALARM_PATTERN_STEADY,           // 常亮、静音
+    ALARM_PATTERN_BLINK,            // 0.5s 亮 / 0.5s 灭，静音
+    ALARM_PATTERN_BEEP3,            // 常亮，三声 150ms 短鸣后停 2s，循环 (原 Buzzer_Alarm(3))
+    ALARM_PATTERN_COUNT
+} Alarm_Pattern_t;
+
+// 严重等级 (指示灯颜色)
+typedef enum {
+    ALARM_SEV_NORMAL = 0,           // 绿
+    ALARM_SEV_NOTICE,               // 蓝
+    ALARM_SEV_CRITICAL,             // 红
+    ALARM_SEV_COUNT
+} Alarm_Severity_t;
+
+// 启动 TIM7 节拍 (需先完成 LED_Init() 与 Buzzer_Init())
+void Alarm_Init(void);
+// 投递要播放的图案与严重等级
+void Alarm_Post(Alarm_Pattern_t pattern, Alarm_Severity_t severity);
+
+#endif
@@ -4,6 +4,10 @@
 #include "stdio.h"
 #include "usart.h"
 #include "UART_DISPLAY.h"
+
+// 软件 I2C 传输层 (PC4/PC5)，AT24C02_USE_HW_I2C 为 1 时改用 at24c02_i2c.c 中的 I2C1 外设
+#if !AT24C02_USE_HW_I2C
+
 //初始化I2C1
 static void I2C_Delay(void)
 {
@@ -123,7 +127,7 @@ void AT24C02_I2C_SendNack(void)
 }
 
 // 初始化
-void AT24C02_Init(void)
+void AT24C02_Bus_Init(void)
 {
     RCC_APB2PeriphClockCmd(I2C_CLK_RCC, ENABLE);
 	
@@ -137,38 +141,173 @@ void AT24C02_Init(void)
 	I2C_W_SDA(1);
 }
 
-void AT24C02_WriteByte(uint8_t Addr, uint8_t Data)
+// 发出设备地址 (写) 与内部地址，任一字节无应答时结束本次传输
+static uint8_t AT24C02_Address(uint8_t Addr)
 {
     AT24C02_I2C_Start();
-    AT24C02_I2C_SendByte(AT24C02_DEVICE_ADDR | 0); // 发送设备地址+写命令
-    AT24C02_I2C_WaitAck();
-    AT24C02_I2C_SendByte(Addr); // 发送要写入的内部地址
-    AT24C02_I2C_WaitAck();
-    AT24C02_I2C_SendByte(Data); // 发送数据
-    AT24C02_I2C_WaitAck();
-    AT24C02_I2C_Stop();
-    
-    delay_ms(10); // 等待EEPROM内部写周期完成
+    AT24C02_I2C_SendByte(AT24C02_DEVICE_ADDR | 0);
+    if (AT24C02_I2C_WaitAck() != 0)
+    {
+        AT24C02_I2C_Stop();
+        return 1;
+    }
+    AT24C02_I2C_SendByte(Addr);
+    if (AT24C02_I2C_WaitAck() != 0)
+    {
+        AT24C02_I2C_Stop();
+        return 1;
+    }
+    return 0;
 }
 
-uint8_t AT24C02_ReadByte(uint8_t Addr)
+// 单次寻址：写周期进行中的 EEPROM 不应答
+uint8_t AT24C02_Bus_Probe(void)
 {
-    uint8_t Data;
-    
+    uint8_t ack;
+
     AT24C02_I2C_Start();
-    AT24C02_I2C_SendByte(AT24C02_DEVICE_ADDR | 0); // 写模式，先发送地址
-    AT24C02_I2C_WaitAck();
-    AT24C02_I2C_SendByte(Addr);
-    AT24C02_I2C_WaitAck();
-    
+    AT24C02_I2C_SendByte(AT24C02_DEVICE_ADDR | 0);
+    ack = AT24C02_I2C_WaitAck();
+    AT24C02_I2C_Stop();
+    return ack;
+}
+
+// 一次页写传输，停止信号启动内部写周期
+uint8_t AT24C02_Bus_Write(uint8_t Addr, const uint8_t* Data, uint16_t Len)
+{
+    if (AT24C02_Address(Addr) != 0)
+    {
+        return 1;
+    }
+    for (uint16_t i = 0; i < Len; i++)
+    {
+        AT24C02_I2C_SendByte(Data[i]);
+        if (AT24C02_I2C_WaitAck() != 0)
+        {
+            AT24C02_I2C_Stop();
+            return 1;
+        }
+    }
+    AT24C02_I2C_Stop();
+    return 0;
+}
+
+// 随机寻址后重复起始进入读模式，每个字节后回 ACK 继续，最后一个字节回 NACK
+uint8_t AT24C02_Bus_Read(uint8_t Addr, uint8_t* Data, uint16_t Len)
+{
+    if (AT24C02_Address(Addr) != 0)
+    {
+        return 1;
+    }
     AT24C02_I2C_Start(); // 重复起始信号
     AT24C02_I2C_SendByte(AT24C02_DEVICE_ADDR | 1); // 读模式
-    AT24C02_I2C_WaitAck();
-    Data = AT24C02_I2C_ReceiveByte();
-    AT24C02_I2C_SendNack(); // 发送非应答信号，结束读取
+    if (AT24C02_I2C_WaitAck() != 0)
+    {
+        AT24C02_I2C_Stop();
+        return 1;
+    }
+    for (uint16_t i = 0; i < Len; i++)
+    {
+        Data[i] = AT24C02_I2C_ReceiveByte();
+        if (i + 1 < Len)
+        {
+            AT24C02_I2C_SendAck();
+        }
+        else
+        {
+            AT24C02_I2C_SendNack(); // 发送非应答信号，结束读取
+        }
+    }
     AT24C02_I2C_Stop();
-    
-    return Data;
+    return 0;
+}
+
+#endif /* !AT24C02_USE_HW_I2C */
+
+void AT24C02_Init(void)
+{
+    AT24C02_Bus_Init();
+}
+
+/**
+ * @brief  ACK 轮询：写周期进行中的 EEPROM 不应答自己的地址，应答即表示写入完成
+ * @return 0 已就绪，1 超过 AT24C02_WRITE_TIMEOUT_MS 仍无应答
+ * @note   典型写周期约 3~5ms，比固定等待 10ms 快一半以上；轮询期间不调用 delay_ms
+ */
+static uint8_t AT24C02_Wait_Ready(void)
+{
+    uint64_t start = System_GetTimeMs();
+
+    do
+    {
+        if (AT24C02_Bus_Probe() == 0)
+        {
+            return 0;
+        }
+    } while (System_GetTimeMs() - start <= AT24C02_WRITE_TIMEOUT_MS);
+
+    return 1;
+}
+
+/**
+ * @brief  多字节写入
+ * @note   页写在页内地址到达末尾后会回卷到页首，因此每段不跨越 8 字节页边界；
+ *         每页写完后 ACK 轮询等待写周期结束。64 字节约 8 个写周期，合计几十毫秒。
+ */
+uint8_t AT24C02_Write(uint8_t Addr, const uint8_t* Data, uint16_t Len)
+{
+    uint16_t addr = Addr;
+
+    if (addr + Len > AT24C02_SIZE)
+    {
+        return 1;
+    }
+    while (Len > 0)
+    {
+        uint16_t chunk = AT24C02_PAGE_SIZE - (addr % AT24C02_PAGE_SIZE);
+        if (chunk > Len)
+        {
+            chunk = Len;
+        }
+
+        if (AT24C02_Bus_Write((uint8_t)addr, Data, chunk) != 0 ||
+            AT24C02_Wait_Ready() != 0)
+        {
+            return 1;
+        }
+
+        addr += chunk;
+        Data += chunk;
+        Len -= chunk;
+    }
+    return 0;
+}
+
+/**
+ * @brief  顺序读：一次寻址后连续读出 Len 个字节
+ */
+uint8_t AT24C02_Read(uint8_t Addr, uint8_t* Data, uint16_t Len)
+{
+    if (Len == 0)
+    {
+        return 0;
+    }
+    if ((uint16_t)Addr + Len > AT24C02_SIZE)
+    {
+        return 1;
+    }
+    return AT24C02_Bus_Read(Addr, Data, Len);
+}
+
+void AT24C02_WriteByte(uint8_t Addr, uint8_t Data)
+{
+    AT24C02_Write(Addr, &Data, 1);
 }
 
+uint8_t AT24C02_ReadByte(uint8_t Addr)
+{
+    uint8_t Data = 0xFF;
 
+    AT24C02_Read(Addr, &Data, 1);
+    return Data;
+}
@@ -9,14 +9,37 @@
 #define I2C_SDA_PIN   GPIO_Pin_5
 #define I2C_CLK_RCC   RCC_APB2Periph_GPIOC
 
+// 传输层选择：默认在 PC4/PC5 上软件模拟 I2C；make AT24C02_HW_I2C=1 时改用 I2C1 外设 (PB6/PB7)，
+// 多字节传输走 DMA、由中断推进，需把 EEPROM 接到 PB6/PB7 并把 TFT 的 SCL/SDA 改到其他引脚
+#ifndef AT24C02_USE_HW_I2C
+#define AT24C02_USE_HW_I2C  0
+#endif
+#ifndef AT24C02_I2C_SPEED
+#define AT24C02_I2C_SPEED   400000  // 硬件 I2C 的 SCL 频率：100000 标准模式，400000 快速模式
+#endif
+
 // 底层引脚操作宏
 #define I2C_W_SCL(x)  GPIO_WriteBit(I2C_PORT, I2C_SCL_PIN, (BitAction)(x))
 #define I2C_W_SDA(x)  GPIO_WriteBit(I2C_PORT, I2C_SDA_PIN, (BitAction)(x))
 #define I2C_R_SDA()   GPIO_ReadInputDataBit(I2C_PORT, I2C_SDA_PIN)
 
+#define AT24C02_SIZE               256  // 总容量 (字节)
+#define AT24C02_PAGE_SIZE          8    // 页写一次最多写入的字节数，不能跨页
+#define AT24C02_WRITE_TIMEOUT_MS   10   // 内部写周期最长时间 (手册 tWR 最大 5ms，留出余量)
+
 void AT24C02_Init(void);
 void AT24C02_WriteByte(uint8_t Addr, uint8_t Data);
 uint8_t AT24C02_ReadByte(uint8_t Addr);
+// 多字节写入：按页拆分，写周期结束由 ACK 轮询判断；返回 0 成功，1 无应答或越界
+uint8_t AT24C02_Write(uint8_t Addr, const uint8_t* Data, uint16_t Len);
+// 顺序读：一次寻址后连续读出 Len 个字节；返回 0 成功，1 无应答或越界
+uint8_t AT24C02_Read(uint8_t Addr, uint8_t* Data, uint16_t Len);
+
+// 传输层 (软件 I2C 或硬件 I2C 各实现一份)，返回 0 成功
+void    AT24C02_Bus_Init(void);
+uint8_t AT24C02_Bus_Probe(void);                                            // 仅寻址，0 表示器件应答
+uint8_t AT24C02_Bus_Write(uint8_t Addr, const uint8_t* Data, uint16_t Len); // 一次页写，不跨页
+uint8_t AT24C02_Bus_Read(uint8_t Addr, uint8_t* Data, uint16_t Len);        // 随机寻址 + 顺序读
 
 #define AT24C02_DEVICE_ADDR        0xA0 // AT24C02的设备地址
 #define EEPROM_ADDR_SAFETY_MARGIN  0x10 // 用地址 0x10 存储安全边际
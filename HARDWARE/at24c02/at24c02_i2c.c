@@ -0,0 +1,354 @@
+#include "at24c02.h"
+#include "delay.h"
+#include "stm32f10x.h"
+#include <stdio.h>
+#include <string.h>
+
+// 硬件 I2C 传输层：I2C1 (PB6 SCL / PB7 SDA)，发送走 DMA1 通道 6，接收走 DMA1 通道 7。
+// 起始、寻址与停止由 I2C 事件中断推进，数据段由 DMA 搬运，调用方只等待完成标志。
+#if AT24C02_USE_HW_I2C
+
+#define EE_I2C                  I2C1
+#define EE_GPIO                 GPIOB
+#define EE_SCL_PIN              GPIO_Pin_6
+#define EE_SDA_PIN              GPIO_Pin_7
+#define EE_DMA_TX               DMA1_Channel6
+#define EE_DMA_RX               DMA1_Channel7
+#define EE_XFER_TIMEOUT_MS      5       // 一页 (1+8 字节) 在 100kHz 下约 1ms
+
+typedef enum {
+    EE_OP_PROBE,                // 仅寻址 (ACK 轮询)
+    EE_OP_WRITE,                // 地址 + 片内地址 + 数据，DMA 发送
+    EE_OP_READ                  // 地址 + 片内地址，重复起始后 DMA 接收
+} EE_Op_t;
+
+typedef struct {
+    EE_Op_t  op;
+    uint8_t  reading;           // 读操作已进入重复起始后的读阶段
+    uint8_t  word;              // 片内地址
+    uint8_t* rx;
+    uint16_t len;
+    uint8_t  tx[1 + AT24C02_PAGE_SIZE]; // 片内地址与待写数据，DMA 一次发出
+    volatile uint8_t done;
+    volatile uint8_t error;     // 0 成功，1 无应答，2 总线错误/仲裁丢失
+} EE_Xfer_t;
+
+static EE_Xfer_t s_xfer;
+
+static void EE_Pins(GPIOMode_TypeDef mode)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+
+    GPIO_InitStructure.GPIO_Pin = EE_SCL_PIN | EE_SDA_PIN;
+    GPIO_InitStructure.GPIO_Mode = mode;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(EE_GPIO, &GPIO_InitStructure);
+}
+
+static void EE_Periph_Init(void)
+{
+    I2C_InitTypeDef I2C_InitStructure;
+
+    I2C_DeInit(EE_I2C);
+    I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
+    I2C_InitStructure.I2C_DutyCycle = I2C_DutyCycle_2;
+    I2C_InitStructure.I2C_OwnAddress1 = 0x30;
+    I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
+    I2C_InitStructure.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
+    I2C_InitStructure.I2C_ClockSpeed = AT24C02_I2C_SPEED;
+    I2C_Init(EE_I2C, &I2C_InitStructure);
+    I2C_ITConfig(EE_I2C, I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+    I2C_Cmd(EE_I2C, ENABLE);
+}
+
+/**
+ * @brief  总线恢复 (STM32F10xx 勘误手册 2.13.7 与从机卡住 SDA 的处理)
+ * @note   关闭外设后把引脚切为开漏 GPIO：SDA 被从机拉低时补最多 9 个 SCL 时钟，
+ *         再手动产生 STOP，最后恢复复用功能并软件复位 I2C，清除卡死的 BUSY 标志
+ */
+static void EE_Bus_Recover(void)
+{
+    I2C_Cmd(EE_I2C, DISABLE);
+    GPIO_SetBits(EE_GPIO, EE_SCL_PIN | EE_SDA_PIN);
+    EE_Pins(GPIO_Mode_Out_OD);
+    delay_us(5);
+
+    for (int i = 0; i < 9 && GPIO_ReadInputDataBit(EE_GPIO, EE_SDA_PIN) == 0; i++)
+    {
+        GPIO_ResetBits(EE_GPIO, EE_SCL_PIN);
+        delay_us(5);
+        GPIO_SetBits(EE_GPIO, EE_SCL_PIN);
+        delay_us(5);
+    }
+    // STOP：SCL 为高时 SDA 由低变高
+    GPIO_ResetBits(EE_GPIO, EE_SCL_PIN);
+    delay_us(5);
+    GPIO_ResetBits(EE_GPIO, EE_SDA_PIN);
+    delay_us(5);
+    GPIO_SetBits(EE_GPIO, EE_SCL_PIN);
+    delay_us(5);
+    GPIO_SetBits(EE_GPIO, EE_SDA_PIN);
+    delay_us(5);
+
+    EE_Pins(GPIO_Mode_AF_OD);
+    I2C_SoftwareResetCmd(EE_I2C, ENABLE);
+    I2C_SoftwareResetCmd(EE_I2C, DISABLE);
+    EE_Periph_Init();
+}
+
+static void EE_DMA_Start(DMA_Channel_TypeDef* ch, uint8_t* mem, uint16_t len, uint32_t dir)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(ch);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&EE_I2C->DR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)mem;
+    DMA_InitStructure.DMA_DIR = dir;
+    DMA_InitStructure.DMA_BufferSize = len;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(ch, &DMA_InitStructure);
+    DMA_ITConfig(ch, DMA_IT_TC, ENABLE);
+    I2C_DMACmd(EE_I2C, ENABLE);
+    DMA_Cmd(ch, ENABLE);
+}
+
+static void EE_DMA_Stop(void)
+{
+    DMA_Cmd(EE_DMA_TX, DISABLE);
+    DMA_Cmd(EE_DMA_RX, DISABLE);
+    I2C_DMACmd(EE_I2C, DISABLE);
+    I2C_DMALastTransferCmd(EE_I2C, DISABLE);
+}
+
+static void EE_Finish(uint8_t error)
+{
+    s_xfer.error = error;
+    s_xfer.done = 1;
+}
+
+/**
+ * @brief  启动一次传输并等待中断置位完成标志
+ * @return 0 成功，1 无应答、总线错误或超时 (后两者会执行总线恢复)
+ */
+static uint8_t EE_Run(void)
+{
+    uint64_t start = System_GetTimeMs();
+
+    // 上一次 STOP 尚未发出，或总线被卡住
+    while (EE_I2C->CR1 & I2C_CR1_STOP)
+    {
+        if (System_GetTimeMs() - start > EE_XFER_TIMEOUT_MS)
+        {
+            break;
+        }
+    }
+    if (I2C_GetFlagStatus(EE_I2C, I2C_FLAG_BUSY) == SET)
+    {
+        EE_Bus_Recover();
+    }
+
+    s_xfer.reading = 0;
+    s_xfer.done = 0;
+    s_xfer.error = 0;
+    I2C_AcknowledgeConfig(EE_I2C, ENABLE);
+    I2C_GenerateSTART(EE_I2C, ENABLE);
+
+    start = System_GetTimeMs();
+    while (!s_xfer.done)
+    {
+        if (System_GetTimeMs() - start > EE_XFER_TIMEOUT_MS)
+        {
+            EE_DMA_Stop();
+            printf("WARN: AT24C02 I2C transfer timed out, recovering bus.\r\n");
+            EE_Bus_Recover();
+            return 1;
+        }
+    }
+    if (s_xfer.error == 2)
+    {
+        printf("WARN: AT24C02 I2C bus error, recovering bus.\r\n");
+        EE_Bus_Recover();
+    }
+    return s_xfer.error ? 1 : 0;
+}
+
+void AT24C02_Bus_Init(void)
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+    const uint8_t irqs[] = { I2C1_EV_IRQn, I2C1_ER_IRQn, DMA1_Channel6_IRQn, DMA1_Channel7_IRQn };
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_I2C1, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    for (unsigned i = 0; i < sizeof(irqs); i++)
+    {
+        NVIC_InitStructure.NVIC_IRQChannel = irqs[i];
+        NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+        NVIC_InitStructure.NVIC_IRQChannelSubPriority = (i < 2) ? 0 : 1;
+        NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+        NVIC_Init(&NVIC_InitStructure);
+    }
+
+    EE_Pins(GPIO_Mode_AF_OD);
+    EE_Periph_Init();
+    // 上电时从机可能停在半个字节上
+    if (I2C_GetFlagStatus(EE_I2C, I2C_FLAG_BUSY) == SET)
+    {
+        EE_Bus_Recover();
+    }
+}
+
+uint8_t AT24C02_Bus_Probe(void)
+{
+    s_xfer.op = EE_OP_PROBE;
+    return EE_Run();
+}
+
+uint8_t AT24C02_Bus_Write(uint8_t Addr, const uint8_t* Data, uint16_t Len)
+{
+    if (Len > AT24C02_PAGE_SIZE)
+    {
+        return 1;
+    }
+    s_xfer.op = EE_OP_WRITE;
+    s_xfer.tx[0] = Addr;
+    memcpy(&s_xfer.tx[1], Data, Len);
+    s_xfer.len = Len + 1;
+    return EE_Run();
+}
+
+uint8_t AT24C02_Bus_Read(uint8_t Addr, uint8_t* Data, uint16_t Len)
+{
+    s_xfer.op = EE_OP_READ;
+    s_xfer.word = Addr;
+    s_xfer.rx = Data;
+    s_xfer.len = Len;
+    return EE_Run();
+}
+
+/**
+ * @brief  I2C1 事件中断：SB -> 发地址，ADDR -> 启动 DMA 或发片内地址，BTF -> 重复起始或 STOP
+ * @note   单字节读按参考手册的 N=1 流程：清 ADDR 前关闭 ACK，清 ADDR 后立即置 STOP，RXNE 时取数
+ */
+void I2C1_EV_IRQHandler(void)
+{
+    uint16_t sr1 = EE_I2C->SR1;
+
+    if (sr1 & I2C_SR1_SB)
+    {
+        EE_I2C->DR = AT24C02_DEVICE_ADDR | (s_xfer.reading ? 1 : 0);
+        return;
+    }
+
+    if (sr1 & I2C_SR1_ADDR)
+    {
+        if (s_xfer.op == EE_OP_PROBE)
+        {
+            (void)EE_I2C->SR2;
+            I2C_GenerateSTOP(EE_I2C, ENABLE);
+            EE_Finish(0);
+        }
+        else if (s_xfer.op == EE_OP_WRITE)
+        {
+            EE_DMA_Start(EE_DMA_TX, s_xfer.tx, s_xfer.len, DMA_DIR_PeripheralDST);
+            (void)EE_I2C->SR2;
+        }
+        else if (!s_xfer.reading)
+        {
+            (void)EE_I2C->SR2;
+            EE_I2C->DR = s_xfer.word;
+        }
+        else if (s_xfer.len == 1)
+        {
+            I2C_AcknowledgeConfig(EE_I2C, DISABLE);
+            (void)EE_I2C->SR2;
+            I2C_GenerateSTOP(EE_I2C, ENABLE);
+            I2C_ITConfig(EE_I2C, I2C_IT_BUF, ENABLE);
+        }
+        else
+        {
+            // LAST 置位后 DMA 接收最后一个字节时自动回 NACK
+            I2C_DMALastTransferCmd(EE_I2C, ENABLE);
+            EE_DMA_Start(EE_DMA_RX, s_xfer.rx, s_xfer.len, DMA_DIR_PeripheralSRC);
+            (void)EE_I2C->SR2;
+        }
+        return;
+    }
+
+    if ((sr1 & I2C_SR1_RXNE) && s_xfer.reading && s_xfer.len == 1)
+    {
+        I2C_ITConfig(EE_I2C, I2C_IT_BUF, DISABLE);
+        s_xfer.rx[0] = (uint8_t)EE_I2C->DR;
+        EE_Finish(0);
+        return;
+    }
+
+    if (sr1 & I2C_SR1_BTF)
+    {
+        if (s_xfer.op == EE_OP_READ && !s_xfer.reading)
+        {
+            // 片内地址已发出，重复起始进入读阶段
+            s_xfer.reading = 1;
+            I2C_GenerateSTART(EE_I2C, ENABLE);
+        }
+        else if (s_xfer.op == EE_OP_WRITE)
+        {
+            // DMA 已搬完，最后一个字节移出后发 STOP，启动内部写周期
+            I2C_GenerateSTOP(EE_I2C, ENABLE);
+            (void)EE_I2C->DR;
+            EE_Finish(0);
+        }
+    }
+}
+
+// 错误中断：AF 为器件无应答 (写周期中或地址错误)，其余为总线错误
+void I2C1_ER_IRQHandler(void)
+{
+    uint16_t sr1 = EE_I2C->SR1;
+
+    EE_DMA_Stop();
+    I2C_ITConfig(EE_I2C, I2C_IT_BUF, DISABLE);
+    if (sr1 & I2C_SR1_AF)
+    {
+        EE_I2C->SR1 = (uint16_t)~I2C_SR1_AF;
+        I2C_GenerateSTOP(EE_I2C, ENABLE);
+        EE_Finish(1);
+    }
+    else
+    {
+        EE_I2C->SR1 = (uint16_t)~(I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR | I2C_SR1_TIMEOUT);
+        EE_Finish(2);
+    }
+}
+
+// 发送 DMA 完成：关闭 DMA 请求，等 BTF 事件发出 STOP
+void DMA1_Channel6_IRQHandler(void)
+{
+    if (DMA_GetITStatus(DMA1_IT_TC6) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_IT_TC6);
+        DMA_Cmd(EE_DMA_TX, DISABLE);
+        I2C_DMACmd(EE_I2C, DISABLE);
+    }
+}
+
+// 接收 DMA 完成：最后一个字节已回 NACK，发 STOP 结束
+void DMA1_Channel7_IRQHandler(void)
+{
+    if (DMA_GetITStatus(DMA1_IT_TC7) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_IT_TC7);
+        EE_DMA_Stop();
+        I2C_GenerateSTOP(EE_I2C, ENABLE);
+        EE_Finish(0);
+    }
+}
+
+#endif /* AT24C02_USE_HW_I2C */
@@ -0,0 +1,239 @@
+#include "at_urc.h"
+#include <string.h>
+
+enum {
+    AT_URC_MODE_LINE,           // 按行读取
+    AT_URC_MODE_COUNTED,        // 读取 +QMTRECV 的计长负载
+    AT_URC_MODE_SKIP_COUNTED,   // 计长负载放不下：按长度跳过，再丢弃到行尾
+    AT_URC_MODE_DISCARD         // 丢弃到行尾
+};
+
+static const char s_recv_head[] = "+QMTRECV:";
+#define RECV_HEAD_LEN   (sizeof(s_recv_head) - 1)
+
+static void AtUrc_Reset_Line(AtUrc_Framer_t* f)
+{
+    f->len = 0;
+    f->mode = AT_URC_MODE_LINE;
+    f->quotes = 0;
+    f->quote2 = 0;
+    f->payload_start = 0;
+    f->payload_end = 0;
+    f->remaining = 0;
+}
+
+static int AtUrc_Is_Recv(const AtUrc_Framer_t* f)
+{
+    return f->len >= RECV_HEAD_LEN && memcmp(f->line, s_recv_head, RECV_HEAD_LEN) == 0;
+}
+
+static uint16_t AtUrc_Parse_Uint(const char** p)
+{
+    uint16_t v = 0;
+    while (**p >= '0' && **p <= '9')
+    {
+        v = (uint16_t)(v * 10 + (**p - '0'));
+        (*p)++;
+    }
+    return v;
+}
+
+/**
+ * @brief  +QMTRECV 头中出现第 3 个引号时调用：判断主题之后是否带 <len> 字段
+ * @note   +QMTRECV: <client>,<msgid>,"<topic>",<len>,"<payload>"   计长
+ *         +QMTRECV: <client>,<msgid>,"<topic>","<payload>"         按行
+ */
+static void AtUrc_Check_Length_Field(AtUrc_Framer_t* f)
+{
+    const char* p = &f->line[f->quote2 + 1];
+    const char* end = &f->line[f->len - 1];     // 第 3 个引号
+    uint16_t n;
+
+    if (*p != ',' || !(p[1] >= '0' && p[1] <= '9'))
+    {
+        return;
+    }
+    p++;
+    n = AtUrc_Parse_Uint(&p);
+    if (*p != ',' || p + 1 != end)
+    {
+        return;
+    }
+
+    f->payload_start = f->len;
+    if (n == 0)
+    {
+        f->payload_end = f->len;
+    }
+    else if ((uint32_t)f->len + n > AT_URC_LINE_SIZE)
+    {
+        f->mode = AT_URC_MODE_SKIP_COUNTED;
+        f->remaining = n;
+        f->dropped_lines++;
+    }
+    else
+    {
+        f->mode = AT_URC_MODE_COUNTED;
+        f->remaining = n;
+    }
+}
+
+// 一行结束：+QMTRECV 切出主题和负载交给 on_recv，其余交给 on_line
+static void AtUrc_End_Line(AtUrc_Framer_t* f)
+{
+    uint16_t len = f->len;
+
+    if (len > f->payload_end && f->line[len - 1] == '\r')
+    {
+        len--;
+    }
+    f->line[len] = '\0';
+    if (len == 0)
+    {
+        return;
+    }
+
+    if (AtUrc_Is_Recv(f) && f->quotes >= 2)
+    {
+        AtUrc_Recv_t msg;
+        const char* p = &f->line[RECV_HEAD_LEN];
+        uint16_t start;
+        uint16_t end;
+
+        while (*p == ' ') p++;
+        AtUrc_Parse_Uint(&p);                   // client_idx
+        if (*p == ',') p++;
+        msg.msgid = AtUrc_Parse_Uint(&p);
+        if (*p == ',') p++;
+
+        if (*p == '"' && p < &f->line[f->quote2])
+        {
+            msg.topic = p + 1;
+            msg.topic_len = (uint16_t)(&f->line[f->quote2] - msg.topic);
+
+            if (f->payload_end > 0)
+            {
+                start = f->payload_start;
+                end = f->payload_end;
+            }
+            else
+            {
+                // 按行的负载：主题之后是 ,"<payload>"，负载本身可以含引号，以行尾的引号为准
+                start = f->quote2 + 3;
+                end = len;
+                if (end > start && f->line[end - 1] == '"')
+                {
+                    end--;
+                }
+                if (f->quotes < 3 || f->line[f->quote2 + 1] != ',')
+                {
+                    start = end + 1;    // 没有负载字段，按普通行处理
+                }
+            }
+            if (start <= end)
+            {
+                f->line[f->quote2] = '\0';
+                f->line[end] = '\0';
+                msg.payload = &f->line[start];
+                msg.payload_len = (uint16_t)(end - start);
+                if (f->on_recv != NULL)
+                {
+                    f->on_recv(&msg);
+                }
+                return;
+            }
+        }
+    }
+
+    if (f->on_line != NULL)
+    {
+        f->on_line(f->line, len);
+    }
+}
+
+void AtUrc_Init(AtUrc_Framer_t* f, AtUrc_Line_Handler_t on_line, AtUrc_Recv_Handler_t on_recv,
+                AtUrc_Prompt_Handler_t on_prompt)
+{
+    memset(f, 0, sizeof(*f));
+    f->on_line = on_line;
+    f->on_recv = on_recv;
+    f->on_prompt = on_prompt;
+    AtUrc_Reset_Line(f);
+}
+
+/**
+ * @brief  送入一段接收到的数据，可以在任意位置切分
+ * @note   每个完整的帧在本函数内同步回调一次
+ */
+void AtUrc_Feed(AtUrc_Framer_t* f, const uint8_t* data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        char c = (char)data[i];
+
+        switch (f->mode)
+        {
+        case AT_URC_MODE_COUNTED:
+            f->line[f->len++] = c;
+            if (--f->remaining == 0)
+            {
+                f->payload_end = f->len;
+                f->mode = AT_URC_MODE_LINE;
+            }
+            break;
+
+        case AT_URC_MODE_SKIP_COUNTED:
+            if (--f->remaining == 0)
+            {
+                f->mode = AT_URC_MODE_DISCARD;
+            }
+            break;
+
+        case AT_URC_MODE_DISCARD:
+            if (c == '\n')
+            {
+                AtUrc_Reset_Line(f);
+            }
+            break;
+
+        default:
+            if (c == '\n')
+            {
+                AtUrc_End_Line(f);
+                AtUrc_Reset_Line(f);
+                break;
+            }
+            // 数据输入提示符 "> " 出现在行首且没有行尾，立即回调；紧随的空格丢弃
+            if (f->len == 0 && f->on_prompt != NULL && (c == '>' || c == ' '))
+            {
+                if (c == '>')
+                {
+                    f->on_prompt();
+                }
+                break;
+            }
+            if (f->len >= AT_URC_LINE_SIZE)
+            {
+                f->dropped_lines++;
+                f->mode = AT_URC_MODE_DISCARD;
+                break;
+            }
+            f->line[f->len++] = c;
+
+            // 只在 +QMTRECV 头部数引号，负载中的引号不影响分帧
+            if (c == '"' && f->quotes < 3 && AtUrc_Is_Recv(f))
+            {
+                f->quotes++;
+                if (f->quotes == 2)
+                {
+                    f->quote2 = f->len - 1;
+                }
+                else if (f->quotes == 3)
+                {
+                    AtUrc_Check_Length_Field(f);
+                }
+            }
+            break;
+        }
+    }
+}
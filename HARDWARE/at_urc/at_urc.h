@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ * @ 名称  AT 应答/URC 流式分帧器
+ * @ 描述  逐字节消费 USART1 收到的数据，与数据到达的批次无关：模组把几条 URC 连在一起发，
+ *         或把一条拆成几段发，得到的帧都相同。每个字节只被分帧一次。
+ *         - +QMTRECV 按行解析；带 <len> 字段时按长度读取负载，负载中可以含换行
+ *         - 其余的行 (OK/ERROR/+QMTPUB/+QMTSTAT/...) 原样交给 AT 指令引擎
+ *         - 行首的 '>' 是计长发布的数据输入提示符，模组不带行尾发送，单独回调
+ ******************************************************************************
+ */
+#ifndef __AT_URC_H
+#define __AT_URC_H
+
+#include <stdint.h>
+
+#define AT_URC_LINE_SIZE     1280       // 一行的最大长度 (+QMTRECV 头 + 主题 + 负载)，超长的行整行丢弃
+
+// 一条完整的 +QMTRECV 消息，指针指向分帧器内部缓冲区，只在回调期间有效
+typedef struct {
+    uint16_t    msgid;
+    const char* topic;
+    uint16_t    topic_len;
+    const char* payload;        // 不含两侧引号，以 '\0' 结尾
+    uint16_t    payload_len;
+} AtUrc_Recv_t;
+
+typedef void (*AtUrc_Line_Handler_t)(const char* line, uint16_t len);   // line 不含行尾，以 '\0' 结尾
+typedef void (*AtUrc_Recv_Handler_t)(const AtUrc_Recv_t* msg);
+typedef void (*AtUrc_Prompt_Handler_t)(void);
+
+typedef struct {
+    char     line[AT_URC_LINE_SIZE + 1];
+    uint16_t len;
+    uint8_t  mode;              // AT_URC_MODE_*
+    uint8_t  quotes;            // +QMTRECV 头中已经过的引号数
+    uint16_t quote2;            // 主题结束引号的位置
+    uint16_t payload_start;     // 计长负载在 line 中的起止位置
+    uint16_t payload_end;
+    uint16_t remaining;         // 计长负载还需读入的字节数
+    uint32_t dropped_lines;     // 超长而丢弃的行数
+    AtUrc_Line_Handler_t on_line;
+    AtUrc_Recv_Handler_t on_recv;
+    AtUrc_Prompt_Handler_t on_prompt;
+} AtUrc_Framer_t;
+
+// on_prompt 可为 NULL，此时 '>' 按普通字符处理
+void AtUrc_Init(AtUrc_Framer_t* f, AtUrc_Line_Handler_t on_line, AtUrc_Recv_Handler_t on_recv,
+                AtUrc_Prompt_Handler_t on_prompt);
+void AtUrc_Feed(AtUrc_Framer_t* f, const uint8_t* data, uint16_t len);
+
+#endif
@@ -9,7 +9,5 @@ void Buzzer_On(void);
 
 void Buzzer_Off(void);
 
-void Buzzer_Alarm(uint8_t times);
-
 #endif
 
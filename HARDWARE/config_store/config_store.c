@@ -0,0 +1,188 @@
+#include "config_store.h"
+#include "at24c02.h"
+#include "telemetry_bin.h"
+#include "Frost_Detection.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+static const DeviceConfig_t s_defaults = {
+    .crop_stage = STAGE_MATURATION,
+    .available  = TELEMETRY_AVAIL_SPRINKLERS | TELEMETRY_AVAIL_FANS | TELEMETRY_AVAIL_HEATERS,
+    .pressure   = 0,
+};
+
+static struct {
+    DeviceConfig_t live;        // 当前生效的配置
+    DeviceConfig_t saved;       // EEPROM 中最新记录的内容
+    uint16_t seq;               // 最新记录的序号
+    uint8_t  next_slot;         // 下一次写入的槽位
+    bool     dirty;
+    uint32_t first_change_ms;   // 本轮未保存修改中最早一次的时刻
+    uint32_t last_change_ms;
+} s_store = { .live = s_defaults, .saved = s_defaults, .next_slot = 0 };
+
+static void ConfigStore_Encode(const DeviceConfig_t* cfg, uint16_t seq, uint8_t* out)
+{
+    memset(out, 0, CONFIG_STORE_SLOT_SIZE);
+    out[0] = CONFIG_STORE_MAGIC;
+    out[1] = CONFIG_STORE_VERSION;
+    out[2] = (uint8_t)seq;
+    out[3] = (uint8_t)(seq >> 8);
+    out[4] = cfg->crop_stage;
+    out[5] = cfg->available;
+    out[6] = (uint8_t)cfg->pressure;
+    out[7] = (uint8_t)(cfg->pressure >> 8);
+    for (int i = 0; i < CONFIG_TEMP_OFFSETS; i++)
+    {
+        out[8 + i] = (uint8_t)cfg->temp_offset[i];
+    }
+    uint16_t crc = TelemetryBin_Crc16(out, CONFIG_STORE_SLOT_SIZE - 2);
+    out[14] = (uint8_t)crc;
+    out[15] = (uint8_t)(crc >> 8);
+}
+
+// 校验标志、版本与 CRC，通过时解出配置与序号
+static bool ConfigStore_Decode(const uint8_t* in, DeviceConfig_t* cfg, uint16_t* seq)
+{
+    uint16_t crc = (uint16_t)(in[14] | (in[15] << 8));
+    if (in[0] != CONFIG_STORE_MAGIC || in[1] != CONFIG_STORE_VERSION ||
+        crc != TelemetryBin_Crc16(in, CONFIG_STORE_SLOT_SIZE - 2))
+    {
+        return false;
+    }
+    *seq = (uint16_t)(in[2] | (in[3] << 8));
+    cfg->crop_stage = in[4];
+    cfg->available = in[5];
+    cfg->pressure = (uint16_t)(in[6] | (in[7] << 8));
+    for (int i = 0; i < CONFIG_TEMP_OFFSETS; i++)
+    {
+        cfg->temp_offset[i] = (int8_t)in[8 + i];
+    }
+    return true;
+}
+
+/**
+ * @brief  一次顺序读出全部槽位 (224 字节，软件 I2C 约 4ms)，恢复序号最新的有效记录
+ * @note   序号按 16 位回绕比较，差值为正即更新；写入从最新记录的下一个槽位继续
+ */
+uint8_t ConfigStore_Load(void)
+{
+    uint8_t buf[CONFIG_STORE_SLOTS * CONFIG_STORE_SLOT_SIZE];
+    int newest = -1;
+    int valid = 0;
+
+    s_store.live = s_defaults;
+    s_store.saved = s_defaults;
+    s_store.seq = 0;
+    s_store.next_slot = 0;
+    s_store.dirty = false;
+
+    AT24C02_Init();
+    if (AT24C02_Read(CONFIG_STORE_BASE, buf, sizeof(buf)) != 0)
+    {
+        printf("WARN: Config EEPROM not responding, using defaults.\r\n");
+        return 1;
+    }
+
+    for (int slot = 0; slot < CONFIG_STORE_SLOTS; slot++)
+    {
+        DeviceConfig_t cfg;
+        uint16_t seq;
+        if (!ConfigStore_Decode(&buf[slot * CONFIG_STORE_SLOT_SIZE], &cfg, &seq))
+        {
+            continue;
+        }
+        valid++;
+        if (newest < 0 || (int16_t)(seq - s_store.seq) > 0)
+        {
+            newest = slot;
+            s_store.seq = seq;
+            s_store.saved = cfg;
+        }
+    }
+
+    if (newest < 0)
+    {
+        printf("INFO: No stored config found, using defaults.\r\n");
+        return 1;
+    }
+    s_store.live = s_store.saved;
+    s_store.next_slot = (uint8_t)((newest + 1) % CONFIG_STORE_SLOTS);
+    printf("INFO: Config restored from slot %d (seq %u, %d valid records).\r\n",
+           newest, (unsigned)s_store.seq, valid);
+    return 0;
+}
+
+// 逐字段比较，结构体末尾的填充字节不参与
+static bool ConfigStore_Equal(const DeviceConfig_t* a, const DeviceConfig_t* b)
+{
+    return a->crop_stage == b->crop_stage && a->available == b->available &&
+           a->pressure == b->pressure &&
+           memcmp(a->temp_offset, b->temp_offset, sizeof(a->temp_offset)) == 0;
+}
+
+const DeviceConfig_t* ConfigStore_Get(void)
+{
+    return &s_store.live;
+}
+
+void ConfigStore_Set(const DeviceConfig_t* cfg, uint32_t now_ms)
+{
+    s_store.live = *cfg;
+    if (ConfigStore_Equal(&s_store.live, &s_store.saved))
+    {
+        // 改回了已保存的值，不必再写
+        s_store.dirty = false;
+        return;
+    }
+    if (!s_store.dirty)
+    {
+        s_store.dirty = true;
+        s_store.first_change_ms = now_ms;
+    }
+    s_store.last_change_ms = now_ms;
+}
+
+uint8_t ConfigStore_Flush(void)
+{
+    uint8_t rec[CONFIG_STORE_SLOT_SIZE];
+    uint16_t seq = (uint16_t)(s_store.seq + 1);
+
+    if (!s_store.dirty)
+    {
+        return 0;
+    }
+    ConfigStore_Encode(&s_store.live, seq, rec);
+    if (AT24C02_Write((uint8_t)(CONFIG_STORE_BASE + s_store.next_slot * CONFIG_STORE_SLOT_SIZE),
+                      rec, sizeof(rec)) != 0)
+    {
+        printf("WARN: Config write to slot %d failed.\r\n", s_store.next_slot);
+        return 1;
+    }
+    printf("INFO: Config saved to slot %d (seq %u).\r\n", s_store.next_slot, (unsigned)seq);
+    s_store.saved = s_store.live;
+    s_store.seq = seq;
+    s_store.next_slot = (uint8_t)((s_store.next_slot + 1) % CONFIG_STORE_SLOTS);
+    s_store.dirty = false;
+    return 0;
+}
+
+void ConfigStore_Poll(uint32_t now_ms)
+{
+    if (!s_store.dirty)
+    {
+        return;
+    }
+    if (now_ms - s_store.last_change_ms < CONFIG_STORE_SETTLE_MS &&
+        now_ms - s_store.first_change_ms < CONFIG_STORE_MAX_DEFER_MS)
+    {
+        return;
+    }
+    if (ConfigStore_Flush() != 0)
+    {
+        // 写入失败时按新的修改重新计时，避免每轮循环都重试
+        s_store.first_change_ms = now_ms;
+        s_store.last_change_ms = now_ms;
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ * @ 名称  AT24C02 参数存储
+ * @ 描述  把作物阶段、设备可用性、云端设置的气压与温度校准偏移保存在 EEPROM 中，
+ *         重启后不必等联网从云端重新获取。0x20..0xFF 分为 14 个 16 字节槽位 (每槽两页)，
+ *         每次保存写入下一个槽位并把序号加一，擦写次数平摊到全部槽位。
+ *         上电时一次顺序读出全部槽位，取 CRC 正确且序号最新的记录；
+ *         写入掉电只会损坏正在写的槽位，上一条记录仍然有效。
+ *         修改先只更新内存，静默 CONFIG_STORE_SETTLE_MS 后才写入，连续多次修改合并为一次写入。
+ *
+ *  偏移  类型      字段
+ *   0    u8        标志 (CONFIG_STORE_MAGIC)
+ *   1    u8        记录格式版本 (CONFIG_STORE_VERSION)，版本不符的记录视为无效
+ *   2    u16       序号，回绕比较
+ *   4    u8        crop_stage
+ *   5    u8        设备可用性: TELEMETRY_AVAIL_* 的组合
+ *   6    u16       pressure            (hPa，0 表示未设置)
+ *   8    i8 x5     temp1..temp4, ambient 校准偏移 (0.1°C)
+ *  13    u8        保留
+ *  14    u16       CRC-16/CCITT-FALSE (字节 0..13)
+ ******************************************************************************
+ */
+#ifndef __CONFIG_STORE_H
+#define __CONFIG_STORE_H
+
+#include <stdint.h>
+
+#define CONFIG_STORE_MAGIC          0xC5
+#define CONFIG_STORE_VERSION        1
+#define CONFIG_STORE_BASE           0x20    // 0x00..0x1F 留给 at24c02.h 中的旧地址
+#define CONFIG_STORE_SLOT_SIZE      16
+#define CONFIG_STORE_SLOTS          14
+#define CONFIG_STORE_SETTLE_MS      2000    // 最后一次修改后静默这么久才写入
+#define CONFIG_STORE_MAX_DEFER_MS   30000   // 持续修改时最迟这么久也写入一次
+
+#define CONFIG_TEMP_OFFSETS         5       // temp1..temp4, ambient
+
+typedef struct {
+    uint8_t  crop_stage;
+    uint8_t  available;                         // TELEMETRY_AVAIL_* 的组合
+    uint16_t pressure;                          // hPa，0 表示未设置，沿用传感器值
+    int8_t   temp_offset[CONFIG_TEMP_OFFSETS];  // 0.1°C
+} DeviceConfig_t;
+
+// 读出全部槽位并恢复最新记录：返回 0 已恢复，1 没有有效记录 (使用默认值)
+uint8_t ConfigStore_Load(void);
+const DeviceConfig_t* ConfigStore_Get(void);
+// 更新内存中的配置，与已保存内容不同时安排一次延迟写入
+void ConfigStore_Set(const DeviceConfig_t* cfg, uint32_t now_ms);
+// 主循环调用：到期时把待写配置写入下一个槽位
+void ConfigStore_Poll(uint32_t now_ms);
+// 立即写入待写配置 (停机或复位前)，返回 0 成功或无需写入
+uint8_t ConfigStore_Flush(void);
+
+#endif
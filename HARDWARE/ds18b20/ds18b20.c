@@ -147,69 +147,206 @@ void DS18B20_Start(u8 sensor_index) // ds1820 start convert
   DS18B20_Write_Byte(sensor_index,0x44); // convert
 }
 
-// 初始化特定传感器的DS18B20的IO口 DQ 并检测DS的存在
-// 返回1: 不存在
-// 返回0: 存在且已配置
-u8 DS18B20_Init(u8 sensor_index)
+// 配置引脚为推挽输出并释放总线 (高电平空闲)
+static void DS18B20_Pin_Setup(u8 sensor_index)
 {
-    // 使能GPIOC时钟
+    // 使能GPIOA~GPIOD时钟
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE); 
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE); 
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC, ENABLE); 
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOD, ENABLE); 
-    // 初始化特定引脚为开漏输出（1-wire的初始状态）
-    GPIO_InitTypeDef GPIO_InitStructure;
-    GPIO_InitStructure.GPIO_Pin = DS18B20_PINS[sensor_index];
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP; // 开漏输出
-    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-    GPIO_Init(DS18B20_PORT[sensor_index], &GPIO_InitStructure);
-    
-    // 确保引脚初始为高电平（总线空闲状态）
+    DS18B20_SetPin_Output(sensor_index);
     GPIO_SetBits(DS18B20_PORT[sensor_index],DS18B20_PINS[sensor_index]);
+}
+
+// Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1，低位先行)
+static u8 DS18B20_Crc8(const u8 *data, u8 len)
+{
+    u8 crc = 0;
+    while (len--)
+    {
+        u8 b = *data++;
+        for (u8 i = 0; i < 8; i++)
+        {
+            u8 mix = (crc ^ b) & 0x01;
+            crc >>= 1;
+            if (mix)
+            {
+                crc ^= 0x8C;
+            }
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+// 读暂存器并与目标配置比较 (含 CRC 校验)，一致时返回 1，无需再写 EEPROM
+static u8 DS18B20_Config_Matches(u8 sensor_index)
+{
+    u8 sp[9];
+    u8 i;
+
+    DS18B20_Rst(sensor_index);
+    if (DS18B20_Check(sensor_index))
+    {
+        return 0;
+    }
+    DS18B20_Write_Byte(sensor_index, 0xCC); // Skip ROM
+    DS18B20_Write_Byte(sensor_index, 0xBE); // 读暂存器
+    for (i = 0; i < 9; i++)
+    {
+        sp[i] = DS18B20_Read_Byte(sensor_index);
+    }
+    return DS18B20_Crc8(sp, 8) == sp[8] &&
+           sp[2] == DS18B20_CFG_TH && sp[3] == DS18B20_CFG_TL && sp[4] == DS18B20_CFG_RES;
+}
+
+// 写暂存器并复制到 EEPROM；调用方需在下一次访问该传感器前等待 DS18B20_COPY_MS
+static void DS18B20_Write_Config(u8 sensor_index)
+{
+    DS18B20_Rst(sensor_index);
+    DS18B20_Check(sensor_index);
+    DS18B20_Write_Byte(sensor_index, 0xCC); // Skip ROM
+    DS18B20_Write_Byte(sensor_index, 0x4E); // 写入暂存器命令
+    DS18B20_Write_Byte(sensor_index, DS18B20_CFG_TH);  // 报警阈值上限 TH
+    DS18B20_Write_Byte(sensor_index, DS18B20_CFG_TL);  // 报警阈值下限 TL
+    DS18B20_Write_Byte(sensor_index, DS18B20_CFG_RES); // 分辨率
+    
+    DS18B20_Rst(sensor_index);
+    DS18B20_Check(sensor_index);
+    DS18B20_Write_Byte(sensor_index, 0xCC); // Skip ROM
+    DS18B20_Write_Byte(sensor_index, 0x48); // 复制暂存器到EEPROM
+    
+    DS18B20_DQ_HIGH(DS18B20_PORT[sensor_index],DS18B20_PINS[sensor_index]); // 释放总线
+}
+
+// 初始化特定传感器的DS18B20的IO口 DQ 并检测DS的存在
+// 配置与目标一致时不再写 EEPROM (EEPROM 写入寿命有限，且每次要等 10ms)
+// 返回1: 不存在
+// 返回0: 存在且已配置
+u8 DS18B20_Init(u8 sensor_index)
+{
+    DS18B20_Pin_Setup(sensor_index);
 
     DS18B20_Rst(sensor_index);
     if (DS18B20_Check(sensor_index))
     {   // 设备不存在
         return 1;
     }
-    else
+    if (!DS18B20_Config_Matches(sensor_index))
     {
-        DS18B20_Write_Byte(sensor_index, 0xCC); // Skip ROM
-        DS18B20_Write_Byte(sensor_index, 0x4E); // 写入暂存器命令
-        DS18B20_Write_Byte(sensor_index, 100);  // 写入报警阈值上限 TH（100℃）
-        DS18B20_Write_Byte(sensor_index, 0x00);  // 写入报警阈值下限 TL（0℃）
-        DS18B20_Write_Byte(sensor_index, 0x7F);  // 设置分辨率（0x1F=9位, 0x3F=10位, 0x5F=11位, 0x7F=12位）
-        
-     
-        DS18B20_Rst(sensor_index);
-        DS18B20_Check(sensor_index);
-        DS18B20_Write_Byte(sensor_index, 0xCC); // Skip ROM
-        DS18B20_Write_Byte(sensor_index, 0x48); // 复制暂存器到EEPROM
-        
-        
-        DS18B20_DQ_HIGH(DS18B20_PORT[sensor_index],DS18B20_PINS[sensor_index]); // 释放总线
-        return 0;
+        DS18B20_Write_Config(sensor_index);
+        delay_ms(DS18B20_COPY_MS);
     }
+    return 0;
 }
 
-// 初始化所有DS18B20传感器
-void DS18B20_InitAll(void)
+/**
+ * @brief  四路总线同时发复位脉冲，在同一个应答窗口内采样各路的存在脉冲
+ * @return bit i 为 1 表示传感器 i 存在
+ */
+u8 DS18B20_Probe_All(void)
 {
     u8 i;
+    u8 present = 0;
+    u16 t;
+
     for (i = 0; i < DS18B20_COUNT; i++)
     {
-        if (DS18B20_Init(i)==0)
+        DS18B20_Pin_Setup(i);
+        DS18B20_DQ_LOW(DS18B20_PORT[i], DS18B20_PINS[i]);
+    }
+    delay_us(750);
+    for (i = 0; i < DS18B20_COUNT; i++)
+    {
+        DS18B20_DQ_HIGH(DS18B20_PORT[i], DS18B20_PINS[i]);
+        DS18B20_SetPin_Input(i);
+    }
+    // 存在脉冲在释放后 15~60us 出现并持续 60~240us
+    for (t = 0; t < 240; t++)
+    {
+        for (i = 0; i < DS18B20_COUNT; i++)
         {
-            
-            printf("DS18B20 sensor %d successfully initialized!\r\n", i);
-            delay_ms(500);
+            if (!DS18B20_DQ_READ(DS18B20_PORT[i], DS18B20_PINS[i]))
+            {
+                present |= 1 << i;
+            }
         }
-        else 
-        {   
+        delay_us(1);
+    }
+    delay_us(240); // 应答时隙至少 480us
+    return present;
+}
+
+/**
+ * @brief  启动阶段初始化全部 DS18B20：并行探测，仅在配置不同时写 EEPROM，然后同时启动第一次转换
+ * @return 存在的传感器掩码，交给 DS18B20_Wait_Conversion() 等待第一次转换完成
+ * @note   12 位转换最长 750ms，调用方可以在这段时间里初始化其他外设
+ */
+u8 DS18B20_InitAll(void)
+{
+    u8 i;
+    u8 present = DS18B20_Probe_All();
+    u8 copied = 0;
+
+    for (i = 0; i < DS18B20_COUNT; i++)
+    {
+        if (!(present & (1 << i)))
+        {
             // 处理错误，例如打印消息说明传感器i未找到
             printf("DS18B20 sensor %d not found or failed to initialize!\r\n",i);
+            continue;
+        }
+        if (DS18B20_Config_Matches(i))
+        {
+            printf("DS18B20 sensor %d successfully initialized!\r\n", i);
+        }
+        else
+        {
+            DS18B20_Write_Config(i);
+            copied = 1;
+            printf("DS18B20 sensor %d successfully initialized (config written to EEPROM)!\r\n", i);
+        }
+    }
+    if (copied)
+    {
+        delay_ms(DS18B20_COPY_MS);
+    }
+    for (i = 0; i < DS18B20_COUNT; i++)
+    {
+        if (present & (1 << i))
+        {
+            DS18B20_Start(i);
+        }
+    }
+    return present;
+}
+
+/**
+ * @brief  轮询各传感器的读时隙，转换进行中返回 0，完成后返回 1
+ * @return 超时后仍未完成的传感器掩码，0 表示全部完成
+ */
+u8 DS18B20_Wait_Conversion(u8 mask, u16 timeout_ms)
+{
+    uint64_t start = System_GetTimeMs();
+    u8 i;
+
+    while (mask)
+    {
+        for (i = 0; i < DS18B20_COUNT; i++)
+        {
+            if ((mask & (1 << i)) && DS18B20_Read_Bit(i))
+            {
+                mask &= ~(1 << i);
+            }
+        }
+        if (mask == 0 || System_GetTimeMs() - start >= timeout_ms)
+        {
+            break;
         }
+        delay_ms(1);
     }
+    return mask;
 }
 
 
@@ -16,6 +16,13 @@
 #define DS18B20_PIN_2 GPIO_Pin_14
 #define DS18B20_PIN_3 GPIO_Pin_1
 
+// 目标配置：TH 100℃、TL 0℃、12 位分辨率 (0x1F=9位, 0x3F=10位, 0x5F=11位, 0x7F=12位)
+#define DS18B20_CFG_TH      100
+#define DS18B20_CFG_TL      0x00
+#define DS18B20_CFG_RES     0x7F
+#define DS18B20_COPY_MS     10      // 暂存器复制到 EEPROM 的最长时间
+#define DS18B20_CONV_MS     750     // 12 位转换的最长时间
+
 // 用于方便迭代的引脚数组
 extern const u16 DS18B20_PINS[DS18B20_COUNT];
 extern GPIO_TypeDef * DS18B20_PORT[DS18B20_COUNT];
@@ -38,8 +45,10 @@ u8 DS18B20_Read_Bit(u8 sensor_index);               // 从特定的DS18B20读取
 u8 DS18B20_Check(u8 sensor_index);                  // 检测特定的DS18B20是否存在
 void DS18B20_Rst(u8 sensor_index);                  // 复位特定的DS18B20    
 
-// 初始化所有DS18B20传感器的函数
-void DS18B20_InitAll(void);
+// 初始化所有DS18B20传感器的函数：并行探测、按需写配置并启动第一次转换，返回存在的传感器掩码
+u8 DS18B20_InitAll(void);
+u8 DS18B20_Probe_All(void);                         // 四路同时复位，返回存在脉冲掩码
+u8 DS18B20_Wait_Conversion(u8 mask, u16 timeout_ms); // 等待转换完成，返回仍未完成的掩码
 
 #endif
 
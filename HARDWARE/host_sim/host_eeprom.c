@@ -0,0 +1,73 @@
+#include "host_sim.h"
+#include "at24c02.h"
+#include "delay.h"
+#include <string.h>
+
+HostEeprom_t g_host_eeprom;
+
+// 出厂状态全部为 0xFF；首次访问时初始化，之后内容在整个进程内保留
+static void HostEeprom_Ensure(void)
+{
+    if (!g_host_eeprom.formatted)
+    {
+        memset(g_host_eeprom.mem, 0xFF, sizeof(g_host_eeprom.mem));
+        g_host_eeprom.formatted = 1;
+    }
+}
+
+void AT24C02_Init(void)
+{
+    HostEeprom_Ensure();
+}
+
+/* 按软件 I2C 约 25us/字节计时，每页写周期 3.5ms (ACK 轮询到的典型值) */
+uint8_t AT24C02_Write(uint8_t Addr, const uint8_t* Data, uint16_t Len)
+{
+    uint16_t addr = Addr;
+
+    HostEeprom_Ensure();
+    if (addr + Len > AT24C02_SIZE)
+    {
+        return 1;
+    }
+    while (Len > 0)
+    {
+        uint16_t chunk = AT24C02_PAGE_SIZE - (addr % AT24C02_PAGE_SIZE);
+        if (chunk > Len)
+        {
+            chunk = Len;
+        }
+        memcpy(&g_host_eeprom.mem[addr], Data, chunk);
+        delay_us(25 * (chunk + 2) + 3500);
+        g_host_eeprom.page_writes++;
+        addr += chunk;
+        Data += chunk;
+        Len -= chunk;
+    }
+    return 0;
+}
+
+uint8_t AT24C02_Read(uint8_t Addr, uint8_t* Data, uint16_t Len)
+{
+    HostEeprom_Ensure();
+    if ((uint16_t)Addr + Len > AT24C02_SIZE)
+    {
+        return 1;
+    }
+    memcpy(Data, &g_host_eeprom.mem[Addr], Len);
+    delay_us(25 * (Len + 3));
+    return 0;
+}
+
+void AT24C02_WriteByte(uint8_t Addr, uint8_t Data)
+{
+    AT24C02_Write(Addr, &Data, 1);
+}
+
+uint8_t AT24C02_ReadByte(uint8_t Addr)
+{
+    uint8_t Data = 0xFF;
+
+    AT24C02_Read(Addr, &Data, 1);
+    return Data;
+}
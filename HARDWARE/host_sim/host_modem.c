@@ -0,0 +1,534 @@
+#include "host_modem.h"
+#include "host_sim.h"
+#include "hal_host.h"
+#include "delay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_MODEM_OUT_DEPTH    32      // 待输出的应答/URC 条数
+#define HOST_MODEM_OUT_SIZE     1600    // 单条输出上限 (+QMTRECV 头 + 主题 + 负载)
+#define HOST_MODEM_LINE_SIZE    2048
+#define HOST_BROKER_MAX_SUBS    8
+#define HOST_BROKER_DOWN_DEPTH  8       // 穿插模式下等待送出的下行消息
+
+/* 按到期时间先后送出的输出队列：到期时间单调不减，保证与真实模组一样逐条串行输出 */
+typedef struct {
+    uint64_t due_ms;
+    uint16_t len;
+    uint16_t sent;                      // 分片模式下已送出的字节数
+    char     data[HOST_MODEM_OUT_SIZE];
+} HostModemOut_t;
+
+static HostModem_Config_t s_cfg;
+static HostModem_Stats_t  s_stats;
+static HostBroker_Publish_Hook_t s_publish_hook;
+
+static HostModemOut_t s_out[HOST_MODEM_OUT_DEPTH];
+static uint8_t  s_out_head;
+static uint8_t  s_out_count;
+static uint64_t s_out_last_due;
+
+static char     s_line[HOST_MODEM_LINE_SIZE];
+static uint16_t s_line_len;
+
+/* 计长发布：回 "> " 后按长度收取负载 */
+static char     s_data[HOST_MODEM_LINE_SIZE];
+static uint16_t s_data_len;
+static uint16_t s_data_remaining;
+static unsigned s_data_msgid;
+static unsigned s_data_qos;
+static char     s_data_topic[256];
+
+static int      s_opened;
+static int      s_connected;
+static uint64_t s_connected_ms;
+static uint32_t s_rng;
+static uint16_t s_down_msgid;
+static uint8_t  s_seen_msgid[65536 / 8];   // 代理收到过的 msgid，用于统计重发
+
+static char     s_subs[HOST_BROKER_MAX_SUBS][128];
+static uint8_t  s_sub_count;
+
+static char     s_down[HOST_BROKER_DOWN_DEPTH][HOST_MODEM_OUT_SIZE];
+static uint8_t  s_down_count;
+
+static int      s_hook_registered;
+
+static uint32_t HostModem_Rand(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static int HostModem_Chance(uint8_t pct)
+{
+    return pct > 0 && (HostModem_Rand() % 100) < pct;
+}
+
+// 排入一条输出，delay_ms 之后 (再加随机抖动) 开始到达
+static void HostModem_Emit(const char* data, uint16_t len, uint32_t delay_ms)
+{
+    if (s_out_count >= HOST_MODEM_OUT_DEPTH || len > HOST_MODEM_OUT_SIZE)
+    {
+        fprintf(stderr, "host_modem: output queue full, dropping %u bytes\n", len);
+        return;
+    }
+
+    uint64_t due = System_GetTimeMs() + delay_ms;
+    if (s_cfg.jitter_ms > 0)
+    {
+        due += HostModem_Rand() % (s_cfg.jitter_ms + 1);
+    }
+    if (due < s_out_last_due)
+    {
+        due = s_out_last_due;
+    }
+    s_out_last_due = due;
+
+    HostModemOut_t* o = &s_out[(s_out_head + s_out_count) % HOST_MODEM_OUT_DEPTH];
+    o->due_ms = due;
+    o->len = len;
+    o->sent = 0;
+    memcpy(o->data, data, len);
+    s_out_count++;
+}
+
+static void HostModem_Emit_Str(const char* s, uint32_t delay_ms)
+{
+    HostModem_Emit(s, (uint16_t)strlen(s), delay_ms);
+}
+
+// 每毫秒检查输出队列，到期的输出写入 USART1 接收方向
+static void HostModem_TickHook(uint64_t now_ms)
+{
+    if (s_connected && s_cfg.disconnect_every_ms > 0 && now_ms - s_connected_ms >= s_cfg.disconnect_every_ms)
+    {
+        HostModem_Disconnect();
+    }
+
+    while (s_out_count > 0)
+    {
+        HostModemOut_t* o = &s_out[s_out_head];
+        if (o->due_ms > now_ms)
+        {
+            break;
+        }
+        uint16_t n = o->len - o->sent;
+        if (s_cfg.fragment > 0 && n > s_cfg.fragment)
+        {
+            n = s_cfg.fragment;
+        }
+        Host_UART1_Inject((const uint8_t*)&o->data[o->sent], n, 0);
+        o->sent += n;
+        if (o->sent < o->len)
+        {
+            break;          // 分片模式：下一毫秒继续
+        }
+        s_out_head = (uint8_t)((s_out_head + 1) % HOST_MODEM_OUT_DEPTH);
+        s_out_count--;
+    }
+}
+
+/*
+ ===============================================================================
+                            迷你代理
+ ===============================================================================
+*/
+
+// MQTT 主题过滤：支持单层 '+' 与末尾 '#'
+static int HostBroker_Match(const char* filter, const char* topic)
+{
+    while (*filter != '\0')
+    {
+        if (*filter == '#')
+        {
+            return 1;
+        }
+        if (*filter == '+')
+        {
+            while (*topic != '\0' && *topic != '/') topic++;
+            filter++;
+            continue;
+        }
+        if (*filter != *topic)
+        {
+            return 0;
+        }
+        filter++;
+        topic++;
+    }
+    return *topic == '\0';
+}
+
+static int HostBroker_Subscribed(const char* topic)
+{
+    for (uint8_t i = 0; i < s_sub_count; i++)
+    {
+        if (HostBroker_Match(s_subs[i], topic))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 上行发布到达代理
+static void HostBroker_Receive(const char* topic, const char* payload, uint16_t len, unsigned msgid)
+{
+    s_stats.publishes++;
+    s_stats.publish_bytes += len;
+    if (msgid != 0)
+    {
+        if (s_seen_msgid[msgid / 8] & (1u << (msgid % 8)))
+        {
+            s_stats.duplicates++;
+        }
+        s_seen_msgid[msgid / 8] |= (uint8_t)(1u << (msgid % 8));
+    }
+    if (s_publish_hook != NULL)
+    {
+        s_publish_hook(topic, payload, len, System_GetTimeMs());
+    }
+}
+
+static int HostBroker_Format_Recv(char* out, const char* topic, const char* payload)
+{
+    size_t plen = strlen(payload);
+
+    if (++s_down_msgid == 0)
+    {
+        s_down_msgid = 1;
+    }
+    if (s_cfg.counted_recv)
+    {
+        return snprintf(out, HOST_MODEM_OUT_SIZE, "\r\n+QMTRECV: 0,%u,\"%s\",%u,\"%s\"\r\n",
+                        s_down_msgid, topic, (unsigned)plen, payload);
+    }
+    return snprintf(out, HOST_MODEM_OUT_SIZE, "\r\n+QMTRECV: 0,%u,\"%s\",\"%s\"\r\n", s_down_msgid, topic, payload);
+}
+
+int HostBroker_Publish(const char* topic, const char* payload)
+{
+    char buf[HOST_MODEM_OUT_SIZE];
+
+    if (!s_connected || !HostBroker_Subscribed(topic))
+    {
+        s_stats.downlinks_dropped++;
+        return -1;
+    }
+    int n = HostBroker_Format_Recv(buf, topic, payload);
+    if (n <= 0 || n >= HOST_MODEM_OUT_SIZE)
+    {
+        s_stats.downlinks_dropped++;
+        return -1;
+    }
+
+    s_stats.downlinks++;
+    if (s_cfg.interleave && s_down_count < HOST_BROKER_DOWN_DEPTH)
+    {
+        memcpy(s_down[s_down_count++], buf, (size_t)n + 1);     // 等下一条指令的 OK 之后送出
+        return 0;
+    }
+    HostModem_Emit(buf, (uint16_t)n, s_cfg.network_latency_ms);
+    return 0;
+}
+
+void HostBroker_Set_Publish_Hook(HostBroker_Publish_Hook_t hook)
+{
+    s_publish_hook = hook;
+}
+
+/*
+ ===============================================================================
+                            AT 指令
+ ===============================================================================
+*/
+
+// "OK" 之后紧跟结果 URC；穿插模式下把积压的下行消息插在两者之间
+static void HostModem_Reply(const char* result_urc)
+{
+    HostModem_Emit_Str("\r\nOK\r\n", s_cfg.at_latency_ms);
+    for (uint8_t i = 0; i < s_down_count; i++)
+    {
+        HostModem_Emit_Str(s_down[i], s_cfg.at_latency_ms);
+    }
+    s_down_count = 0;
+    if (result_urc != NULL)
+    {
+        HostModem_Emit_Str(result_urc, s_cfg.network_latency_ms);
+    }
+}
+
+static void HostModem_Error(void)
+{
+    s_stats.errors++;
+    HostModem_Emit_Str("\r\nERROR\r\n", s_cfg.at_latency_ms);
+}
+
+static void HostModem_Publish_Result(unsigned msgid, unsigned qos)
+{
+    char urc[48];
+
+    if (qos > 0 && HostModem_Chance(s_cfg.puback_loss_pct))
+    {
+        s_stats.pubacks_lost++;
+        HostModem_Reply(NULL);
+        return;
+    }
+    snprintf(urc, sizeof(urc), "\r\n+QMTPUB: 0,%u,0\r\n", qos > 0 ? msgid : 0);
+    HostModem_Reply(urc);
+}
+
+// AT+QMTPUB=<client>,<msgid>,<qos>,<retain>,"<topic>","<payload>" 或 ...,"<topic>",<len>
+static void HostModem_Handle_Publish(const char* args)
+{
+    char* end;
+    unsigned msgid = (unsigned)strtoul(args, &end, 10);
+    unsigned qos = (*end == ',') ? (unsigned)strtoul(end + 1, &end, 10) : 0;
+    const char* t0 = strchr(args, '"');
+    const char* t1 = (t0 != NULL) ? strchr(t0 + 1, '"') : NULL;
+
+    if (t1 == NULL || !s_connected)
+    {
+        HostModem_Error();
+        return;
+    }
+
+    size_t tlen = (size_t)(t1 - t0 - 1);
+    if (tlen >= sizeof(s_data_topic))
+    {
+        tlen = sizeof(s_data_topic) - 1;
+    }
+    memcpy(s_data_topic, t0 + 1, tlen);
+    s_data_topic[tlen] = '\0';
+
+    if (t1[1] == ',' && t1[2] >= '0' && t1[2] <= '9')
+    {
+        // 计长形式：回提示符，负载由 HostModem_Tx 按长度收取
+        s_data_remaining = (uint16_t)strtoul(t1 + 2, NULL, 10);
+        s_data_len = 0;
+        s_data_msgid = msgid;
+        s_data_qos = qos;
+        HostModem_Emit_Str("\r\n> ", s_cfg.at_latency_ms);
+        return;
+    }
+    if (t1[1] != ',' || t1[2] != '"')
+    {
+        HostModem_Error();
+        return;
+    }
+
+    const char* p0 = t1 + 3;
+    const char* p1 = strrchr(p0, '"');
+    uint16_t plen = (uint16_t)((p1 != NULL) ? (size_t)(p1 - p0) : strlen(p0));
+
+    HostBroker_Receive(s_data_topic, p0, plen, qos > 0 ? msgid : 0);
+    HostModem_Publish_Result(msgid, qos);
+}
+
+// AT+QMTSUB=<client>,<msgid>,"<topic1>",<qos1>[,"<topic2>",<qos2>...]
+static void HostModem_Handle_Subscribe(const char* args)
+{
+    char urc[64];
+    unsigned msgid = (unsigned)strtoul(args, NULL, 10);
+    const char* p = args;
+    int n = 0;
+
+    if (!s_connected)
+    {
+        HostModem_Error();
+        return;
+    }
+    while ((p = strchr(p, '"')) != NULL)
+    {
+        const char* q = strchr(p + 1, '"');
+        if (q == NULL)
+        {
+            break;
+        }
+        if (s_sub_count < HOST_BROKER_MAX_SUBS && (size_t)(q - p - 1) < sizeof(s_subs[0]))
+        {
+            memcpy(s_subs[s_sub_count], p + 1, (size_t)(q - p - 1));
+            s_subs[s_sub_count][q - p - 1] = '\0';
+            s_sub_count++;
+        }
+        n++;
+        p = q + 1;
+    }
+    int len = snprintf(urc, sizeof(urc), "\r\n+QMTSUB: 0,%u,0", msgid);
+    for (int i = 0; i < n && len < (int)sizeof(urc) - 6; i++)
+    {
+        len += snprintf(urc + len, sizeof(urc) - (size_t)len, ",1");
+    }
+    snprintf(urc + len, sizeof(urc) - (size_t)len, "\r\n");
+    HostModem_Reply(urc);
+}
+
+static void HostModem_Handle_Line(const char* line)
+{
+    if (strncmp(line, "AT", 2) != 0)
+    {
+        return;     // 模组不回显、也不应答非 AT 行
+    }
+    s_stats.commands++;
+
+    if (strncmp(line, "AT+QMTPUB=0,", 12) == 0)
+    {
+        HostModem_Handle_Publish(line + 12);
+    }
+    else if (strncmp(line, "AT+QMTSUB=0,", 12) == 0)
+    {
+        HostModem_Handle_Subscribe(line + 12);
+    }
+    else if (strncmp(line, "AT+QMTOPEN=", 11) == 0)
+    {
+        if (s_opened)
+        {
+            HostModem_Reply("\r\n+QMTOPEN: 0,2\r\n");
+        }
+        else if (HostModem_Chance(s_cfg.open_fail_pct))
+        {
+            s_stats.opens_failed++;
+            HostModem_Reply("\r\n+QMTOPEN: 0,3\r\n");
+        }
+        else
+        {
+            s_opened = 1;
+            HostModem_Reply("\r\n+QMTOPEN: 0,0\r\n");
+        }
+    }
+    else if (strncmp(line, "AT+QMTCONN=", 11) == 0)
+    {
+        if (!s_opened)
+        {
+            HostModem_Error();
+            return;
+        }
+        s_connected = 1;
+        s_connected_ms = System_GetTimeMs();
+        s_sub_count = 0;            // 清洁会话：重连后需重新订阅
+        s_stats.connects++;
+        HostModem_Reply("\r\n+QMTCONN: 0,0,0\r\n");
+    }
+    else if (strncmp(line, "AT+QMTCONN?", 11) == 0)
+    {
+        HostModem_Emit_Str(s_connected ? "\r\n+QMTCONN: 0,3\r\n\r\nOK\r\n" : "\r\n+QMTCONN: 0,1\r\n\r\nOK\r\n",
+                           s_cfg.at_latency_ms);
+    }
+    else if (strncmp(line, "AT+QMTDISC=", 11) == 0)
+    {
+        s_connected = 0;
+        s_opened = 0;
+        HostModem_Reply("\r\n+QMTDISC: 0,0\r\n");
+    }
+    else if (strncmp(line, "AT+CIMI", 7) == 0)
+    {
+        HostModem_Emit_Str("\r\n460001234567890\r\n\r\nOK\r\n", s_cfg.at_latency_ms);
+    }
+    else if (strncmp(line, "AT+CGATT?", 9) == 0)
+    {
+        HostModem_Emit_Str("\r\n+CGATT: 1\r\n\r\nOK\r\n", s_cfg.at_latency_ms);
+    }
+    else
+    {
+        HostModem_Reply(NULL);      // AT、AT+CGATT=1、AT+QMTCFG 等
+    }
+}
+
+// USART1 发送方向：按行解析指令，计长发布时按长度收取负载
+static void HostModem_Tx(const uint8_t* data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        char c = (char)data[i];
+
+        if (s_data_remaining > 0)
+        {
+            if (s_data_len < sizeof(s_data))
+            {
+                s_data[s_data_len++] = c;
+            }
+            if (--s_data_remaining == 0)
+            {
+                HostBroker_Receive(s_data_topic, s_data, s_data_len, s_data_qos > 0 ? s_data_msgid : 0);
+                HostModem_Publish_Result(s_data_msgid, s_data_qos);
+            }
+            continue;
+        }
+        if (c == '\n')
+        {
+            s_line[s_line_len] = '\0';
+            HostModem_Handle_Line(s_line);
+            s_line_len = 0;
+        }
+        else if (c != '\r' && s_line_len < sizeof(s_line) - 1)
+        {
+            s_line[s_line_len++] = c;
+        }
+    }
+}
+
+void HostModem_Default_Config(HostModem_Config_t* cfg)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->at_latency_ms = HOST_MODEM_LATENCY_MS;
+    cfg->network_latency_ms = HOST_MODEM_LATENCY_MS;
+    cfg->seed = 1;
+}
+
+void HostModem_Init(const HostModem_Config_t* cfg)
+{
+    if (cfg != NULL)
+    {
+        s_cfg = *cfg;
+    }
+    else
+    {
+        HostModem_Default_Config(&s_cfg);
+    }
+    memset(&s_stats, 0, sizeof(s_stats));
+    memset(s_seen_msgid, 0, sizeof(s_seen_msgid));
+    s_rng = (s_cfg.seed != 0) ? s_cfg.seed : 1;
+    s_out_head = 0;
+    s_out_count = 0;
+    s_out_last_due = 0;
+    s_line_len = 0;
+    s_data_remaining = 0;
+    s_opened = 0;
+    s_connected = 0;
+    s_sub_count = 0;
+    s_down_count = 0;
+
+    Host_UART1_SetTxHandler(HostModem_Tx);
+    if (!s_hook_registered)
+    {
+        Host_Register_Tick_Hook(HostModem_TickHook);
+        s_hook_registered = 1;
+    }
+}
+
+const HostModem_Stats_t* HostModem_Get_Stats(void)
+{
+    return &s_stats;
+}
+
+int HostModem_Is_Connected(void)
+{
+    return s_connected;
+}
+
+void HostModem_Disconnect(void)
+{
+    if (!s_connected)
+    {
+        return;
+    }
+    s_connected = 0;
+    s_opened = 0;
+    s_sub_count = 0;
+    s_stats.disconnects++;
+    HostModem_Emit_Str("\r\n+QMTSTAT: 0,1\r\n", 0);
+}
@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ * @ 名称  主机端 Quectel 模组与 MQTT 代理仿真
+ * @ 描述  在进程内接在 USART1 两端，按 onenet_mqtt.c 使用的 AT 子集应答：
+ *         AT、AT+CIMI、AT+CGATT、AT+QMTCFG、AT+QMTOPEN、AT+QMTCONN、AT+QMTSUB、
+ *         AT+QMTPUB (单行与计长两种形式)、AT+QMTDISC，以及 +QMTRECV/+QMTSTAT URC。
+ *         内置一个只有一个客户端的迷你代理：记录上行发布，按订阅把下行消息转成 +QMTRECV。
+ *         链路延迟、抖动、PUBACK 丢失、建链失败、定时断线、URC 穿插与分片到达均可配置，
+ *         用于离线测量发布吞吐、命令到执行的延迟和重连行为 (见 TOOLS/mqtt_bench)。
+ ******************************************************************************
+ */
+#ifndef __HOST_MODEM_H
+#define __HOST_MODEM_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t at_latency_ms;         // 模组对指令回 OK/ERROR 的延迟
+    uint32_t network_latency_ms;    // 经过代理往返的结果 URC (+QMTOPEN/CONN/SUB/PUB) 的延迟
+    uint32_t jitter_ms;             // 每条输出额外增加 [0, jitter_ms] 的随机延迟
+    uint8_t  puback_loss_pct;       // QoS 1 发布丢失 PUBACK (不回 +QMTPUB 结果) 的概率 %
+    uint8_t  open_fail_pct;         // AT+QMTOPEN 失败 (+QMTOPEN: 0,3) 的概率 %
+    uint32_t disconnect_every_ms;   // 连接保持这么久后由代理断开 (+QMTSTAT: 0,1)，0 表示不断线
+    uint8_t  interleave;            // 1: 下行消息插在下一条指令的 OK 与结果 URC 之间送出
+    uint8_t  counted_recv;          // 1: +QMTRECV 带 <len> 字段
+    uint16_t fragment;              // >0: 输出切成这么多字节一片，每毫秒到达一片
+    uint32_t seed;
+} HostModem_Config_t;
+
+typedef struct {
+    uint32_t commands;              // 收到的 AT 指令数
+    uint32_t publishes;             // 代理收到的发布 (含重发)
+    uint32_t duplicates;            // 其中 msgid 重复的重发
+    uint64_t publish_bytes;         // 发布负载字节数
+    uint32_t pubacks_lost;
+    uint32_t opens_failed;
+    uint32_t connects;              // 成功的 AT+QMTCONN 次数
+    uint32_t disconnects;           // 代理主动断开次数
+    uint32_t downlinks;             // 以 +QMTRECV 送出的下行消息数
+    uint32_t downlinks_dropped;     // 离线或未订阅而丢弃的下行消息数
+    uint32_t errors;                // 回了 ERROR 的指令数 (未连接时发布等)
+} HostModem_Stats_t;
+
+// 代理收到一条上行发布时回调，payload 不以 '\0' 结尾
+typedef void (*HostBroker_Publish_Hook_t)(const char* topic, const char* payload, uint16_t len, uint64_t now_ms);
+
+void HostModem_Default_Config(HostModem_Config_t* cfg);
+// 注册为 USART1 的发送处理函数并复位状态；cfg 为 NULL 时使用默认配置
+void HostModem_Init(const HostModem_Config_t* cfg);
+const HostModem_Stats_t* HostModem_Get_Stats(void);
+int  HostModem_Is_Connected(void);
+// 代理立即断开连接
+void HostModem_Disconnect(void);
+
+// 代理向设备发布一条下行消息：返回 0 已投递，-1 离线或设备未订阅该主题
+int  HostBroker_Publish(const char* topic, const char* payload);
+void HostBroker_Set_Publish_Hook(HostBroker_Publish_Hook_t hook);
+
+#endif
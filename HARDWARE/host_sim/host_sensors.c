@@ -0,0 +1,121 @@
+#include "host_sim.h"
+#include "ds18b20.h"
+#include "dht11.h"
+#include "key.h"
+#include "UART_SENSOR.h"
+#include "delay.h"
+#include <stdio.h>
+
+// 典型辐射霜冻夜：近地面冷、上层暖的逆温分布
+HostWorld_t g_host_world = {
+    .temperatures = { -0.5f, 0.4f, 1.3f, 2.2f },
+    .ambient_temp = 0.4f,
+    .humidity     = 82.0f,
+    .wind_speed   = 0.6f,
+};
+
+/* DS18B20：复位+读暂存器约 2.5ms，配置已一致，不写 EEPROM */
+static uint64_t s_ds18b20_conv_start_ms;
+
+u8 DS18B20_Init(u8 sensor_index)
+{
+    delay_us(1000);
+    return (sensor_index < DS18B20_COUNT) ? 0 : 1;
+}
+
+u8 DS18B20_Probe_All(void)
+{
+    delay_us(1000);
+    return (1 << DS18B20_COUNT) - 1;
+}
+
+u8 DS18B20_InitAll(void)
+{
+    u8 i;
+    u8 present = DS18B20_Probe_All();
+    for (i = 0; i < DS18B20_COUNT; i++)
+    {
+        delay_us(2500);
+        printf("DS18B20 sensor %d successfully initialized!\r\n", i);
+    }
+    s_ds18b20_conv_start_ms = System_GetTimeMs();
+    return present;
+}
+
+/* 转换按最长 750ms 计 */
+u8 DS18B20_Wait_Conversion(u8 mask, u16 timeout_ms)
+{
+    uint64_t done = s_ds18b20_conv_start_ms + DS18B20_CONV_MS;
+    uint64_t now = System_GetTimeMs();
+    (void)timeout_ms;
+    if (now < done)
+    {
+        delay_ms((uint32_t)(done - now));
+    }
+    (void)mask;
+    return 0;
+}
+
+float DS18B20_Get_Temp(u8 sensor_index)
+{
+    delay_us(2500);
+    if (sensor_index >= DS18B20_COUNT)
+    {
+        return 0.0f;
+    }
+    // 按 0.0625°C 分辨率量化，与真实传感器输出一致
+    int raw = (int)(g_host_world.temperatures[sensor_index] * 16.0f);
+    return raw / 16.0f;
+}
+
+/* DHT11：起始信号 20ms + 数据帧约 4ms，输出放大 10 倍的整数 */
+u8 DHT11_Init(void)
+{
+    delay_ms(20);
+    return 0;
+}
+
+u8 DHT11_Read_Data(int *temp, int *humi)
+{
+    delay_ms(24);
+    *temp = (int)(g_host_world.ambient_temp * 10.0f);
+    *humi = (int)(g_host_world.humidity * 10.0f);
+    return 0;
+}
+
+/* ModBUS 风速传感器：沿用真实驱动的 问询 -> 完成 两拍节奏 */
+void ModBUS_Init(void)
+{
+}
+
+void Get_Wind_Data(float *speed, uint16_t *power)
+{
+    if (FREE == air_receved_flag)
+    {
+        delay_ms(501);
+        *speed = g_host_world.wind_speed;
+        *power = (uint16_t)(*speed / 1.5f);
+        air_receved_flag = FINISH;
+    }
+    else
+    {
+        air_receved_flag = FREE;
+        air_error_count = 0;
+        delay_ms(100);
+    }
+}
+
+/* 问询后应答约 10ms 到达，启动阶段的其余工作远长于此，直接视为已接收 */
+void ModBUS_Start_Query(void)
+{
+    if (FREE == air_receved_flag)
+    {
+        wind_speed = g_host_world.wind_speed;
+        air_receved_flag = FINISH;
+    }
+}
+
+/* 按键由主机主程序直接调用 App_Key_xxx() 模拟 */
+void EXTI_KEY_Init(void)
+{
+}
@@ -0,0 +1,43 @@
+/**
+ ******************************************************************************
+ * @ 名称  主机仿真外设
+ * @ 描述  make host 时替代 ds18b20/DHT11/UART_SENSOR/UART_DISPLAY/key/TFT/at24c02 驱动，
+ *         实现相同的头文件接口：传感器读数来自 g_host_world，USART1 连接仿真的
+ *         Quectel 模组与 MQTT 代理 (host_modem.h)，USART2 与调试输出写到标准输出。
+ ******************************************************************************
+ */
+#ifndef __HOST_SIM_H
+#define __HOST_SIM_H
+
+#include <stdint.h>
+#include "ds18b20.h"
+#include "at24c02.h"
+
+// 仿真外部世界：各传感器"看到"的真实物理量
+typedef struct {
+    float temperatures[DS18B20_COUNT];  // 各高度气温 (°C)
+    float ambient_temp;                 // DHT11 环境温度 (°C)
+    float humidity;                     // DHT11 相对湿度 (%)
+    float wind_speed;                   // 风速 (m/s)
+} HostWorld_t;
+
+extern HostWorld_t g_host_world;
+
+// 仿真 AT24C02：内容在进程内保留，测试可直接读写 mem 或统计页写次数
+typedef struct {
+    uint8_t  mem[AT24C02_SIZE];
+    uint8_t  formatted;                 // 0 时首次访问前填充为 0xFF
+    uint32_t page_writes;
+} HostEeprom_t;
+
+extern HostEeprom_t g_host_eeprom;
+
+#define HOST_MODEM_LATENCY_MS   20      // 仿真模组的默认应答延迟
+
+// USART1 发送方向的数据处理函数，默认为仿真模组
+typedef void (*Host_UART_TxHandler_t)(const uint8_t* data, uint16_t len);
+
+void Host_UART1_SetTxHandler(Host_UART_TxHandler_t handler);
+void Host_UART1_Inject(const uint8_t* data, uint16_t len, uint32_t delay_ms);
+
+#endif
@@ -0,0 +1,29 @@
+#include "tft.h"
+#include "tft_driver.h"
+#include "delay.h"
+
+/* 主机端没有屏幕，绘制调用全部丢弃；初始化只保留复位与退出睡眠的等待时间 */
+void Lcd_Init(void)
+{
+    delay_ms(270);
+}
+
+void Lcd_Clear(u16 Color)
+{
+    (void)Color;
+}
+
+void Gui_DrawLine(u16 x0, u16 y0, u16 x1, u16 y1, u16 Color)
+{
+    (void)x0; (void)y0; (void)x1; (void)y1; (void)Color;
+}
+
+void Gui_DrawFont_GBK16(u16 x, u16 y, u16 fc, u16 bc, char *s)
+{
+    (void)x; (void)y; (void)fc; (void)bc; (void)s;
+}
+
+void Display_All_Data(EnvironmentalData_t* env_data)
+{
+    (void)env_data;
+}
@@ -0,0 +1,148 @@
+#include "host_sim.h"
+#include "host_modem.h"
+#include "hal_host.h"
+#include "UART_DISPLAY.h"
+#include "delay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+xUSATR_TypeDef xUSART;
+
+/* 待"接收"的数据：到期后在虚拟时钟钩子里写入接收环形缓冲区 */
+#define HOST_RX_PENDING_SIZE  2048
+
+static uint8_t  s_rx_pending[HOST_RX_PENDING_SIZE];
+static uint16_t s_rx_pending_len;
+static uint64_t s_rx_due_ms;
+
+static Host_UART_TxHandler_t s_tx_handler;
+
+/* 接收环形缓冲区的读写计数，与目标板驱动相同 */
+static uint16_t s_rx_counter;
+static uint16_t s_rx_count;
+
+// 模拟 USART1 的 RXNE 中断
+static void Host_UART1_TickHook(uint64_t now_ms)
+{
+    if (s_rx_pending_len == 0 || now_ms < s_rx_due_ms)
+    {
+        return;
+    }
+
+    for (uint16_t i = 0; i < s_rx_pending_len; i++)
+    {
+        if ((uint16_t)(s_rx_count - s_rx_counter) < U1_RX_BUF_SIZE)
+        {
+            xUSART.USART1ReceivedBuffer[s_rx_count % U1_RX_BUF_SIZE] = s_rx_pending[i];
+            s_rx_count++;
+        }
+        else
+        {
+            xUSART.USART1RxOverflow++;
+        }
+    }
+    s_rx_pending_len = 0;
+}
+
+void Host_UART1_SetTxHandler(Host_UART_TxHandler_t handler)
+{
+    s_tx_handler = handler;
+}
+
+/**
+ * @brief  安排一段数据在 delay_ms 毫秒后出现在 USART1 接收缓冲区
+ * @note   尚未到期的数据会与新数据合并成同一帧
+ */
+void Host_UART1_Inject(const uint8_t* data, uint16_t len, uint32_t delay_ms)
+{
+    if (s_rx_pending_len == 0)
+    {
+        s_rx_due_ms = System_GetTimeMs() + delay_ms;
+    }
+    if (len > HOST_RX_PENDING_SIZE - s_rx_pending_len)
+    {
+        len = HOST_RX_PENDING_SIZE - s_rx_pending_len;
+    }
+    memcpy(&s_rx_pending[s_rx_pending_len], data, len);
+    s_rx_pending_len += len;
+}
+
+/* UART_DISPLAY.h 的主机实现 */
+void USART1_Init(uint32_t baudrate)
+{
+    (void)baudrate;
+    if (xUSART.USART1InitFlag == 0)
+    {
+        Host_Register_Tick_Hook(Host_UART1_TickHook);
+        if (s_tx_handler == NULL)
+        {
+            HostModem_Init(NULL);   // 默认接上仿真模组
+        }
+    }
+    xUSART.USART1InitFlag = 1;
+}
+
+uint16_t USART1_ReadRx(uint8_t* buffer, uint16_t max)
+{
+    uint16_t n = 0;
+
+    while (s_rx_counter != s_rx_count && n < max)
+    {
+        buffer[n++] = xUSART.USART1ReceivedBuffer[s_rx_counter % U1_RX_BUF_SIZE];
+        s_rx_counter++;
+    }
+    return n;
+}
+
+uint8_t USART1_GetBuffer(uint8_t* buffer, uint8_t* cnt)
+{
+    *cnt = (uint8_t)USART1_ReadRx(buffer, 255);
+    return *cnt;
+}
+
+void USART1_SendData(uint8_t* buf, uint16_t cnt)
+{
+    if (s_tx_handler != NULL)
+    {
+        s_tx_handler(buf, cnt);
+    }
+}
+
+void USART1_SendString(char* stringTemp)
+{
+    USART1_SendData((uint8_t*)stringTemp, (uint16_t)strlen(stringTemp));
+}
+
+void USART1_SendStringForDMA(char* stringTemp)
+{
+    USART1_SendString(stringTemp);
+}
+
+void USART2_Init(uint32_t baudrate)
+{
+    (void)baudrate;
+    xUSART.USART2InitFlag = 1;
+}
+
+uint8_t USART2_GetBuffer(uint8_t* buffer, uint8_t* cnt)
+{
+    if (xUSART.USART2ReceivedNum > 0)
+    {
+        memcpy(buffer, xUSART.USART2ReceivedBuffer, xUSART.USART2ReceivedNum);
+        *cnt = xUSART.USART2ReceivedNum;
+        xUSART.USART2ReceivedNum = 0;
+        return *cnt;
+    }
+    return 0;
+}
+
+void USART2_SendData(uint8_t* buf, uint8_t cnt)
+{
+    fwrite(buf, 1, cnt, stdout);
+}
+
+void USART2_SendString(char* stringTemp)
+{
+    fputs(stringTemp, stdout);
+}
@@ -0,0 +1,248 @@
+#include "json_scan.h"
+#include <string.h>
+
+typedef struct {
+    const char* p;
+    const char* end;
+    uint8_t depth;
+    JsonScan_Slice_t key[JSON_SCAN_MAX_DEPTH + 1];  // 每层当前成员的键名，key[0] 为顶层
+    char    closer[JSON_SCAN_MAX_DEPTH + 1];        // 每层期望的结束符 '}' 或 ']'
+    uint8_t expect_key[JSON_SCAN_MAX_DEPTH + 1];    // 对象内下一个记号应为键名
+} JsonScan_State_t;
+
+static void skip_ws(JsonScan_State_t* st)
+{
+    while (st->p < st->end && (*st->p == ' ' || *st->p == '\t' || *st->p == '\r' || *st->p == '\n'))
+    {
+        st->p++;
+    }
+}
+
+// 读取一个字符串，st->p 指向起始引号；成功后指向结束引号之后
+static int scan_string(JsonScan_State_t* st, JsonScan_Slice_t* out)
+{
+    const char* start = ++st->p;
+
+    while (st->p < st->end)
+    {
+        char c = *st->p;
+        if (c == '\\')
+        {
+            st->p += 2;     // 跳过转义字符本身，\uXXXX 的其余部分按普通字符跳过
+            continue;
+        }
+        if (c == '"')
+        {
+            out->ptr = start;
+            out->len = (uint16_t)(st->p - start);
+            st->p++;
+            return 0;
+        }
+        st->p++;
+    }
+    return -1;
+}
+
+static int scan_literal(JsonScan_State_t* st, const char* word, JsonScan_Type_t type, JsonScan_Token_t* tok)
+{
+    size_t n = strlen(word);
+
+    if ((size_t)(st->end - st->p) < n || memcmp(st->p, word, n) != 0)
+    {
+        return -1;
+    }
+    tok->type = type;
+    tok->value.ptr = st->p;
+    tok->value.len = (uint16_t)n;
+    st->p += n;
+    return 0;
+}
+
+static int scan_number(JsonScan_State_t* st, JsonScan_Token_t* tok)
+{
+    const char* start = st->p;
+
+    while (st->p < st->end)
+    {
+        char c = *st->p;
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+        {
+            st->p++;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (st->p == start)
+    {
+        return -1;
+    }
+    tok->type = JSON_SCAN_NUMBER;
+    tok->value.ptr = start;
+    tok->value.len = (uint16_t)(st->p - start);
+    return 0;
+}
+
+/**
+ * @brief  扫描整段 JSON，对每个标量值调用 handler
+ * @note   容器用深度计数和每层一个键名槽跟踪，不做递归，栈占用固定
+ */
+int JsonScan_Parse(const char* json, uint16_t len, JsonScan_Handler_t handler, void* ctx)
+{
+    JsonScan_State_t st;
+
+    memset(&st, 0, sizeof(st));
+    st.p = json;
+    st.end = json + len;
+
+    for (;;)
+    {
+        skip_ws(&st);
+        if (st.p >= st.end)
+        {
+            return (st.depth == 0) ? 0 : -1;
+        }
+
+        char c = *st.p;
+
+        // 1. 对象内：先读键名
+        if (st.depth > 0 && st.expect_key[st.depth])
+        {
+            if (c == '}')
+            {
+                st.p++;
+                st.depth--;
+                continue;
+            }
+            if (c != '"' || scan_string(&st, &st.key[st.depth]) != 0)
+            {
+                return -1;
+            }
+            skip_ws(&st);
+            if (st.p >= st.end || *st.p != ':')
+            {
+                return -1;
+            }
+            st.p++;
+            st.expect_key[st.depth] = 0;
+            continue;
+        }
+
+        // 2. 分隔符与容器结束
+        if (c == ',')
+        {
+            st.p++;
+            if (st.depth > 0 && st.closer[st.depth] == '}')
+            {
+                st.expect_key[st.depth] = 1;
+            }
+            continue;
+        }
+        if (c == '}' || c == ']')
+        {
+            if (st.depth == 0 || st.closer[st.depth] != c)
+            {
+                return -1;
+            }
+            st.p++;
+            st.depth--;
+            continue;
+        }
+
+        // 3. 容器开始：数组沿用外层键名，便于识别 "params":["a","b"] 中的元素
+        if (c == '{' || c == '[')
+        {
+            if (st.depth >= JSON_SCAN_MAX_DEPTH)
+            {
+                return -1;
+            }
+            JsonScan_Slice_t outer = st.key[st.depth];
+            st.p++;
+            st.depth++;
+            st.closer[st.depth] = (c == '{') ? '}' : ']';
+            st.expect_key[st.depth] = (c == '{');
+            st.key[st.depth].ptr = (c == '[') ? outer.ptr : NULL;
+            st.key[st.depth].len = (c == '[') ? outer.len : 0;
+            continue;
+        }
+
+        // 4. 标量值
+        JsonScan_Token_t tok;
+        int rc;
+        if (c == '"')
+        {
+            tok.type = JSON_SCAN_STRING;
+            rc = scan_string(&st, &tok.value);
+        }
+        else if (c == 't') rc = scan_literal(&st, "true", JSON_SCAN_TRUE, &tok);
+        else if (c == 'f') rc = scan_literal(&st, "false", JSON_SCAN_FALSE, &tok);
+        else if (c == 'n') rc = scan_literal(&st, "null", JSON_SCAN_NULL, &tok);
+        else               rc = scan_number(&st, &tok);
+        if (rc != 0)
+        {
+            return -1;
+        }
+
+        tok.depth = st.depth;
+        tok.key = st.key[st.depth];
+        tok.parent.ptr = NULL;
+        tok.parent.len = 0;
+        if (st.depth >= 1)
+        {
+            // 数组元素的"上一层"是数组外的对象
+            uint8_t up = st.depth - 1;
+            if (st.closer[st.depth] == ']' && up > 0)
+            {
+                up--;
+            }
+            tok.parent = st.key[up];
+        }
+        if (handler != NULL)
+        {
+            handler(&tok, ctx);
+        }
+    }
+}
+
+/**
+ * @brief  把数字值转换为整数 (小数部分截断)
+ */
+int JsonScan_To_Int(const JsonScan_Token_t* tok, int32_t* out)
+{
+    const char* p = tok->value.ptr;
+    const char* end = p + tok->value.len;
+    int32_t v = 0;
+    int neg = 0;
+
+    if (tok->type != JSON_SCAN_NUMBER || p == end)
+    {
+        return 0;
+    }
+    if (*p == '-' || *p == '+')
+    {
+        neg = (*p == '-');
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9')
+    {
+        return 0;
+    }
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        if (v > 214748363)
+        {
+            return 0;   // 超出 int32 范围
+        }
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+    *out = neg ? -v : v;
+    return 1;
+}
+
+int JsonScan_Slice_Equals(const JsonScan_Slice_t* s, const char* str)
+{
+    size_t n = strlen(str);
+    return s->ptr != NULL && s->len == n && memcmp(s->ptr, str, n) == 0;
+}
@@ -0,0 +1,47 @@
+/**
+ ******************************************************************************
+ * @ 名称  单遍 JSON 扫描器
+ * @ 描述  对输入只扫描一遍、不分配内存、不修改输入：每遇到一个标量值(字符串/数字/true/false/null)
+ *         就回调一次，并给出它的键名和上一层对象的键名。字符串值以指向输入的切片返回(未反转义)。
+ *         下行命令解析用它把每个键交给查表得到的类型化处理函数，耗时只与报文长度成正比。
+ ******************************************************************************
+ */
+#ifndef __JSON_SCAN_H
+#define __JSON_SCAN_H
+
+#include <stdint.h>
+
+#define JSON_SCAN_MAX_DEPTH   8         // 对象/数组的最大嵌套深度，超出按语法错误处理
+
+typedef enum {
+    JSON_SCAN_STRING,
+    JSON_SCAN_NUMBER,
+    JSON_SCAN_TRUE,
+    JSON_SCAN_FALSE,
+    JSON_SCAN_NULL
+} JsonScan_Type_t;
+
+// 字符串切片 (不以 '\0' 结尾)
+typedef struct {
+    const char* ptr;
+    uint16_t    len;
+} JsonScan_Slice_t;
+
+typedef struct {
+    JsonScan_Type_t  type;
+    JsonScan_Slice_t value;     // 字符串不含两侧引号
+    JsonScan_Slice_t key;       // 所属成员的键名；数组元素为数组本身的键名；顶层值为空
+    JsonScan_Slice_t parent;    // 上一层对象成员的键名，如 {"crop_stage":{"value":2}} 中 value 的 parent 为 crop_stage
+    uint8_t          depth;     // 所在容器的嵌套深度，顶层对象的成员为 1
+} JsonScan_Token_t;
+
+typedef void (*JsonScan_Handler_t)(const JsonScan_Token_t* tok, void* ctx);
+
+// 返回 0 表示扫描完成，-1 表示语法错误或嵌套过深 (出错前的值已经回调)
+int JsonScan_Parse(const char* json, uint16_t len, JsonScan_Handler_t handler, void* ctx);
+
+// 取值辅助函数：成功返回 1
+int JsonScan_To_Int(const JsonScan_Token_t* tok, int32_t* out);
+int JsonScan_Slice_Equals(const JsonScan_Slice_t* s, const char* str);
+
+#endif
@@ -0,0 +1,242 @@
+#include "json_stream.h"
+#include <stdio.h>
+
+static void put_char(JsonStream_t* w, char c)
+{
+    if (w->used == JSON_STREAM_CHUNK_SIZE)
+    {
+        JsonStream_Flush(w);
+    }
+    w->chunk[w->used++] = (uint8_t)c;
+}
+
+// 无符号整数转十进制
+static void put_u64(JsonStream_t* w, uint64_t v)
+{
+    char digits[20];
+    int n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+
+    while (n > 0)
+    {
+        put_char(w, digits[--n]);
+    }
+}
+
+// 带转义的字符串内容（不含两侧引号）
+static void put_escaped(JsonStream_t* w, const char* s)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    for (; *s; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        switch (c)
+        {
+            case '"':  put_char(w, '\\'); put_char(w, '"');  break;
+            case '\\': put_char(w, '\\'); put_char(w, '\\'); break;
+            case '\n': put_char(w, '\\'); put_char(w, 'n');  break;
+            case '\r': put_char(w, '\\'); put_char(w, 'r');  break;
+            case '\t': put_char(w, '\\'); put_char(w, 't');  break;
+            default:
+                if (c < 0x20)
+                {
+                    JsonStream_Raw(w, "\\u00");
+                    put_char(w, hex[c >> 4]);
+                    put_char(w, hex[c & 0x0F]);
+                }
+                else
+                {
+                    put_char(w, (char)c);
+                }
+                break;
+        }
+    }
+}
+
+// 成员前缀：必要时补逗号，再写键名
+static void begin_value(JsonStream_t* w, const char* key)
+{
+    uint32_t bit = 1UL << (w->depth & (JSON_STREAM_MAX_DEPTH - 1));
+
+    if (w->member_bits & bit)
+    {
+        put_char(w, ',');
+    }
+    w->member_bits |= bit;
+
+    if (key != NULL)
+    {
+        put_char(w, '"');
+        put_escaped(w, key);
+        put_char(w, '"');
+        put_char(w, ':');
+    }
+}
+
+static void open_scope(JsonStream_t* w, const char* key, char bracket)
+{
+    begin_value(w, key);
+    put_char(w, bracket);
+    if (w->depth < JSON_STREAM_MAX_DEPTH - 1)
+    {
+        w->depth++;
+    }
+    w->member_bits &= ~(1UL << w->depth);
+}
+
+static void close_scope(JsonStream_t* w, char bracket)
+{
+    if (w->depth > 0)
+    {
+        w->depth--;
+    }
+    put_char(w, bracket);
+}
+
+void JsonStream_Init(JsonStream_t* w, JsonStream_Sink_t sink)
+{
+    w->sink = sink;
+    w->used = 0;
+    w->depth = 0;
+    w->echo = 0;
+    w->member_bits = 0;
+    w->total = 0;
+}
+
+/**
+ * @brief  把分块缓冲区中的数据交给输出函数
+ */
+void JsonStream_Flush(JsonStream_t* w)
+{
+    if (w->used == 0)
+    {
+        return;
+    }
+    if (w->echo)
+    {
+        printf("%.*s", (int)w->used, (const char*)w->chunk);
+    }
+    if (w->sink != NULL)
+    {
+        w->sink(w->chunk, w->used);
+    }
+    w->total += w->used;
+    w->used = 0;
+}
+
+void JsonStream_Raw(JsonStream_t* w, const char* str)
+{
+    while (*str)
+    {
+        put_char(w, *str++);
+    }
+}
+
+void JsonStream_RawN(JsonStream_t* w, const char* data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        put_char(w, data[i]);
+    }
+}
+
+void JsonStream_Object_Begin(JsonStream_t* w, const char* key)
+{
+    open_scope(w, key, '{');
+}
+
+void JsonStream_Object_End(JsonStream_t* w)
+{
+    close_scope(w, '}');
+}
+
+void JsonStream_Array_Begin(JsonStream_t* w, const char* key)
+{
+    open_scope(w, key, '[');
+}
+
+void JsonStream_Array_End(JsonStream_t* w)
+{
+    close_scope(w, ']');
+}
+
+void JsonStream_Int(JsonStream_t* w, const char* key, int32_t value)
+{
+    begin_value(w, key);
+    if (value < 0)
+    {
+        put_char(w, '-');
+        put_u64(w, (uint64_t)(-(int64_t)value));
+    }
+    else
+    {
+        put_u64(w, (uint64_t)value);
+    }
+}
+
+void JsonStream_Uint(JsonStream_t* w, const char* key, uint32_t value)
+{
+    begin_value(w, key);
+    put_u64(w, value);
+}
+
+/**
+ * @brief  定点输出浮点数，四舍五入到 decimals 位小数 (最多 6 位)
+ * @note   先放大为整数再逐位输出，避免在目标板上链接浮点版 printf
+ */
+void JsonStream_Fixed(JsonStream_t* w, const char* key, float value, uint8_t decimals)
+{
+    uint32_t scale = 1;
+    uint8_t  d;
+
+    begin_value(w, key);
+
+    // 非有限值或超出定点范围时，JSON 中没有合法的数字表示
+    if (!(value > -2.0e9f && value < 2.0e9f))
+    {
+        JsonStream_Raw(w, "null");
+        return;
+    }
+
+    if (decimals > 6)
+    {
+        decimals = 6;
+    }
+    for (d = 0; d < decimals; d++)
+    {
+        scale *= 10;
+    }
+
+    double scaled = (double)value * scale;
+    uint8_t negative = scaled < 0;
+    uint64_t units = (uint64_t)((negative ? -scaled : scaled) + 0.5);
+
+    if (negative && units != 0)
+    {
+        put_char(w, '-');
+    }
+    put_u64(w, units / scale);
+    if (decimals > 0)
+    {
+        uint32_t frac = (uint32_t)(units % scale);
+        put_char(w, '.');
+        for (uint32_t div = scale / 10; div > 0; div /= 10)
+        {
+            put_char(w, (char)('0' + (frac / div) % 10));
+        }
+    }
+}
+
+void JsonStream_String(JsonStream_t* w, const char* key, const char* value)
+{
+    begin_value(w, key);
+    put_char(w, '"');
+    put_escaped(w, value != NULL ? value : "");
+    put_char(w, '"');
+}
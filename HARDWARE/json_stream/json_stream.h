@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ * @ 名称  流式 JSON 写入器
+ * @ 描述  边序列化边输出：AT 指令头、JSON 正文和指令尾依次写入一个很小的分块缓冲区，
+ *         满一块即交给输出函数(通常是 USART1 发送环形缓冲区)，不再需要整条报文大小的暂存区。
+ *         浮点数按定点格式输出，字符串按 JSON 规则转义。
+ ******************************************************************************
+ */
+#ifndef __JSON_STREAM_H
+#define __JSON_STREAM_H
+
+#include <stdint.h>
+
+#define JSON_STREAM_CHUNK_SIZE   64     // 分块缓冲区大小，决定每次调用输出函数的最大字节数
+#define JSON_STREAM_MAX_DEPTH    32     // 对象/数组的最大嵌套深度
+
+// 输出函数：把一块数据交给发送通道
+typedef void (*JsonStream_Sink_t)(const uint8_t* data, uint16_t len);
+
+typedef struct {
+    JsonStream_Sink_t sink;
+    uint8_t  chunk[JSON_STREAM_CHUNK_SIZE];
+    uint16_t used;                  // 分块缓冲区中待输出的字节数
+    uint8_t  depth;                 // 当前嵌套深度
+    uint8_t  echo;                  // 1: 输出的同时经 printf 打印到调试串口
+    uint32_t member_bits;           // 第 n 位表示第 n 层已有成员，下一个成员前需要逗号
+    uint32_t total;                 // 累计输出的字节数
+} JsonStream_t;
+
+void JsonStream_Init(JsonStream_t* w, JsonStream_Sink_t sink);
+void JsonStream_Flush(JsonStream_t* w);
+
+// 原样输出，用于 AT 指令头尾和主题，不做转义也不插入逗号
+void JsonStream_Raw(JsonStream_t* w, const char* str);
+void JsonStream_RawN(JsonStream_t* w, const char* data, uint16_t len);
+
+// key 为 NULL 时输出不带键名的值(数组元素或顶层值)
+void JsonStream_Object_Begin(JsonStream_t* w, const char* key);
+void JsonStream_Object_End(JsonStream_t* w);
+void JsonStream_Array_Begin(JsonStream_t* w, const char* key);
+void JsonStream_Array_End(JsonStream_t* w);
+
+void JsonStream_Int(JsonStream_t* w, const char* key, int32_t value);
+void JsonStream_Uint(JsonStream_t* w, const char* key, uint32_t value);
+void JsonStream_Fixed(JsonStream_t* w, const char* key, float value, uint8_t decimals);   // 同 printf("%.*f")，非有限值输出 null
+void JsonStream_String(JsonStream_t* w, const char* key, const char* value);
+
+#endif
@@ -0,0 +1,70 @@
+#include "pwm_ramp.h"
+
+static uint16_t s_rate[HAL_PWM_COUNT] = {
+    PWM_RAMP_RATE_HEATER,
+    PWM_RAMP_RATE_SPRINKLER,
+    PWM_RAMP_RATE_FAN,
+    PWM_RAMP_RATE_SERVO,
+};
+static uint16_t s_target[HAL_PWM_COUNT];
+static uint8_t  s_has_target;           // bit ch：s_target[ch] 有效
+
+void PwmRamp_Set_Rate(HAL_Pwm_t ch, uint16_t counts_per_s)
+{
+    s_rate[ch] = counts_per_s;
+}
+
+/**
+ * @brief  生成从当前比较值到 target 的等差序列并交给 DMA 播放
+ * @note   序列从正在播放的中间值开始，斜坡途中改目标不会跳变
+ */
+void PwmRamp_To(HAL_Pwm_t ch, uint16_t target)
+{
+    uint16_t table[HAL_PWM_STREAM_MAX];
+    uint16_t from;
+    uint32_t delta, per_step, steps;
+
+    if ((s_has_target & (1 << ch)) && s_target[ch] == target)
+    {
+        return;
+    }
+    s_target[ch] = target;
+    s_has_target |= 1 << ch;
+
+    from = HAL_PWM_GetCompare(ch);
+    delta = (target > from) ? (uint32_t)(target - from) : (uint32_t)(from - target);
+    if (s_rate[ch] == 0 || delta == 0)
+    {
+        HAL_PWM_SetCompare(ch, target);
+        return;
+    }
+
+    per_step = (uint32_t)s_rate[ch] * HAL_PWM_StreamStepMs(ch) / 1000;
+    if (per_step == 0)
+    {
+        per_step = 1;
+    }
+    steps = (delta + per_step - 1) / per_step;
+    if (steps > HAL_PWM_STREAM_MAX)
+    {
+        steps = HAL_PWM_STREAM_MAX;
+    }
+
+    // 最后一步正好落在 target
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        int32_t v = from + ((int32_t)target - from) * (int32_t)(i + 1) / (int32_t)steps;
+        table[i] = (uint16_t)v;
+    }
+    HAL_PWM_Stream(ch, table, (uint16_t)steps);
+}
+
+uint8_t PwmRamp_Busy(HAL_Pwm_t ch)
+{
+    return HAL_PWM_StreamRemaining(ch) > 0;
+}
+
+void PwmRamp_Release(HAL_Pwm_t ch)
+{
+    s_has_target &= ~(1 << ch);
+}
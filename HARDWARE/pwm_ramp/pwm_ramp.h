@@ -0,0 +1,33 @@
+/**
+ ******************************************************************************
+ * @ 名称  PWM 斜坡输出
+ * @ 描述  加热器、洒水器、风机与舵机的比较值不再一步写到位，而是按每通道的变化速率
+ *         生成一张中间值表，交给 HAL_PWM_Stream() 由定时器更新事件触发 DMA 逐步写入：
+ *         继电器与水泵不再承受阶跃冲击，舵机不再猛转。斜坡播放期间不占用 CPU，
+ *         主循环阻塞 (AT 等待、传感器时序) 也不影响平滑度。
+ * @ 注意  表长上限 HAL_PWM_STREAM_MAX 步；变化量按设定速率超出表长时自动提高速率，
+ *         保证斜坡在 表长 x 步进周期 内走完 (功率通道 1s，舵机 2s)。
+ ******************************************************************************
+ */
+#ifndef __PWM_RAMP_H
+#define __PWM_RAMP_H
+
+#include "hal.h"
+#include <stdint.h>
+
+// 默认变化速率 (比较值计数/秒)：功率通道 ARR=999，1000/s 约 1s 从 0 到满；舵机 1us/计数，1000/s 即 90°/s
+#define PWM_RAMP_RATE_HEATER        1000
+#define PWM_RAMP_RATE_SPRINKLER     1000
+#define PWM_RAMP_RATE_FAN           1000
+#define PWM_RAMP_RATE_SERVO         1000
+
+// 设置通道的变化速率，0 表示不做斜坡、直接写入
+void    PwmRamp_Set_Rate(HAL_Pwm_t ch, uint16_t counts_per_s);
+// 从当前比较值按速率变化到 target；目标与上次相同时不做任何事，可以每轮调用
+void    PwmRamp_To(HAL_Pwm_t ch, uint16_t target);
+// 斜坡是否仍在进行
+uint8_t PwmRamp_Busy(HAL_Pwm_t ch);
+// 通道交给其他播放方式 (如循环扫描) 后调用：忘记记录的目标，下一次 PwmRamp_To() 一定重新生成斜坡
+void    PwmRamp_Release(HAL_Pwm_t ch);
+
+#endif
@@ -0,0 +1,142 @@
+#include "telemetry_bin.h"
+#include <math.h>
+
+static void put_u16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+// 按比例量化为 int16，饱和到 ±32767，NaN 记为无效值
+static int16_t quantize_i16(float v, float scale)
+{
+    if (isnan(v))
+    {
+        return TELEMETRY_BIN_INVALID;
+    }
+    float x = roundf(v * scale);
+    if (x > 32767.0f)  return 32767;
+    if (x < -32767.0f) return -32767;
+    return (int16_t)x;
+}
+
+static uint16_t quantize_u16(float v, float scale)
+{
+    if (isnan(v) || v <= 0.0f)
+    {
+        return 0;
+    }
+    float x = roundf(v * scale);
+    return (x > 65535.0f) ? 65535 : (uint16_t)x;
+}
+
+static float dequantize_i16(uint16_t raw, float scale)
+{
+    int16_t v = (int16_t)raw;
+    return (v == TELEMETRY_BIN_INVALID) ? NAN : v / scale;
+}
+
+uint16_t TelemetryBin_Crc16(const uint8_t* data, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t TelemetryBin_Encode(const TelemetryBin_Record_t* r, uint8_t* out)
+{
+    out[0] = TELEMETRY_BIN_VERSION;
+    out[1] = r->available;
+    put_u16(&out[2], r->seq);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        put_u16(&out[4 + 2 * i], (uint16_t)quantize_i16(r->temps[i], 100.0f));
+    }
+    put_u16(&out[12], (uint16_t)quantize_i16(r->ambient_temp, 100.0f));
+    put_u16(&out[14], quantize_u16(r->humidity, 10.0f));
+    put_u16(&out[16], (r->pressure < 0) ? 0 : (r->pressure > 65535) ? 65535 : (uint16_t)r->pressure);
+    put_u16(&out[18], quantize_u16(r->wind_speed, 100.0f));
+    out[20] = r->intervention_status;
+    out[21] = r->crop_stage;
+    out[22] = r->fan_power;
+    out[23] = r->heater_power;
+    out[24] = r->sprinkler_power;
+    out[25] = 0;
+    put_u32(&out[26], r->actuator_switches);
+    put_u16(&out[30], TelemetryBin_Crc16(out, 30));
+    return TELEMETRY_BIN_SIZE;
+}
+
+int TelemetryBin_Decode(const uint8_t* in, uint16_t len, TelemetryBin_Record_t* r)
+{
+    if (len != TELEMETRY_BIN_SIZE || in[0] != TELEMETRY_BIN_VERSION)
+    {
+        return -1;
+    }
+    if (get_u16(&in[30]) != TelemetryBin_Crc16(in, 30))
+    {
+        return -2;
+    }
+
+    r->available = in[1];
+    r->seq = get_u16(&in[2]);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        r->temps[i] = dequantize_i16(get_u16(&in[4 + 2 * i]), 100.0f);
+    }
+    r->ambient_temp = dequantize_i16(get_u16(&in[12]), 100.0f);
+    r->humidity = get_u16(&in[14]) / 10.0f;
+    r->pressure = get_u16(&in[16]);
+    r->wind_speed = get_u16(&in[18]) / 100.0f;
+    r->intervention_status = in[20];
+    r->crop_stage = in[21];
+    r->fan_power = in[22];
+    r->heater_power = in[23];
+    r->sprinkler_power = in[24];
+    r->actuator_switches = get_u32(&in[26]);
+    return 0;
+}
+
+uint16_t TelemetryBin_Base64(const uint8_t* in, uint16_t len, char* out)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    uint16_t n = 0;
+
+    for (uint16_t i = 0; i < len; i += 3)
+    {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+        if (i + 2 < len) v |= in[i + 2];
+
+        out[n++] = alphabet[(v >> 18) & 0x3F];
+        out[n++] = alphabet[(v >> 12) & 0x3F];
+        out[n++] = (i + 1 < len) ? alphabet[(v >> 6) & 0x3F] : '=';
+        out[n++] = (i + 2 < len) ? alphabet[v & 0x3F] : '=';
+    }
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ * @ 名称  紧凑二进制遥测记录
+ * @ 描述  把一次上报的全部属性编码为 32 字节定长记录 (小端)，代替五条文本 JSON 属性上报。
+ *         温度以 0.01°C 为单位存为 int16，无效值 (NaN) 存为 0x8000。
+ *         文本模式的 AT+QMTPUB 不能携带任意字节，记录经 Base64 编码后发布，线上 44 字节。
+ *         云端解码见 TOOLS/telemetry/decode_telemetry.py，两端格式以本文件为准。
+ *
+ *  偏移  类型      字段
+ *   0    u8        版本 (TELEMETRY_BIN_VERSION)
+ *   1    u8        设备可用性: bit0 喷淋, bit1 风机, bit2 加热
+ *   2    u16       序号
+ *   4    i16 x4    temp1..temp4        (0.01°C)
+ *  12    i16       ambient_temp        (0.01°C)
+ *  14    u16       humidity            (0.1%)
+ *  16    u16       pressure            (hPa)
+ *  18    u16       wind_speed          (0.01 m/s)
+ *  20    u8        intervention_status
+ *  21    u8        crop_stage
+ *  22    u8 x3     fan/heater/sprinkler_power (%)
+ *  25    u8        保留
+ *  26    u32       actuator_switches
+ *  30    u16       CRC-16/CCITT-FALSE (字节 0..29)
+ ******************************************************************************
+ */
+#ifndef __TELEMETRY_BIN_H
+#define __TELEMETRY_BIN_H
+
+#include <stdint.h>
+
+#define TELEMETRY_BIN_VERSION       1
+#define TELEMETRY_BIN_SIZE          32
+#define TELEMETRY_BIN_BASE64_SIZE   (((TELEMETRY_BIN_SIZE + 2) / 3) * 4)
+#define TELEMETRY_BIN_INVALID       ((int16_t)-32768)
+
+#define TELEMETRY_AVAIL_SPRINKLERS  0x01
+#define TELEMETRY_AVAIL_FANS        0x02
+#define TELEMETRY_AVAIL_HEATERS     0x04
+
+typedef struct {
+    uint16_t seq;
+    float    temps[4];
+    float    ambient_temp;
+    float    humidity;
+    int32_t  pressure;
+    float    wind_speed;
+    uint8_t  intervention_status;
+    uint8_t  crop_stage;
+    uint8_t  fan_power;
+    uint8_t  heater_power;
+    uint8_t  sprinkler_power;
+    uint8_t  available;         // TELEMETRY_AVAIL_* 的组合
+    uint32_t actuator_switches;
+} TelemetryBin_Record_t;
+
+// 编码为 TELEMETRY_BIN_SIZE 字节，返回写入的字节数
+uint16_t TelemetryBin_Encode(const TelemetryBin_Record_t* r, uint8_t* out);
+// 解码并校验版本与 CRC：0 成功，-1 长度或版本不符，-2 CRC 错误
+int      TelemetryBin_Decode(const uint8_t* in, uint16_t len, TelemetryBin_Record_t* r);
+// 标准 Base64 (带 '=' 填充)，out 需至少 ((len+2)/3)*4+1 字节，返回字符数
+uint16_t TelemetryBin_Base64(const uint8_t* in, uint16_t len, char* out);
+uint16_t TelemetryBin_Crc16(const uint8_t* data, uint16_t len);
+
+#endif
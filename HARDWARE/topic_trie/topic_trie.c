@@ -0,0 +1,109 @@
+#include "topic_trie.h"
+#include <string.h>
+
+#define TOPIC_TRIE_MAX_WILDCARDS   4    // 一次匹配中最多回溯的 '+' 分支数
+
+void TopicTrie_Init(TopicTrie_t* t)
+{
+    memset(t, 0, sizeof(*t));
+    t->node[0].route = TOPIC_TRIE_NO_ROUTE;
+    t->count = 1;
+}
+
+static uint8_t TopicTrie_Find_Child(const TopicTrie_t* t, uint8_t parent, char c)
+{
+    uint8_t i = t->node[parent].child;
+    while (i != 0 && t->node[i].c != c)
+    {
+        i = t->node[i].sibling;
+    }
+    return i;
+}
+
+int TopicTrie_Insert(TopicTrie_t* t, const char* filter, uint8_t route)
+{
+    uint8_t n = 0;
+
+    for (const char* p = filter; *p != '\0'; p++)
+    {
+        uint8_t next = TopicTrie_Find_Child(t, n, *p);
+        if (next == 0)
+        {
+            if (t->count >= TOPIC_TRIE_MAX_NODES)
+            {
+                return -1;
+            }
+            next = t->count++;
+            t->node[next].c = *p;
+            t->node[next].child = 0;
+            t->node[next].route = TOPIC_TRIE_NO_ROUTE;
+            t->node[next].sibling = t->node[n].child;
+            t->node[n].child = next;
+        }
+        n = next;
+    }
+    t->node[n].route = route;
+    return 0;
+}
+
+/**
+ * @brief  沿主题逐字符下行，字面字符优先；走不通时回到最近的 '+' 分支，让它吞下一整层
+ */
+uint8_t TopicTrie_Match(const TopicTrie_t* t, const char* topic, uint16_t len,
+                        const char** level, uint16_t* level_len)
+{
+    struct { uint8_t node; uint16_t pos; } alt[TOPIC_TRIE_MAX_WILDCARDS];
+    uint8_t  sp = 0;
+    uint8_t  n = 0;
+    uint16_t pos = 0;
+    uint16_t cap_pos = 0;
+    uint16_t cap_len = 0;
+
+    for (;;)
+    {
+        uint8_t next = 0;
+
+        if (pos == len)
+        {
+            if (t->node[n].route != TOPIC_TRIE_NO_ROUTE)
+            {
+                if (level != NULL)     *level = topic + cap_pos;
+                if (level_len != NULL) *level_len = cap_len;
+                return t->node[n].route;
+            }
+        }
+        else
+        {
+            uint8_t plus = TopicTrie_Find_Child(t, n, '+');
+            if (plus != 0 && sp < TOPIC_TRIE_MAX_WILDCARDS)
+            {
+                alt[sp].node = plus;
+                alt[sp].pos = pos;
+                sp++;
+            }
+            next = TopicTrie_Find_Child(t, n, topic[pos]);
+        }
+
+        if (next != 0)
+        {
+            n = next;
+            pos++;
+            continue;
+        }
+
+        // 回溯到最近的 '+' 分支
+        if (sp == 0)
+        {
+            return TOPIC_TRIE_NO_ROUTE;
+        }
+        sp--;
+        n = alt[sp].node;
+        pos = alt[sp].pos;
+        cap_pos = pos;
+        while (pos < len && topic[pos] != '/')
+        {
+            pos++;
+        }
+        cap_len = pos - cap_pos;
+    }
+}
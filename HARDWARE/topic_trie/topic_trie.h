@@ -0,0 +1,36 @@
+/**
+ ******************************************************************************
+ * @ 名称  主题前缀树
+ * @ 描述  把订阅时使用的主题过滤器逐字符插入一棵前缀树，收到消息时沿主题走一遍即可
+ *         得到路由号，耗时只与主题长度有关。公共前缀 ($sys/{pid}/{dev}/thing/...) 只比较一次。
+ *         支持 MQTT 单层通配符 '+'，并返回 '+' 匹配到的那一层 (如服务标识符)。
+ ******************************************************************************
+ */
+#ifndef __TOPIC_TRIE_H
+#define __TOPIC_TRIE_H
+
+#include <stdint.h>
+
+#define TOPIC_TRIE_MAX_NODES    200     // 节点总数上限，按全部过滤器的字符数估算
+#define TOPIC_TRIE_NO_ROUTE     0xFF
+
+typedef struct {
+    char    c;
+    uint8_t child;              // 第一个子节点，0 表示无 (根节点不会成为子节点)
+    uint8_t sibling;            // 下一个兄弟节点，0 表示无
+    uint8_t route;              // 过滤器在此结束时的路由号
+} TopicTrie_Node_t;
+
+typedef struct {
+    TopicTrie_Node_t node[TOPIC_TRIE_MAX_NODES];
+    uint8_t          count;
+} TopicTrie_t;
+
+void    TopicTrie_Init(TopicTrie_t* t);
+// 返回 0 表示成功，-1 表示节点用尽
+int     TopicTrie_Insert(TopicTrie_t* t, const char* filter, uint8_t route);
+// 返回路由号，未匹配返回 TOPIC_TRIE_NO_ROUTE；level/level_len 可为 NULL
+uint8_t TopicTrie_Match(const TopicTrie_t* t, const char* topic, uint16_t len,
+                        const char** level, uint16_t* level_len);
+
+#endif
@@ -8,40 +8,69 @@
  ******************************************************************************
  */
 #include "delay.h"
+#include <stddef.h>
 #include <stdint.h>
 
-uint64_t sysTickCnt = 0;                   
+volatile uint64_t sysTickCnt = 0;                   
 
-// 使用 SysTick 实现延时，比较准确
+static Delay_IdleHook_t s_idle_hook = NULL;
+static uint8_t s_idle_running = 0;
+
+// SysTick 作为全局 1ms 时基常驻运行，延时函数只读取它，不再重新配置
+// (旧实现每次延时都会改写 SysTick 并关闭其中断，导致 System_GetTimeMs() 永远不走)
+static void delay_ensure_timebase(void)
+{
+    if ((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0)
+    {
+        System_SysTickInit();
+    }
+}
+
+// 轮询 SysTick->VAL 实现微秒延时，不影响 1ms 时基中断
 void delay_us(uint32_t nus)
 {
-    // 设置 SysTick 的计数周期
-    SysTick_Config(SystemCoreClock/1000000); // 每周期 1us
-    // 关闭 SysTick 的中断，不可省略
-    SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
-    // 开始计数
-    for(uint32_t i=0; i<nus; i++)
-    {   // 循环一次就是 1us
-        while( !((SysTick->CTRL)&(1<<16)) );
+    delay_ensure_timebase();
+
+    uint32_t ticks  = nus * (SystemCoreClock / 1000000);   // 需要等待的 HCLK 周期数
+    uint32_t reload = SysTick->LOAD + 1;
+    uint32_t told   = SysTick->VAL;
+    uint32_t tcnt   = 0;
+
+    while (tcnt < ticks)
+    {
+        uint32_t tnow = SysTick->VAL;
+        if (tnow != told)
+        {
+            // SysTick 为递减计数器，跨越重装载时需要补上一个周期
+            tcnt += (tnow < told) ? (told - tnow) : (reload - tnow + told);
+            told = tnow;
+        }
     }
-    // 关闭 SysTick 定时器
-    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
 }
 
-// 使用 SysTick 实现延时，比较准确
+// 基于 1ms 时基的毫秒延时；等待期间每过 1ms 调用一次空闲钩子 (钩子内的 delay_ms 不再嵌套调用)
 void delay_ms(uint32_t nms)
 {
-    // 设置 SysTick 的计数周期
-    SysTick_Config(SystemCoreClock/1000); // 每周期 1ms
-    // 关闭 SysTick 的中断，不可省略
-    SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
-    // 开始计数
-    for(uint32_t i=0; i<nms; i++)
-    {   // 循环一次就是 1ms
-        while( !((SysTick->CTRL)&(1<<16)) );
+    delay_ensure_timebase();
+
+    uint64_t start = System_GetTimeMs();
+    uint64_t last = start;
+    uint64_t now;
+    while ((now = System_GetTimeMs()) - start < nms)
+    {
+        if (now != last && s_idle_hook != NULL && !s_idle_running)
+        {
+            last = now;
+            s_idle_running = 1;
+            s_idle_hook();
+            s_idle_running = 0;
+        }
     }
-    // 关闭 SysTick 定时器
-    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+}
+
+void delay_set_idle_hook(Delay_IdleHook_t hook)
+{
+    s_idle_hook = hook;
 }
 
 
@@ -87,7 +116,14 @@ void SysTick_Handler(void)
 
 uint64_t System_GetTimeMs(void)
 {    
-    return sysTickCnt  ;
+    // 64 位计数在 Cortex-M3 上不是原子读，读到中断改写的中间态时重读一次
+    uint64_t t1, t2;
+    do
+    {
+        t1 = sysTickCnt;
+        t2 = sysTickCnt;
+    } while (t1 != t2);
+    return t1;
 }
 
 // 使用死循环实现延时
@@ -16,9 +16,13 @@
 
 
 
+// delay_ms() 等待期间每过 1ms 调用一次的空闲钩子 (主循环上下文，不可再调用 delay_ms)
+typedef void (*Delay_IdleHook_t)(void);
+
 void delay(uint32_t nus);
 void delay_ms(uint32_t nms);
 void delay_us(uint32_t nus);
+void delay_set_idle_hook(Delay_IdleHook_t hook);
 
 void System_SysTickInit(void);
 uint64_t System_GetTimeMs(void);
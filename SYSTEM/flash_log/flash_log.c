@@ -0,0 +1,336 @@
+#include "flash_log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define FLASH_LOG_PAGE_END  (FLASH_LOG_HEADER_SIZE + FLASH_LOG_RECORDS_PER_PAGE * FLASH_LOG_RECORD_SIZE)
+
+static struct {
+    uint8_t  active;            // 当前写入页
+    uint32_t page_seq;          // 当前写入页的页序号
+    uint16_t write_off;         // 当前页内下一条记录的偏移
+    uint8_t  boot;              // 本次上电的启动序号
+    uint8_t  buffered;
+    bool     erase_ahead;       // 写指针后一页还未预擦除
+    uint8_t  buf[FLASH_LOG_BUFFER_RECORDS][FLASH_LOG_RECORD_SIZE];
+    uint32_t appended;          // 本次上电追加的记录数
+} s_log;
+
+static uint32_t FlashLog_Page_Addr(uint8_t page)
+{
+    return FLASH_LOG_BASE + (uint32_t)page * FLASH_LOG_PAGE_SIZE;
+}
+
+static uint16_t FlashLog_Crc16(uint16_t crc, const uint8_t* data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void put_u16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static bool FlashLog_Read_Header(uint8_t page, uint32_t* seq)
+{
+    uint8_t h[FLASH_LOG_HEADER_SIZE];
+
+    HAL_Flash_Read(FlashLog_Page_Addr(page), h, sizeof(h));
+    if (get_u32(&h[0]) != FLASH_LOG_MAGIC || get_u16(&h[8]) != FLASH_LOG_RECORD_SIZE ||
+        get_u16(&h[14]) != FlashLog_Crc16(0xFFFF, h, 14))
+    {
+        return false;
+    }
+    *seq = get_u32(&h[4]);
+    return true;
+}
+
+static bool FlashLog_Is_Blank(const uint8_t* data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        if (data[i] != 0xFF)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 整页不是擦除状态 (旧数据或掉电留下的半页) 时擦除
+static void FlashLog_Prepare_Page(uint8_t page)
+{
+    uint8_t chunk[64];
+    uint32_t addr = FlashLog_Page_Addr(page);
+
+    for (uint16_t off = 0; off < FLASH_LOG_PAGE_SIZE; off += sizeof(chunk))
+    {
+        HAL_Flash_Read(addr + off, chunk, sizeof(chunk));
+        if (!FlashLog_Is_Blank(chunk, sizeof(chunk)))
+        {
+            if (HAL_Flash_ErasePage(addr) != 0)
+            {
+                printf("WARN: Flash log page %d erase failed.\r\n", page);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @brief  在 page 开始新的一页，它的下一页留给 FlashLog_Poll() 预擦除
+ * @note   下一页是环中最旧的一页。写指针到达时若仍未擦除，在这里当场擦除
+ */
+static void FlashLog_Open_Page(uint8_t page)
+{
+    uint8_t h[FLASH_LOG_HEADER_SIZE];
+
+    FlashLog_Prepare_Page(page);
+    memset(h, 0xFF, sizeof(h));
+    put_u32(&h[0], FLASH_LOG_MAGIC);
+    put_u32(&h[4], s_log.page_seq + 1);
+    put_u16(&h[8], FLASH_LOG_RECORD_SIZE);
+    put_u16(&h[14], FlashLog_Crc16(0xFFFF, h, 14));
+    if (HAL_Flash_Program(FlashLog_Page_Addr(page), h, sizeof(h)) != 0)
+    {
+        printf("WARN: Flash log page %d header write failed.\r\n", page);
+    }
+
+    s_log.active = page;
+    s_log.page_seq++;
+    s_log.write_off = FLASH_LOG_HEADER_SIZE;
+    s_log.erase_ahead = true;
+}
+
+void FlashLog_Poll(void)
+{
+    if (s_log.erase_ahead)
+    {
+        s_log.erase_ahead = false;
+        FlashLog_Prepare_Page((uint8_t)((s_log.active + 1) % FLASH_LOG_PAGES));
+    }
+}
+
+// 扫描一页的记录：返回第一个空槽位的偏移，有有效记录时给出最后一条的启动序号
+static uint16_t FlashLog_Scan_Page(uint8_t page, int* last_boot)
+{
+    uint8_t rec[FLASH_LOG_RECORD_SIZE];
+    uint32_t addr = FlashLog_Page_Addr(page);
+    uint16_t off;
+
+    for (off = FLASH_LOG_HEADER_SIZE; off < FLASH_LOG_PAGE_END; off += FLASH_LOG_RECORD_SIZE)
+    {
+        HAL_Flash_Read(addr + off, rec, sizeof(rec));
+        if (FlashLog_Is_Blank(rec, sizeof(rec)))
+        {
+            break;
+        }
+        // 掉电写坏的记录占着槽位但不计入，后续记录从下一个槽位继续
+        if (get_u16(&rec[20]) == FlashLog_Crc16(0xFFFF, rec, 20))
+        {
+            *last_boot = rec[3];
+        }
+    }
+    return off;
+}
+
+void FlashLog_Init(void)
+{
+    int newest = -1;
+    int last_boot = -1;
+    int valid = 0;
+
+    memset(&s_log, 0, sizeof(s_log));
+    for (int p = 0; p < FLASH_LOG_PAGES; p++)
+    {
+        uint32_t seq;
+        if (FlashLog_Read_Header((uint8_t)p, &seq))
+        {
+            valid++;
+            if (newest < 0 || seq > s_log.page_seq)
+            {
+                newest = p;
+                s_log.page_seq = seq;
+            }
+        }
+    }
+
+    if (newest < 0)
+    {
+        FlashLog_Open_Page(0);
+        FlashLog_Poll();
+        printf("INFO: Flash log empty, started at page 0.\r\n");
+        return;
+    }
+
+    s_log.active = (uint8_t)newest;
+    s_log.write_off = FlashLog_Scan_Page(s_log.active, &last_boot);
+    if (last_boot < 0)
+    {
+        uint32_t seq;
+        uint8_t prev = (uint8_t)((newest + FLASH_LOG_PAGES - 1) % FLASH_LOG_PAGES);
+        if (FlashLog_Read_Header(prev, &seq))
+        {
+            FlashLog_Scan_Page(prev, &last_boot);
+        }
+    }
+    s_log.boot = (uint8_t)(last_boot + 1);
+    FlashLog_Prepare_Page((uint8_t)((newest + 1) % FLASH_LOG_PAGES));
+
+    printf("INFO: Flash log resumed at page %d offset %u (%d pages, boot %u).\r\n",
+           newest, (unsigned)s_log.write_off, valid, (unsigned)s_log.boot);
+}
+
+static int16_t FlashLog_Quantize_I16(float v, float scale)
+{
+    if (!isfinite(v))
+    {
+        return FLASH_LOG_INVALID;
+    }
+    float x = roundf(v * scale);
+    if (x > 32767.0f)  return 32767;
+    if (x < -32767.0f) return -32767;
+    return (int16_t)x;
+}
+
+static uint16_t FlashLog_Quantize_U16(float v, float scale)
+{
+    if (!isfinite(v))
+    {
+        return 0xFFFF;
+    }
+    float x = roundf(v * scale);
+    if (x < 0.0f)      return 0;
+    if (x > 65534.0f)  return 65534;
+    return (uint16_t)x;
+}
+
+void FlashLog_Flush(void)
+{
+    for (uint8_t i = 0; i < s_log.buffered; i++)
+    {
+        if (s_log.write_off + FLASH_LOG_RECORD_SIZE > FLASH_LOG_PAGE_END)
+        {
+            FlashLog_Open_Page((uint8_t)((s_log.active + 1) % FLASH_LOG_PAGES));
+        }
+        if (HAL_Flash_Program(FlashLog_Page_Addr(s_log.active) + s_log.write_off,
+                              s_log.buf[i], FLASH_LOG_RECORD_SIZE) != 0)
+        {
+            printf("WARN: Flash log write failed at page %d offset %u.\r\n",
+                   s_log.active, (unsigned)s_log.write_off);
+        }
+        s_log.write_off += FLASH_LOG_RECORD_SIZE;
+    }
+    s_log.buffered = 0;
+}
+
+void FlashLog_Append(const FlashLog_Sample_t* s, uint32_t now_ms)
+{
+    uint8_t* rec = s_log.buf[s_log.buffered];
+
+    put_u32(&rec[0], ((uint32_t)s_log.boot << 24) | ((now_ms / 1000) & 0x00FFFFFFu));
+    for (int i = 0; i < 4; i++)
+    {
+        put_u16(&rec[4 + i * 2], (uint16_t)FlashLog_Quantize_I16(s->temps[i], 100.0f));
+    }
+    put_u16(&rec[12], (uint16_t)FlashLog_Quantize_I16(s->ambient_temp, 100.0f));
+    put_u16(&rec[14], FlashLog_Quantize_U16(s->humidity, 10.0f));
+    put_u16(&rec[16], FlashLog_Quantize_U16(s->wind_speed, 100.0f));
+    rec[18] = s->method;
+    rec[19] = s->crop_stage;
+    put_u16(&rec[20], FlashLog_Crc16(0xFFFF, rec, 20));
+
+    s_log.appended++;
+    if (++s_log.buffered >= FLASH_LOG_BUFFER_RECORDS)
+    {
+        FlashLog_Flush();
+    }
+}
+
+/**
+ * @brief  经 USART2 导出全部日志页，从最旧的页到当前页
+ * @note   直接按字节轮询发送，导出期间主循环暂停 (256KB 在 115200 波特率下约 23s)；
+ *         导出前先写入 RAM 中缓存的记录，结束行中的 CRC 覆盖全部原始页字节
+ */
+void FlashLog_Export(void)
+{
+    uint8_t chunk[256];
+    uint16_t crc = 0xFFFF;
+    int pages = 0;
+    uint32_t seq;
+
+    FlashLog_Flush();
+    for (int p = 0; p < FLASH_LOG_PAGES; p++)
+    {
+        if (FlashLog_Read_Header((uint8_t)p, &seq))
+        {
+            pages++;
+        }
+    }
+
+    printf("LOG-EXPORT BEGIN pages=%d page_size=%u record_size=%u\r\n",
+           pages, (unsigned)FLASH_LOG_PAGE_SIZE, (unsigned)FLASH_LOG_RECORD_SIZE);
+    fflush(stdout);
+    // 当前页的下一页开始按环的顺序即为页序号从旧到新
+    for (int i = 1; i <= FLASH_LOG_PAGES; i++)
+    {
+        uint8_t page = (uint8_t)((s_log.active + i) % FLASH_LOG_PAGES);
+        if (!FlashLog_Read_Header(page, &seq))
+        {
+            continue;
+        }
+        for (uint16_t off = 0; off < FLASH_LOG_PAGE_SIZE; off += sizeof(chunk))
+        {
+            HAL_Flash_Read(FlashLog_Page_Addr(page) + off, chunk, sizeof(chunk));
+            crc = FlashLog_Crc16(crc, chunk, sizeof(chunk));
+            fwrite(chunk, 1, sizeof(chunk), stdout);
+        }
+    }
+    fflush(stdout);
+    printf("\r\nLOG-EXPORT END crc=%04X\r\n", crc);
+}
+
+void FlashLog_Print_Info(void)
+{
+    uint32_t seq;
+    int pages = 0;
+
+    for (int p = 0; p < FLASH_LOG_PAGES; p++)
+    {
+        if (FlashLog_Read_Header((uint8_t)p, &seq))
+        {
+            pages++;
+        }
+    }
+    uint32_t stored = (uint32_t)(pages - 1) * FLASH_LOG_RECORDS_PER_PAGE +
+                      (s_log.write_off - FLASH_LOG_HEADER_SIZE) / FLASH_LOG_RECORD_SIZE;
+    printf("INFO: Flash log %d/%d pages, about %lu records stored (%u buffered), page %d seq %lu, boot %u, %lu appended since boot.\r\n",
+           pages, FLASH_LOG_PAGES, (unsigned long)stored, (unsigned)s_log.buffered, s_log.active,
+           (unsigned long)s_log.page_seq, (unsigned)s_log.boot, (unsigned long)s_log.appended);
+}
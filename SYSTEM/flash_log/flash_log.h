@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ * @ 名称  片内 Flash 样本日志
+ * @ 描述  把每个统计窗口的均值写入片内 Flash 末尾 256KB (链接脚本中 FLASH 只分配前 256KB 给程序)，
+ *         按页组成环形日志：每页 16 字节页头 (标志、页序号、CRC) 加 92 条 22 字节记录。
+ *         新记录先缓存在 RAM，攒满 FLASH_LOG_BUFFER_RECORDS 条后一次编程；
+ *         写指针所在页的下一页预先擦除，换页时不必等待擦除，最旧的一页随之被覆盖。
+ *         擦除一页时 CPU 取指停顿 20~40ms (程序与日志在同一存储体)，换页后的预擦除推迟到
+ *         FlashLog_Poll()，由主循环在模组空闲时调用。
+ *         掉电时正在写的页头或记录 CRC 不符，上电扫描时跳过，不影响其余数据。
+ *         FlashLog_Export() 经 USART2 以满波特率导出全部日志页，供季后分析
+ *         (TOOLS/flash_log/decode_flash_log.py 转为 CSV)。
+ *
+ *  页头  偏移  类型      字段
+ *         0    u32       标志 (FLASH_LOG_MAGIC，含格式版本)
+ *         4    u32       页序号，每开一页加一
+ *         8    u16       记录长度 (FLASH_LOG_RECORD_SIZE)
+ *        10    u8 x4     保留 (0xFF)
+ *        14    u16       CRC-16/CCITT-FALSE (字节 0..13)
+ *
+ *  记录  偏移  类型      字段
+ *         0    u32       时间: 高 8 位为启动序号，低 24 位为上电后秒数
+ *         4    i16 x5    temp1..temp4, ambient   (0.01°C，无样本为 0x8000)
+ *        14    u16       humidity                (0.1%，无样本为 0xFFFF)
+ *        16    u16       wind_speed              (0.01 m/s，无样本为 0xFFFF)
+ *        18    u8        干预方式
+ *        19    u8        作物阶段
+ *        20    u16       CRC-16/CCITT-FALSE (字节 0..19)
+ ******************************************************************************
+ */
+#ifndef __FLASH_LOG_H
+#define __FLASH_LOG_H
+
+#include <stdint.h>
+#include "hal.h"
+
+#define FLASH_LOG_BASE              0x08040000u
+#define FLASH_LOG_PAGES             128
+#define FLASH_LOG_PAGE_SIZE         HAL_FLASH_PAGE_SIZE
+#define FLASH_LOG_MAGIC             0x31474C46u     // "FLG1"
+#define FLASH_LOG_HEADER_SIZE       16
+#define FLASH_LOG_RECORD_SIZE       22
+#define FLASH_LOG_RECORDS_PER_PAGE  ((FLASH_LOG_PAGE_SIZE - FLASH_LOG_HEADER_SIZE) / FLASH_LOG_RECORD_SIZE)
+#define FLASH_LOG_INVALID           ((int16_t)-32768)
+
+// RAM 中缓存的记录数，掉电最多丢失这么多条
+#ifndef FLASH_LOG_BUFFER_RECORDS
+#define FLASH_LOG_BUFFER_RECORDS    8
+#endif
+
+typedef struct {
+    float   temps[4];
+    float   ambient_temp;
+    float   humidity;
+    float   wind_speed;
+    uint8_t method;
+    uint8_t crop_stage;
+} FlashLog_Sample_t;
+
+// 扫描日志区，恢复写指针与启动序号，并保证写指针后一页已擦除
+void FlashLog_Init(void);
+// 追加一条记录 (非有限值记为无效)，缓存满时写入 Flash
+void FlashLog_Append(const FlashLog_Sample_t* s, uint32_t now_ms);
+// 执行换页后推迟的预擦除 (CPU 停顿 20~40ms)，只在模组空闲 (没有等待中的 AT 应答) 时调用
+void FlashLog_Poll(void);
+// 把缓存中的记录立即写入 Flash
+void FlashLog_Flush(void);
+// 阻塞导出：文本起始行 + 按页序号从旧到新的原始页 + 含 CRC 的结束行
+void FlashLog_Export(void);
+void FlashLog_Print_Info(void);
+
+#endif
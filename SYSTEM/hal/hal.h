@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ * @ 名称  硬件抽象层
+ * @ 描述  执行器驱动(继电器/风扇/舵机/LED/蜂鸣器)与仿真节拍只通过本接口访问外设，
+ *         目标板实现见 hal_stm32f10x.c，主机(Linux)实现见 host/hal_host.c。
+ *         延时与时基沿用 delay.h，串口沿用 UART_DISPLAY.h，两者在主机端另有实现。
+ *         片内 Flash 的擦写也经本接口，主机端以内存数组模拟并按手册时间推进虚拟时钟。
+ *         PWM 比较值序列由定时器事件触发 DMA 播放，主机端按虚拟时间逐步推进。
+ *         看门狗与备份寄存器同样经本接口，主机端在虚拟时间中检查超时，超时即打印并退出 (模拟复位)。
+ ******************************************************************************
+ */
+#ifndef __HAL_H
+#define __HAL_H
+
+#include <stdint.h>
+
+// 数字输出 (推挽输出引脚)
+typedef enum {
+    HAL_OUT_RELAY_HEATER,   // PB15 加热器继电器 (低电平吸合)
+    HAL_OUT_RELAY_FAN,      // PB14 风扇继电器   (低电平吸合)
+    HAL_OUT_RELAY_PUMP,     // PB1  水泵继电器   (低电平吸合)
+    HAL_OUT_LED_RED,        // PA13
+    HAL_OUT_LED_GREEN,      // PA12
+    HAL_OUT_LED_BLUE,       // PA14
+    HAL_OUT_BUZZER,         // PC6
+    HAL_OUT_COUNT
+} HAL_Output_t;
+
+// PWM 通道
+typedef enum {
+    HAL_PWM_HEATER,         // TIM1_CH1 PA8,  1kHz, ARR=999
+    HAL_PWM_SPRINKLER,      // TIM1_CH4 PA11, 1kHz, ARR=999
+    HAL_PWM_FAN,            // TIM2_CH2 PA1,  1kHz, ARR=999
+    HAL_PWM_SERVO,          // TIM3_CH1 PA6,  50Hz, ARR=19999 (1us 分辨率)
+    HAL_PWM_COUNT
+} HAL_Pwm_t;
+
+// 周期定时器
+typedef enum {
+    HAL_TIMER_SIM_TICK,     // TIM4 仿真节拍
+    HAL_TIMER_ALARM,        // TIM7 声光告警节拍
+    HAL_TIMER_SUPERVISOR,   // TIM5 看门狗监督节拍
+    HAL_TIMER_COUNT
+} HAL_Timer_t;
+
+typedef void (*HAL_TimerCallback_t)(void);
+
+// GPIO
+void    HAL_GPIO_InitOutput(HAL_Output_t out, uint8_t initial_level);
+void    HAL_GPIO_Write(HAL_Output_t out, uint8_t level);
+uint8_t HAL_GPIO_Get(HAL_Output_t out);             // 读回输出锁存值
+
+// PWM
+void     HAL_PWM_Init(HAL_Pwm_t ch, uint16_t initial_compare);
+void     HAL_PWM_SetCompare(HAL_Pwm_t ch, uint16_t compare);
+uint16_t HAL_PWM_GetCompare(HAL_Pwm_t ch);
+uint16_t HAL_PWM_GetPeriod(HAL_Pwm_t ch);           // 返回 ARR
+
+// PWM 比较值序列：每个步进周期由 DMA 把序列中的下一个值写入比较寄存器，播放期间不占用 CPU，
+// 放完后停在最后一个值。加热器/洒水器 (TIM1 每 10 个周期一次更新事件，突发写 CCR1~CCR4)、
+// 风机 (TIM6 10ms 节拍) 步进 10ms，舵机 (TIM3 更新事件) 步进 20ms。
+// values 会被复制，调用返回后即可释放；count 为 0 停止播放；HAL_PWM_SetCompare() 同样会中止该通道的序列
+#define HAL_PWM_STREAM_MAX      100
+void     HAL_PWM_Stream(HAL_Pwm_t ch, const uint16_t* values, uint16_t count);
+uint16_t HAL_PWM_StreamRemaining(HAL_Pwm_t ch);     // 尚未写入的步数，0 表示空闲
+uint16_t HAL_PWM_StreamStepMs(HAL_Pwm_t ch);
+// 循环播放 (循环 DMA)：序列首尾相接反复写入，直到 HAL_PWM_Stream()/HAL_PWM_SetCompare() 中止。
+// 同一时刻只有一个通道可以循环播放；TIM1 的两个通道共用突发 DMA，不支持，返回 1
+#define HAL_PWM_LOOP_MAX        400
+uint8_t  HAL_PWM_StreamLoop(HAL_Pwm_t ch, const uint16_t* values, uint16_t count);
+
+// 定时器：period 为 2kHz 计数值(每计数 0.5ms)，回调在中断上下文中执行
+void HAL_Timer_StartPeriodic(HAL_Timer_t timer, uint16_t period, HAL_TimerCallback_t callback);
+
+// 周期计数器：目标板为 DWT CYCCNT (72MHz, 约 59s 回绕)，主机为单调时钟纳秒数，差值按无符号运算
+void     HAL_CycleCounter_Init(void);
+uint32_t HAL_CycleCounter_Read(void);
+uint32_t HAL_CycleCounter_Hz(void);
+
+// 独立看门狗：LSI 约 40kHz、64 分频，timeout_ms 上限约 6500；启动后无法停止
+void HAL_IWDG_Start(uint16_t timeout_ms);
+void HAL_IWDG_Feed(void);
+// 窗口看门狗：PCLK1 36MHz / 4096 / 8，每计数约 0.91ms，计数器从 0x7F 减到 0x3F 时复位 (约 58ms)；
+// 计数器仍高于 window 时喂狗同样复位，因此 HAL_WWDG_Feed() 在窗口未打开时不喂并返回 0。
+// early_wakeup 在复位前约 0.91ms 于中断上下文中调用，只能用于记录现场；irq_priority 为其抢占优先级
+// (NVIC 组 2，0~3)，须高于所有应用中断，否则卡住节拍的中断同样挡住提前唤醒，现场来不及记录
+#define HAL_WWDG_COUNTER_MAX    0x7F
+#define HAL_WWDG_TICK_US        910
+void    HAL_WWDG_Start(uint8_t window, uint8_t irq_priority, HAL_TimerCallback_t early_wakeup);
+uint8_t HAL_WWDG_Feed(void);
+
+// 复位原因：读取并清除 RCC_CSR 中的复位标志，上电后只应调用一次
+typedef enum {
+    HAL_RESET_UNKNOWN = 0,
+    HAL_RESET_POWER_ON,
+    HAL_RESET_PIN,          // NRST 引脚
+    HAL_RESET_SOFTWARE,
+    HAL_RESET_IWDG,
+    HAL_RESET_WWDG,
+    HAL_RESET_LOW_POWER,
+    HAL_RESET_CAUSE_COUNT
+} HAL_ResetCause_t;
+HAL_ResetCause_t HAL_Reset_Cause(void);
+
+// 备份寄存器 BKP_DR1~DR10 (16 位)：系统复位后保持，VBAT 无电时随主电源掉电清零
+#define HAL_BKP_COUNT           10
+void     HAL_BKP_Write(uint8_t index, uint16_t value);  // index 为 1~HAL_BKP_COUNT
+uint16_t HAL_BKP_Read(uint8_t index);
+
+// 片内 Flash：地址为绝对地址 (0x08000000 起)，按页擦除，按半字编程 (只能把已擦除的 0xFFFF 改写)
+// 擦除一页约 20~40ms，编程每半字约 50us，期间 CPU 取指停顿
+#define HAL_FLASH_BASE          0x08000000u
+#define HAL_FLASH_SIZE          (512u * 1024u)
+#define HAL_FLASH_PAGE_SIZE     2048u
+uint8_t HAL_Flash_ErasePage(uint32_t addr);                                 // 返回 0 成功
+uint8_t HAL_Flash_Program(uint32_t addr, const uint8_t* data, uint16_t len); // addr 与 len 须为偶数，返回 0 成功
+void    HAL_Flash_Read(uint32_t addr, uint8_t* out, uint16_t len);
+
+#endif
@@ -0,0 +1,627 @@
+#include "hal.h"
+#include "stm32f10x.h"
+#include "iwdg.h"
+#include "wwdg.h"
+#include <string.h>
+
+/* 数字输出引脚表，顺序与 HAL_Output_t 一致 */
+typedef struct {
+    GPIO_TypeDef* port;
+    uint16_t      pin;
+    uint32_t      rcc;
+} HAL_GpioMap_t;
+
+static const HAL_GpioMap_t s_gpio_map[HAL_OUT_COUNT] = {
+    { GPIOB, GPIO_Pin_15, RCC_APB2Periph_GPIOB },   // HAL_OUT_RELAY_HEATER
+    { GPIOB, GPIO_Pin_14, RCC_APB2Periph_GPIOB },   // HAL_OUT_RELAY_FAN
+    { GPIOB, GPIO_Pin_1,  RCC_APB2Periph_GPIOB },   // HAL_OUT_RELAY_PUMP
+    { GPIOA, GPIO_Pin_13, RCC_APB2Periph_GPIOA },   // HAL_OUT_LED_RED
+    { GPIOA, GPIO_Pin_12, RCC_APB2Periph_GPIOA },   // HAL_OUT_LED_GREEN
+    { GPIOA, GPIO_Pin_14, RCC_APB2Periph_GPIOA },   // HAL_OUT_LED_BLUE
+    { GPIOC, GPIO_Pin_6,  RCC_APB2Periph_GPIOC },   // HAL_OUT_BUZZER
+};
+
+/* PWM 通道表，顺序与 HAL_Pwm_t 一致 */
+typedef struct {
+    TIM_TypeDef* tim;
+    uint8_t      channel;       // 1~4
+    uint16_t     pin;           // 均位于 GPIOA
+    uint16_t     period;        // ARR
+    uint8_t      rcr;           // 重复计数：每 rcr+1 个周期一次更新事件 (仅 TIM1)
+    // 比较值序列：触发 DMA 的定时器、DMA 通道、目标寄存器与步进周期
+    TIM_TypeDef*         trig;
+    DMA_Channel_TypeDef* dma;
+    volatile uint16_t*   dst;
+    uint8_t              step_ms;
+} HAL_PwmMap_t;
+
+static const HAL_PwmMap_t s_pwm_map[HAL_PWM_COUNT] = {
+    { TIM1, 1, GPIO_Pin_8,  999,   9, TIM1, DMA1_Channel5, &TIM1->DMAR, 10 },   // HAL_PWM_HEATER
+    { TIM1, 4, GPIO_Pin_11, 999,   9, TIM1, DMA1_Channel5, &TIM1->DMAR, 10 },   // HAL_PWM_SPRINKLER
+    { TIM2, 2, GPIO_Pin_1,  999,   0, TIM6, DMA2_Channel3, &TIM2->CCR2, 10 },   // HAL_PWM_FAN
+    { TIM3, 1, GPIO_Pin_6,  19999, 0, TIM3, DMA1_Channel3, &TIM3->CCR1, 20 },   // HAL_PWM_SERVO
+};
+
+/* 比较值序列。TIM1 两个通道共用一路 DMA：每次更新事件突发写 CCR1~CCR4，两路序列交织在 s_tim1_burst 中 */
+typedef struct {
+    uint16_t values[HAL_PWM_STREAM_MAX];
+    uint16_t count;
+} HAL_PwmStream_t;
+
+static HAL_PwmStream_t s_stream[HAL_PWM_COUNT];
+static uint16_t        s_tim1_burst[HAL_PWM_STREAM_MAX][4];
+static uint16_t        s_tim1_rows;
+static uint16_t        s_loop[HAL_PWM_LOOP_MAX];    // 循环播放的序列
+static int8_t          s_loop_ch = -1;
+
+static HAL_TimerCallback_t s_timer_callback[HAL_TIMER_COUNT];
+
+/* 标准库 V3.5 的 core_cm3.h 未定义 DWT，直接按地址访问 */
+#define DWT_CTRL            (*(volatile uint32_t*)0xE0001000)
+#define DWT_CYCCNT          (*(volatile uint32_t*)0xE0001004)
+#define DWT_CTRL_CYCCNTENA  (1UL << 0)
+
+/**
+ * @brief  配置推挽输出引脚并写入初始电平
+ */
+void HAL_GPIO_InitOutput(HAL_Output_t out, uint8_t initial_level)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    const HAL_GpioMap_t* map = &s_gpio_map[out];
+
+    RCC_APB2PeriphClockCmd(map->rcc, ENABLE);
+    GPIO_InitStructure.GPIO_Pin = map->pin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(map->port, &GPIO_InitStructure);
+
+    HAL_GPIO_Write(out, initial_level);
+}
+
+void HAL_GPIO_Write(HAL_Output_t out, uint8_t level)
+{
+    const HAL_GpioMap_t* map = &s_gpio_map[out];
+
+    if (level)
+    {
+        GPIO_SetBits(map->port, map->pin);
+    }
+    else
+    {
+        GPIO_ResetBits(map->port, map->pin);
+    }
+}
+
+uint8_t HAL_GPIO_Get(HAL_Output_t out)
+{
+    const HAL_GpioMap_t* map = &s_gpio_map[out];
+    return GPIO_ReadOutputDataBit(map->port, map->pin);
+}
+
+/**
+ * @brief  初始化 PWM 通道：时钟、复用引脚、时基(1us 计数)与输出比较
+ * @note   TIM1 的两个通道共用同一时基，重复配置时基不影响已运行的通道
+ */
+void HAL_PWM_Init(HAL_Pwm_t ch, uint16_t initial_compare)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    TIM_OCInitTypeDef TIM_OCInitStructure;
+    const HAL_PwmMap_t* map = &s_pwm_map[ch];
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_AFIO, ENABLE);
+    if (map->tim == TIM1)
+    {
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_TIM1, ENABLE);
+    }
+    else if (map->tim == TIM2)
+    {
+        RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+    }
+    else
+    {
+        RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+    }
+
+    GPIO_InitStructure.GPIO_Pin = map->pin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(GPIOA, &GPIO_InitStructure);
+
+    TIM_TimeBaseStructure.TIM_Period = map->period;
+    TIM_TimeBaseStructure.TIM_Prescaler = 71;
+    TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseStructure.TIM_RepetitionCounter = map->rcr;
+    TIM_TimeBaseInit(map->tim, &TIM_TimeBaseStructure);
+
+    TIM_OCStructInit(&TIM_OCInitStructure);
+    TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
+    TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;
+    TIM_OCInitStructure.TIM_Pulse = initial_compare;
+    TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;
+
+    switch (map->channel)
+    {
+        case 1:
+            TIM_OC1Init(map->tim, &TIM_OCInitStructure);
+            TIM_OC1PreloadConfig(map->tim, TIM_OCPreload_Enable);
+            break;
+        case 2:
+            TIM_OC2Init(map->tim, &TIM_OCInitStructure);
+            TIM_OC2PreloadConfig(map->tim, TIM_OCPreload_Enable);
+            break;
+        case 3:
+            TIM_OC3Init(map->tim, &TIM_OCInitStructure);
+            TIM_OC3PreloadConfig(map->tim, TIM_OCPreload_Enable);
+            break;
+        default:
+            TIM_OC4Init(map->tim, &TIM_OCInitStructure);
+            TIM_OC4PreloadConfig(map->tim, TIM_OCPreload_Enable);
+            break;
+    }
+
+    if (map->tim == TIM1)
+    {
+        // 高级定时器需要额外打开主输出
+        TIM_CtrlPWMOutputs(TIM1, ENABLE);
+    }
+    TIM_ARRPreloadConfig(map->tim, ENABLE);
+    TIM_Cmd(map->tim, ENABLE);
+
+    // 序列播放用的 DMA 时钟；风机通道另用 TIM6 产生 10ms 的 DMA 节拍 (TIM2 没有重复计数器)
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1 | RCC_AHBPeriph_DMA2, ENABLE);
+    if (map->trig == TIM6)
+    {
+        RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM6, ENABLE);
+        TIM_TimeBaseStructure.TIM_Period = map->step_ms * 1000 - 1;
+        TIM_TimeBaseStructure.TIM_Prescaler = 71;
+        TIM_TimeBaseInit(TIM6, &TIM_TimeBaseStructure);
+        TIM_Cmd(TIM6, ENABLE);
+    }
+}
+
+// DMA 已写入的步数 (TIM1 按行计，写了一半的行不算)；停止后 CNDTR 保持剩余数
+static uint16_t HAL_PWM_Stream_Done(const HAL_PwmMap_t* map, uint16_t total)
+{
+    uint16_t left = (uint16_t)map->dma->CNDTR;
+
+    if (map->tim == TIM1)
+    {
+        left = (left + 3) / 4;
+    }
+    return (left < total) ? (uint16_t)(total - left) : 0;
+}
+
+static void HAL_PWM_Stream_Stop(const HAL_PwmMap_t* map)
+{
+    TIM_DMACmd(map->trig, TIM_DMA_Update, DISABLE);
+    DMA_Cmd(map->dma, DISABLE);
+}
+
+static void HAL_PWM_Stream_Start(const HAL_PwmMap_t* map, const uint16_t* mem, uint16_t count, uint32_t mode)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(map->dma);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)map->dst;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)mem;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = count;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = mode;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(map->dma, &DMA_InitStructure);
+    if (map->tim == TIM1)
+    {
+        // 重新写 DCR 使突发从 CCR1 重新开始
+        TIM_DMAConfig(TIM1, TIM_DMABase_CCR1, TIM_DMABurstLength_4Transfers);
+    }
+    DMA_Cmd(map->dma, ENABLE);
+    TIM_DMACmd(map->trig, TIM_DMA_Update, ENABLE);
+}
+
+/**
+ * @brief  TIM1 组：按已播放的行数截掉两路序列的已写部分，替换本通道后重新交织
+ * @note   没有序列的通道每行都写入其当前比较值 (或最后一个值)，突发写不会改动它
+ */
+static void HAL_PWM_Stream_Tim1(HAL_Pwm_t ch, const uint16_t* values, uint16_t count)
+{
+    const HAL_PwmMap_t* map = &s_pwm_map[ch];
+    const HAL_Pwm_t group[2] = { HAL_PWM_HEATER, HAL_PWM_SPRINKLER };
+    uint16_t done;
+    uint16_t hold[4];
+
+    HAL_PWM_Stream_Stop(map);
+    done = HAL_PWM_Stream_Done(map, s_tim1_rows);
+    hold[0] = TIM1->CCR1;
+    hold[1] = TIM1->CCR2;
+    hold[2] = TIM1->CCR3;
+    hold[3] = TIM1->CCR4;
+
+    s_tim1_rows = 0;
+    for (int g = 0; g < 2; g++)
+    {
+        HAL_PwmStream_t* st = &s_stream[group[g]];
+        if (group[g] == ch)
+        {
+            if (count > 0)
+            {
+                memcpy(st->values, values, count * sizeof(uint16_t));
+            }
+            st->count = count;
+        }
+        else if (done < st->count)
+        {
+            memmove(st->values, &st->values[done], (st->count - done) * sizeof(uint16_t));
+            st->count -= done;
+        }
+        else
+        {
+            st->count = 0;
+        }
+        if (st->count > s_tim1_rows)
+        {
+            s_tim1_rows = st->count;
+        }
+    }
+    if (s_tim1_rows == 0)
+    {
+        return;
+    }
+
+    for (uint16_t r = 0; r < s_tim1_rows; r++)
+    {
+        memcpy(s_tim1_burst[r], hold, sizeof(hold));
+        for (int g = 0; g < 2; g++)
+        {
+            const HAL_PwmStream_t* st = &s_stream[group[g]];
+            uint8_t col = s_pwm_map[group[g]].channel - 1;
+            if (st->count > 0)
+            {
+                s_tim1_burst[r][col] = st->values[(r < st->count) ? r : st->count - 1];
+            }
+        }
+    }
+    HAL_PWM_Stream_Start(map, &s_tim1_burst[0][0], s_tim1_rows * 4, DMA_Mode_Normal);
+}
+
+void HAL_PWM_Stream(HAL_Pwm_t ch, const uint16_t* values, uint16_t count)
+{
+    const HAL_PwmMap_t* map = &s_pwm_map[ch];
+
+    if (count > HAL_PWM_STREAM_MAX)
+    {
+        count = HAL_PWM_STREAM_MAX;
+    }
+    if (map->tim == TIM1)
+    {
+        HAL_PWM_Stream_Tim1(ch, values, count);
+        return;
+    }
+
+    HAL_PWM_Stream_Stop(map);
+    if (s_loop_ch == ch)
+    {
+        s_loop_ch = -1;
+    }
+    s_stream[ch].count = count;
+    if (count > 0)
+    {
+        memcpy(s_stream[ch].values, values, count * sizeof(uint16_t));
+        HAL_PWM_Stream_Start(map, s_stream[ch].values, count, DMA_Mode_Normal);
+    }
+}
+
+uint8_t HAL_PWM_StreamLoop(HAL_Pwm_t ch, const uint16_t* values, uint16_t count)
+{
+    const HAL_PwmMap_t* map = &s_pwm_map[ch];
+
+    if (map->tim == TIM1 || count == 0)
+    {
+        return 1;
+    }
+    if (count > HAL_PWM_LOOP_MAX)
+    {
+        count = HAL_PWM_LOOP_MAX;
+    }
+    if (s_loop_ch >= 0)
+    {
+        HAL_PWM_Stream((HAL_Pwm_t)s_loop_ch, NULL, 0);
+    }
+    HAL_PWM_Stream_Stop(map);
+    memcpy(s_loop, values, count * sizeof(uint16_t));
+    s_loop_ch = ch;
+    // 循环模式下 CNDTR 自动重装、不会到 0，HAL_PWM_StreamRemaining() 一直非零
+    s_stream[ch].count = count;
+    HAL_PWM_Stream_Start(map, s_loop, count, DMA_Mode_Circular);
+    return 0;
+}
+
+uint16_t HAL_PWM_StreamRemaining(HAL_Pwm_t ch)
+{
+    const HAL_PwmMap_t* map = &s_pwm_map[ch];
+    uint16_t total = (map->tim == TIM1) ? s_tim1_rows : s_stream[ch].count;
+    uint16_t done = HAL_PWM_Stream_Done(map, total);
+    uint16_t count = s_stream[ch].count;
+
+    return (done < count) ? (uint16_t)(count - done) : 0;
+}
+
+uint16_t HAL_PWM_StreamStepMs(HAL_Pwm_t ch)
+{
+    return s_pwm_map[ch].step_ms;
+}
+
+void HAL_PWM_SetCompare(HAL_Pwm_t ch, uint16_t compare)
+{
+    const HAL_PwmMap_t* map = &s_pwm_map[ch];
+
+    // 中止该通道的序列；TIM1 另一通道的序列继续，本通道此后保持新值
+    if (map->tim == TIM1)
+    {
+        if (s_tim1_rows > 0 && HAL_PWM_StreamRemaining(HAL_PWM_HEATER) + HAL_PWM_StreamRemaining(HAL_PWM_SPRINKLER) > 0)
+        {
+            HAL_PWM_Stream_Tim1(ch, &compare, 1);
+        }
+    }
+    else if (s_stream[ch].count > 0)
+    {
+        HAL_PWM_Stream(ch, NULL, 0);
+    }
+
+    switch (map->channel)
+    {
+        case 1:  TIM_SetCompare1(map->tim, compare); break;
+        case 2:  TIM_SetCompare2(map->tim, compare); break;
+        case 3:  TIM_SetCompare3(map->tim, compare); break;
+        default: TIM_SetCompare4(map->tim, compare); break;
+    }
+}
+
+uint16_t HAL_PWM_GetCompare(HAL_Pwm_t ch)
+{
+    const HAL_PwmMap_t* map = &s_pwm_map[ch];
+
+    switch (map->channel)
+    {
+        case 1:  return map->tim->CCR1;
+        case 2:  return map->tim->CCR2;
+        case 3:  return map->tim->CCR3;
+        default: return map->tim->CCR4;
+    }
+}
+
+uint16_t HAL_PWM_GetPeriod(HAL_Pwm_t ch)
+{
+    return s_pwm_map[ch].tim->ARR;
+}
+
+/* 周期定时器表，顺序与 HAL_Timer_t 一致 (均位于 APB1，计数时钟 72MHz) */
+typedef struct {
+    TIM_TypeDef* tim;
+    uint32_t     rcc;
+    uint8_t      irqn;
+    uint8_t      sub_priority;
+} HAL_TimerMap_t;
+
+static const HAL_TimerMap_t s_timer_map[HAL_TIMER_COUNT] = {
+    { TIM4, RCC_APB1Periph_TIM4, TIM4_IRQn, 1 },   // HAL_TIMER_SIM_TICK
+    { TIM7, RCC_APB1Periph_TIM7, TIM7_IRQn, 3 },   // HAL_TIMER_ALARM
+    { TIM5, RCC_APB1Periph_TIM5, TIM5_IRQn, 0 },   // HAL_TIMER_SUPERVISOR
+};
+
+/**
+ * @brief  启动周期定时器 (2kHz 计数)
+ * @param  period   重装载计数值，沿用原 TIM4_MainTick_Init 的寄存器配置
+ */
+void HAL_Timer_StartPeriodic(HAL_Timer_t timer, uint16_t period, HAL_TimerCallback_t callback)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    const HAL_TimerMap_t* m;
+
+    if (timer >= HAL_TIMER_COUNT || period == 0)
+    {
+        return;
+    }
+    m = &s_timer_map[timer];
+    s_timer_callback[timer] = callback;
+
+    RCC_APB1PeriphClockCmd(m->rcc, ENABLE);
+
+    TIM_TimeBaseStructure.TIM_Period = period - 1;
+    TIM_TimeBaseStructure.TIM_Prescaler = 36000 - 1;
+    TIM_TimeBaseStructure.TIM_ClockDivision = 0;
+    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(m->tim, &TIM_TimeBaseStructure);
+
+    TIM_ClearITPendingBit(m->tim, TIM_IT_Update);
+    TIM_ITConfig(m->tim, TIM_IT_Update, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = m->irqn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = m->sub_priority;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    TIM_Cmd(m->tim, ENABLE);
+}
+
+static void Timer_IRQ(HAL_Timer_t timer)
+{
+    TIM_TypeDef* tim = s_timer_map[timer].tim;
+
+    if (TIM_GetITStatus(tim, TIM_IT_Update) != RESET)
+    {
+        if (s_timer_callback[timer] != 0)
+        {
+            s_timer_callback[timer]();
+        }
+        // 清除中断标志位，否则会不停地进入中断
+        TIM_ClearITPendingBit(tim, TIM_IT_Update);
+    }
+}
+
+// TIM4中断服务函数
+void TIM4_IRQHandler(void)
+{
+    Timer_IRQ(HAL_TIMER_SIM_TICK);
+}
+
+// TIM7中断服务函数
+void TIM7_IRQHandler(void)
+{
+    Timer_IRQ(HAL_TIMER_ALARM);
+}
+
+// TIM5中断服务函数
+void TIM5_IRQHandler(void)
+{
+    Timer_IRQ(HAL_TIMER_SUPERVISOR);
+}
+
+/**
+ * @brief  启动独立看门狗 (64 分频，每计数 1.6ms)，调试器暂停内核时两个看门狗一起停止计数
+ */
+void HAL_IWDG_Start(uint16_t timeout_ms)
+{
+    uint32_t rlr = (uint32_t)timeout_ms * 40 / 64;
+
+    if (rlr > 0xFFF)
+    {
+        rlr = 0xFFF;
+    }
+    DBGMCU->CR |= DBGMCU_CR_DBG_IWDG_STOP | DBGMCU_CR_DBG_WWDG_STOP;
+    IWDG_Init(IWDG_Prescaler_64, (uint16_t)rlr);
+}
+
+void HAL_IWDG_Feed(void)
+{
+    IWDG_Feed();
+}
+
+void HAL_WWDG_Start(uint8_t window, uint8_t irq_priority, HAL_TimerCallback_t early_wakeup)
+{
+    WWDG_Set_EarlyWakeup_Hook(early_wakeup);
+    WWDG_Init(HAL_WWDG_COUNTER_MAX, window, WWDG_Prescaler_8, irq_priority);
+}
+
+/**
+ * @brief  计数器降到窗口值以下才重装，提前喂狗会直接复位
+ */
+uint8_t HAL_WWDG_Feed(void)
+{
+    if ((WWDG->CR & 0x7F) >= (WWDG->CFR & 0x7F))
+    {
+        return 0;
+    }
+    WWDG_Set_Counter(HAL_WWDG_COUNTER_MAX);
+    return 1;
+}
+
+/**
+ * @brief  按优先级解读复位标志：看门狗与软件复位同样会拉低 NRST，PINRST 最后判断
+ */
+HAL_ResetCause_t HAL_Reset_Cause(void)
+{
+    HAL_ResetCause_t cause = HAL_RESET_UNKNOWN;
+
+    if (RCC_GetFlagStatus(RCC_FLAG_LPWRRST) != RESET)       cause = HAL_RESET_LOW_POWER;
+    else if (RCC_GetFlagStatus(RCC_FLAG_WWDGRST) != RESET)  cause = HAL_RESET_WWDG;
+    else if (RCC_GetFlagStatus(RCC_FLAG_IWDGRST) != RESET)  cause = HAL_RESET_IWDG;
+    else if (RCC_GetFlagStatus(RCC_FLAG_SFTRST) != RESET)   cause = HAL_RESET_SOFTWARE;
+    else if (RCC_GetFlagStatus(RCC_FLAG_PORRST) != RESET)   cause = HAL_RESET_POWER_ON;
+    else if (RCC_GetFlagStatus(RCC_FLAG_PINRST) != RESET)   cause = HAL_RESET_PIN;
+    RCC_ClearFlag();
+    return cause;
+}
+
+static void BKP_Access(void)
+{
+    static uint8_t s_bkp_ready = 0;
+
+    if (!s_bkp_ready)
+    {
+        RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);
+        PWR_BackupAccessCmd(ENABLE);
+        s_bkp_ready = 1;
+    }
+}
+
+// BKP_DR1~DR10 的偏移为 4 的整数倍
+void HAL_BKP_Write(uint8_t index, uint16_t value)
+{
+    if (index == 0 || index > HAL_BKP_COUNT)
+    {
+        return;
+    }
+    BKP_Access();
+    BKP_WriteBackupRegister((uint16_t)(index * 4), value);
+}
+
+uint16_t HAL_BKP_Read(uint8_t index)
+{
+    if (index == 0 || index > HAL_BKP_COUNT)
+    {
+        return 0;
+    }
+    BKP_Access();
+    return BKP_ReadBackupRegister((uint16_t)(index * 4));
+}
+
+/**
+ * @brief  打开 DWT 周期计数器 (需先置位 DEMCR.TRCENA)
+ */
+void HAL_CycleCounter_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+uint32_t HAL_CycleCounter_Read(void)
+{
+    return DWT_CYCCNT;
+}
+
+uint32_t HAL_CycleCounter_Hz(void)
+{
+    return SystemCoreClock;
+}
+
+/**
+ * @brief  擦除一页片内 Flash，擦除期间从 Flash 取指的代码停顿
+ */
+uint8_t HAL_Flash_ErasePage(uint32_t addr)
+{
+    FLASH_Status st;
+
+    FLASH_Unlock();
+    st = FLASH_ErasePage(addr);
+    FLASH_Lock();
+    return (st == FLASH_COMPLETE) ? 0 : 1;
+}
+
+uint8_t HAL_Flash_Program(uint32_t addr, const uint8_t* data, uint16_t len)
+{
+    FLASH_Status st = FLASH_COMPLETE;
+
+    FLASH_Unlock();
+    for (uint16_t i = 0; i + 1 < len && st == FLASH_COMPLETE; i += 2)
+    {
+        st = FLASH_ProgramHalfWord(addr + i, (uint16_t)(data[i] | (data[i + 1] << 8)));
+    }
+    FLASH_Lock();
+    return (st == FLASH_COMPLETE) ? 0 : 1;
+}
+
+// Flash 映射在地址空间中，直接拷贝
+void HAL_Flash_Read(uint32_t addr, uint8_t* out, uint16_t len)
+{
+    memcpy(out, (const void*)addr, len);
+}
@@ -0,0 +1,431 @@
+#include "hal.h"
+#include "hal_host.h"
+#include "delay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* 外设影子状态 */
+static uint8_t  s_gpio_level[HAL_OUT_COUNT];
+static uint16_t s_pwm_compare[HAL_PWM_COUNT];
+static const uint16_t s_pwm_period[HAL_PWM_COUNT] = { 999, 999, 999, 19999 };
+static const uint8_t  s_pwm_step_ms[HAL_PWM_COUNT] = { 10, 10, 10, 20 };
+
+/* 比较值序列：代替定时器事件触发的 DMA，每个步进周期由虚拟时钟写入下一个值 */
+typedef struct {
+    uint16_t values[HAL_PWM_LOOP_MAX];
+    uint16_t count;
+    uint16_t pos;
+    uint8_t  loop;
+    uint64_t next_us;
+} HostPwmStream_t;
+
+static HostPwmStream_t s_pwm_stream[HAL_PWM_COUNT];
+
+/* 周期定时器：与目标板相同的 2kHz 计数，即每个计数 500us */
+typedef struct {
+    uint64_t            period_us;
+    uint64_t            next_us;
+    HAL_TimerCallback_t callback;
+} HostTimer_t;
+
+static HostTimer_t     s_timer[HAL_TIMER_COUNT];
+static Host_TickHook_t s_tick_hook[HOST_TICK_HOOK_MAX];
+static uint8_t         s_tick_hook_num;
+
+static uint64_t s_now_us;
+
+/* 看门狗：在虚拟时间中检查喂狗间隔；主机上没有复位，超时即打印并结束进程 */
+static uint8_t             s_iwdg_on;
+static uint64_t            s_iwdg_timeout_us;
+static uint64_t            s_iwdg_fed_us;
+static uint8_t             s_wwdg_on;
+static uint8_t             s_wwdg_window;
+static uint8_t             s_wwdg_ewi_done;
+static uint64_t            s_wwdg_fed_us;
+static HAL_TimerCallback_t s_wwdg_ewi;
+
+static uint16_t s_bkp[HAL_BKP_COUNT];
+
+void HAL_GPIO_InitOutput(HAL_Output_t out, uint8_t initial_level)
+{
+    HAL_GPIO_Write(out, initial_level);
+}
+
+void HAL_GPIO_Write(HAL_Output_t out, uint8_t level)
+{
+    s_gpio_level[out] = level ? 1 : 0;
+}
+
+uint8_t HAL_GPIO_Get(HAL_Output_t out)
+{
+    return s_gpio_level[out];
+}
+
+void HAL_PWM_Init(HAL_Pwm_t ch, uint16_t initial_compare)
+{
+    s_pwm_compare[ch] = initial_compare;
+}
+
+void HAL_PWM_SetCompare(HAL_Pwm_t ch, uint16_t compare)
+{
+    s_pwm_stream[ch].count = 0;
+    s_pwm_stream[ch].loop = 0;
+    s_pwm_compare[ch] = compare;
+}
+
+// 第一个值在下一个步进边界写入，与目标板等待下一次更新事件一致
+void HAL_PWM_Stream(HAL_Pwm_t ch, const uint16_t* values, uint16_t count)
+{
+    HostPwmStream_t* st = &s_pwm_stream[ch];
+    uint64_t step_us = s_pwm_step_ms[ch] * 1000ULL;
+
+    if (count > HAL_PWM_STREAM_MAX)
+    {
+        count = HAL_PWM_STREAM_MAX;
+    }
+    if (count > 0)
+    {
+        memcpy(st->values, values, count * sizeof(uint16_t));
+    }
+    st->count = count;
+    st->pos = 0;
+    st->loop = 0;
+    st->next_us = (s_now_us / step_us + 1) * step_us;
+}
+
+uint8_t HAL_PWM_StreamLoop(HAL_Pwm_t ch, const uint16_t* values, uint16_t count)
+{
+    if (ch == HAL_PWM_HEATER || ch == HAL_PWM_SPRINKLER || count == 0)
+    {
+        return 1;
+    }
+    if (count > HAL_PWM_LOOP_MAX)
+    {
+        count = HAL_PWM_LOOP_MAX;
+    }
+    // 与目标板一致：同一时刻只有一个通道循环播放
+    for (int i = 0; i < HAL_PWM_COUNT; i++)
+    {
+        if (s_pwm_stream[i].loop)
+        {
+            s_pwm_stream[i].loop = 0;
+            s_pwm_stream[i].count = 0;
+        }
+    }
+    HAL_PWM_Stream(ch, NULL, 0);
+    memcpy(s_pwm_stream[ch].values, values, count * sizeof(uint16_t));
+    s_pwm_stream[ch].count = count;
+    s_pwm_stream[ch].loop = 1;
+    return 0;
+}
+
+uint16_t HAL_PWM_StreamRemaining(HAL_Pwm_t ch)
+{
+    const HostPwmStream_t* st = &s_pwm_stream[ch];
+    return st->loop ? st->count - st->pos % st->count : st->count - st->pos;
+}
+
+uint16_t HAL_PWM_StreamStepMs(HAL_Pwm_t ch)
+{
+    return s_pwm_step_ms[ch];
+}
+
+static void Host_Pwm_Stream_Advance(void)
+{
+    for (int ch = 0; ch < HAL_PWM_COUNT; ch++)
+    {
+        HostPwmStream_t* st = &s_pwm_stream[ch];
+        while (st->pos < st->count && st->next_us <= s_now_us)
+        {
+            s_pwm_compare[ch] = st->values[st->pos++];
+            st->next_us += s_pwm_step_ms[ch] * 1000ULL;
+            if (st->loop && st->pos == st->count)
+            {
+                st->pos = 0;
+            }
+        }
+    }
+}
+
+uint16_t HAL_PWM_GetCompare(HAL_Pwm_t ch)
+{
+    return s_pwm_compare[ch];
+}
+
+uint16_t HAL_PWM_GetPeriod(HAL_Pwm_t ch)
+{
+    return s_pwm_period[ch];
+}
+
+void HAL_Timer_StartPeriodic(HAL_Timer_t timer, uint16_t period, HAL_TimerCallback_t callback)
+{
+    if (timer >= HAL_TIMER_COUNT || period == 0)
+    {
+        return;
+    }
+    s_timer[timer].period_us = (uint64_t)period * 500;
+    s_timer[timer].next_us = s_now_us + s_timer[timer].period_us;
+    s_timer[timer].callback = callback;
+}
+
+void HAL_IWDG_Start(uint16_t timeout_ms)
+{
+    s_iwdg_on = 1;
+    s_iwdg_timeout_us = (uint64_t)timeout_ms * 1000;
+    s_iwdg_fed_us = s_now_us;
+}
+
+void HAL_IWDG_Feed(void)
+{
+    s_iwdg_fed_us = s_now_us;
+}
+
+void HAL_WWDG_Start(uint8_t window, uint8_t irq_priority, HAL_TimerCallback_t early_wakeup)
+{
+    (void)irq_priority;     // 主机上的 "中断" 同步执行，没有抢占
+    s_wwdg_on = 1;
+    s_wwdg_window = window;
+    s_wwdg_ewi = early_wakeup;
+    s_wwdg_ewi_done = 0;
+    s_wwdg_fed_us = s_now_us;
+}
+
+static uint8_t Host_Wwdg_Counter(void)
+{
+    uint64_t ticks = (s_now_us - s_wwdg_fed_us) / HAL_WWDG_TICK_US;
+    return (ticks > HAL_WWDG_COUNTER_MAX) ? 0 : (uint8_t)(HAL_WWDG_COUNTER_MAX - ticks);
+}
+
+uint8_t HAL_WWDG_Feed(void)
+{
+    if (!s_wwdg_on || Host_Wwdg_Counter() >= s_wwdg_window)
+    {
+        return 0;
+    }
+    s_wwdg_fed_us = s_now_us;
+    s_wwdg_ewi_done = 0;
+    return 1;
+}
+
+/**
+ * @brief  提前唤醒在计数器到 0x40 时触发，降到 0x3F 时 "复位"
+ */
+static void Host_Watchdog_Check(void)
+{
+    if (s_iwdg_on && s_now_us - s_iwdg_fed_us >= s_iwdg_timeout_us)
+    {
+        printf("HOST: IWDG reset at t=%llu ms (not fed for %llu ms)\n",
+               (unsigned long long)(s_now_us / 1000), (unsigned long long)((s_now_us - s_iwdg_fed_us) / 1000));
+        exit(3);
+    }
+    if (s_wwdg_on)
+    {
+        uint8_t counter = Host_Wwdg_Counter();
+
+        if (counter <= 0x40 && !s_wwdg_ewi_done)
+        {
+            s_wwdg_ewi_done = 1;
+            if (s_wwdg_ewi != NULL)
+            {
+                s_wwdg_ewi();
+            }
+        }
+        if (counter < 0x40)
+        {
+            printf("HOST: WWDG reset at t=%llu ms\n", (unsigned long long)(s_now_us / 1000));
+            exit(3);
+        }
+    }
+}
+
+HAL_ResetCause_t HAL_Reset_Cause(void)
+{
+    return HAL_RESET_POWER_ON;
+}
+
+void HAL_BKP_Write(uint8_t index, uint16_t value)
+{
+    if (index >= 1 && index <= HAL_BKP_COUNT)
+    {
+        s_bkp[index - 1] = value;
+    }
+}
+
+uint16_t HAL_BKP_Read(uint8_t index)
+{
+    return (index >= 1 && index <= HAL_BKP_COUNT) ? s_bkp[index - 1] : 0;
+}
+
+/* 周期计数器：主机端测量真实 CPU 耗时(纳秒)，不受虚拟时钟影响 */
+void HAL_CycleCounter_Init(void)
+{
+}
+
+uint32_t HAL_CycleCounter_Read(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+uint32_t HAL_CycleCounter_Hz(void)
+{
+    return 1000000000u;
+}
+
+void Host_Register_Tick_Hook(Host_TickHook_t hook)
+{
+    if (s_tick_hook_num < HOST_TICK_HOOK_MAX)
+    {
+        s_tick_hook[s_tick_hook_num++] = hook;
+    }
+}
+
+uint64_t Host_Time_Us(void)
+{
+    return s_now_us;
+}
+
+/**
+ * @brief  推进虚拟时间，逐毫秒触发到期的定时器回调和中断钩子
+ */
+void Host_Advance_Us(uint64_t us)
+{
+    uint64_t target = s_now_us + us;
+
+    while (s_now_us < target)
+    {
+        uint64_t next_ms = (s_now_us / 1000 + 1) * 1000;
+        s_now_us = (next_ms < target) ? next_ms : target;
+
+        for (int i = 0; i < HAL_TIMER_COUNT; i++)
+        {
+            HostTimer_t* t = &s_timer[i];
+            while (t->callback != NULL && t->next_us <= s_now_us)
+            {
+                t->next_us += t->period_us;
+                t->callback();
+            }
+        }
+
+        Host_Pwm_Stream_Advance();
+        Host_Watchdog_Check();
+
+        if (s_now_us % 1000 == 0)
+        {
+            for (int i = 0; i < s_tick_hook_num; i++)
+            {
+                s_tick_hook[i](s_now_us / 1000);
+            }
+        }
+    }
+}
+
+/* delay.h 的主机实现 */
+void System_SysTickInit(void)
+{
+}
+
+uint64_t System_GetTimeMs(void)
+{
+    return s_now_us / 1000;
+}
+
+void delay(uint32_t nus)
+{
+    Host_Advance_Us(nus);
+}
+
+void delay_us(uint32_t nus)
+{
+    Host_Advance_Us(nus);
+}
+
+static Delay_IdleHook_t s_idle_hook = NULL;
+static uint8_t s_idle_running = 0;
+
+// 与目标板相同：每推进 1ms 调用一次空闲钩子
+void delay_ms(uint32_t nms)
+{
+    for (uint32_t i = 0; i < nms; i++)
+    {
+        Host_Advance_Us(1000);
+        if (s_idle_hook != NULL && !s_idle_running)
+        {
+            s_idle_running = 1;
+            s_idle_hook();
+            s_idle_running = 0;
+        }
+    }
+}
+
+void delay_set_idle_hook(Delay_IdleHook_t hook)
+{
+    s_idle_hook = hook;
+}
+
+/* 片内 Flash：整片 512KB 以数组模拟，首次访问时为擦除状态 */
+static uint8_t s_flash[HAL_FLASH_SIZE];
+static uint8_t s_flash_ready = 0;
+
+static uint8_t* Host_Flash_At(uint32_t addr, uint32_t len)
+{
+    if (!s_flash_ready)
+    {
+        memset(s_flash, 0xFF, sizeof(s_flash));
+        s_flash_ready = 1;
+    }
+    if (addr < HAL_FLASH_BASE || addr - HAL_FLASH_BASE + len > HAL_FLASH_SIZE)
+    {
+        return NULL;
+    }
+    return &s_flash[addr - HAL_FLASH_BASE];
+}
+
+uint8_t HAL_Flash_ErasePage(uint32_t addr)
+{
+    uint8_t* p = Host_Flash_At(addr & ~(HAL_FLASH_PAGE_SIZE - 1), HAL_FLASH_PAGE_SIZE);
+    if (p == NULL)
+    {
+        return 1;
+    }
+    memset(p, 0xFF, HAL_FLASH_PAGE_SIZE);
+    Host_Advance_Us(20000);
+    return 0;
+}
+
+// 与硬件相同：目标半字不是 0xFFFF 时 (写入 0 除外) 编程失败
+uint8_t HAL_Flash_Program(uint32_t addr, const uint8_t* data, uint16_t len)
+{
+    uint8_t* p = Host_Flash_At(addr, len);
+    if (p == NULL || (addr & 1) != 0)
+    {
+        return 1;
+    }
+    for (uint16_t i = 0; i + 1 < len; i += 2)
+    {
+        uint16_t old = (uint16_t)(p[i] | (p[i + 1] << 8));
+        uint16_t val = (uint16_t)(data[i] | (data[i + 1] << 8));
+        if (old != 0xFFFF && val != 0)
+        {
+            return 1;
+        }
+        p[i] = data[i];
+        p[i + 1] = data[i + 1];
+        Host_Advance_Us(50);
+    }
+    return 0;
+}
+
+void HAL_Flash_Read(uint32_t addr, uint8_t* out, uint16_t len)
+{
+    uint8_t* p = Host_Flash_At(addr, len);
+    if (p == NULL)
+    {
+        memset(out, 0xFF, len);
+        return;
+    }
+    memcpy(out, p, len);
+}
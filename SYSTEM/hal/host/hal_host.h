@@ -0,0 +1,23 @@
+/**
+ ******************************************************************************
+ * @ 名称  主机端硬件抽象层扩展接口
+ * @ 描述  虚拟时钟：delay_ms()/delay_us() 不真正等待，而是推进虚拟时间，
+ *         并在推进过程中同步触发到期的定时器回调与"中断"钩子(串口接收等)。
+ ******************************************************************************
+ */
+#ifndef __HAL_HOST_H
+#define __HAL_HOST_H
+
+#include "hal.h"
+#include <stdint.h>
+
+#define HOST_TICK_HOOK_MAX   4
+
+// 虚拟时间每推进 1ms 调用一次，用于模拟外设中断
+typedef void (*Host_TickHook_t)(uint64_t now_ms);
+
+void     Host_Register_Tick_Hook(Host_TickHook_t hook);
+void     Host_Advance_Us(uint64_t us);
+uint64_t Host_Time_Us(void);
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @ 名称  主机构建用的 stm32f10x.h 替身
+ * @ 描述  仅在 make host 时位于头文件搜索路径最前面，提供可移植模块
+ *         间接用到的类型与内核函数，不包含任何寄存器定义。
+ ******************************************************************************
+ */
+#ifndef __STM32F10x_H
+#define __STM32F10x_H
+
+#include <stdint.h>
+
+typedef int32_t  s32;
+typedef int16_t  s16;
+typedef int8_t   s8;
+typedef uint32_t u32;
+typedef uint16_t u16;
+typedef uint8_t  u8;
+
+typedef volatile uint32_t vu32;
+typedef volatile uint16_t vu16;
+typedef volatile uint8_t  vu8;
+
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+
+// 仅用于满足驱动头文件中的外部声明
+typedef struct
+{
+    volatile uint32_t CRL;
+    volatile uint32_t CRH;
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+    volatile uint32_t BSRR;
+    volatile uint32_t BRR;
+    volatile uint32_t LCKR;
+} GPIO_TypeDef;
+
+// 主机仿真是单线程的，"中断"只在虚拟时钟推进时同步执行，临界区无需屏蔽
+#define __disable_irq()   ((void)0)
+#define __enable_irq()    ((void)0)
+#define NVIC_DisableIRQ(irq)  ((void)0)
+#define NVIC_EnableIRQ(irq)   ((void)0)
+
+#endif
@@ -0,0 +1,5 @@
+/* 主机构建用的 stm32f10x_conf.h 替身：主机端不使用标准外设库 */
+#ifndef __STM32F10x_CONF_H
+#define __STM32F10x_CONF_H
+
+#endif
@@ -0,0 +1,133 @@
+#include "profile.h"
+
+#if PROFILE_ENABLE
+
+#include "hal.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* const s_stage_name[PROF_STAGE_COUNT] = {
+    "loop", "sense", "analyze", "decide", "actuate", "publish", "display"
+};
+
+static ProfileStats_t s_stats[PROF_STAGE_COUNT];
+static uint32_t s_start[PROF_STAGE_COUNT];
+static uint32_t s_last_report_ms;
+
+// 周期数所在的对数桶：floor(log2(cycles))
+static uint8_t cycles_to_bucket(uint32_t cycles)
+{
+    return (cycles == 0) ? 0 : (uint8_t)(31 - __builtin_clz(cycles));
+}
+
+static uint32_t cycles_to_us(uint64_t cycles)
+{
+    uint32_t per_us = HAL_CycleCounter_Hz() / 1000000u;
+    return (uint32_t)(cycles / (per_us ? per_us : 1));
+}
+
+void Profile_Init(void)
+{
+    HAL_CycleCounter_Init();
+    Profile_Reset();
+}
+
+void Profile_Reset(void)
+{
+    memset(s_stats, 0, sizeof(s_stats));
+    for (int i = 0; i < PROF_STAGE_COUNT; i++)
+    {
+        s_stats[i].min_cycles = UINT32_MAX;
+    }
+}
+
+void Profile_Begin(ProfileStage_t stage)
+{
+    s_start[stage] = HAL_CycleCounter_Read();
+}
+
+void Profile_End(ProfileStage_t stage)
+{
+    // 无符号相减，计数器回绕一次仍然正确
+    uint32_t cycles = HAL_CycleCounter_Read() - s_start[stage];
+    ProfileStats_t* st = &s_stats[stage];
+    uint8_t bucket = cycles_to_bucket(cycles);
+
+    st->count++;
+    st->total_cycles += cycles;
+    if (cycles < st->min_cycles) st->min_cycles = cycles;
+    if (cycles > st->max_cycles) st->max_cycles = cycles;
+    if (st->hist[bucket] != UINT16_MAX)
+    {
+        st->hist[bucket]++;
+    }
+}
+
+const ProfileStats_t* Profile_Get_Stats(ProfileStage_t stage)
+{
+    return &s_stats[stage];
+}
+
+/**
+ * @brief  判断是否到了定期报告的时刻
+ * @return 1: 距上次报告已超过 PROFILE_REPORT_INTERVAL_MS
+ */
+uint8_t Profile_Report_Due(uint32_t now_ms)
+{
+    if ((uint32_t)(now_ms - s_last_report_ms) < PROFILE_REPORT_INTERVAL_MS)
+    {
+        return 0;
+    }
+    s_last_report_ms = now_ms;
+    return 1;
+}
+
+/**
+ * @brief  经 printf(USART2) 打印各阶段统计与非空的直方图桶
+ */
+void Profile_Print_Report(void)
+{
+    printf("PROFILE: stage     count    min_us   mean_us    max_us  hist(log2 cycles:n)\r\n");
+    for (int i = 0; i < PROF_STAGE_COUNT; i++)
+    {
+        const ProfileStats_t* st = &s_stats[i];
+        if (st->count == 0)
+        {
+            printf("PROFILE: %-8s       0\r\n", s_stage_name[i]);
+            continue;
+        }
+        printf("PROFILE: %-8s %7lu %9lu %9lu %9lu ", s_stage_name[i], (unsigned long)st->count,
+               (unsigned long)cycles_to_us(st->min_cycles),
+               (unsigned long)cycles_to_us(st->total_cycles / st->count),
+               (unsigned long)cycles_to_us(st->max_cycles));
+        for (int b = 0; b < PROFILE_HIST_BUCKETS; b++)
+        {
+            if (st->hist[b] != 0)
+            {
+                printf(" %d:%u", b, (unsigned)st->hist[b]);
+            }
+        }
+        printf("\r\n");
+    }
+}
+
+/**
+ * @brief  写出 loop_profile 属性值的各成员：每阶段的平均与最大耗时(us)
+ */
+void Profile_Write_Json(JsonStream_t* w)
+{
+    char key[24];
+
+    for (int i = 0; i < PROF_STAGE_COUNT; i++)
+    {
+        const ProfileStats_t* st = &s_stats[i];
+        uint32_t mean = st->count ? cycles_to_us(st->total_cycles / st->count) : 0;
+
+        snprintf(key, sizeof(key), "%s_mean_us", s_stage_name[i]);
+        JsonStream_Uint(w, key, mean);
+        snprintf(key, sizeof(key), "%s_max_us", s_stage_name[i]);
+        JsonStream_Uint(w, key, cycles_to_us(st->max_cycles));
+    }
+}
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ ******************************************************************************
+ * @ 名称  主循环分阶段性能统计
+ * @ 描述  用 DWT CYCCNT (经 HAL_CycleCounter_*) 测量主循环各阶段的耗时，
+ *         在 RAM 中保存每阶段的最小/最大/平均周期数和以 2 为底的对数直方图，
+ *         定期经 USART2 打印，并作为 loop_profile 属性上报 OneNET。
+ * @ 注意  仅在 PROFILE_ENABLE=1 (make PROFILE=1) 时编译，发布版本中
+ *         PROFILE_BEGIN/PROFILE_END 展开为空语句，本模块不占用任何代码和 RAM。
+ ******************************************************************************
+ */
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include <stdint.h>
+
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE                0
+#endif
+
+#define PROFILE_HIST_BUCKETS          32        // 第 i 桶统计 [2^i, 2^(i+1)) 个周期的样本
+#define PROFILE_REPORT_INTERVAL_MS    60000     // 串口打印与 MQTT 上报的周期
+
+// 被测阶段
+typedef enum {
+    PROF_STAGE_LOOP,        // 整个 App_Loop
+    PROF_STAGE_SENSE,       // read_all_environmental_data
+    PROF_STAGE_ANALYZE,     // Analyze_Inversion_Layer
+    PROF_STAGE_DECIDE,      // Intervention_FSM_Update (内含 Determine_Optimal_Intervention)
+    PROF_STAGE_ACTUATE,     // 功率计算与执行器输出
+    PROF_STAGE_PUBLISH,     // MQTT_Publish_All_Data_Adapt
+    PROF_STAGE_DISPLAY,     // Display_All_Data
+    PROF_STAGE_COUNT
+} ProfileStage_t;
+
+#if PROFILE_ENABLE
+
+#include "json_stream.h"
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint16_t hist[PROFILE_HIST_BUCKETS];    // 饱和计数
+} ProfileStats_t;
+
+void     Profile_Init(void);
+void     Profile_Reset(void);
+void     Profile_Begin(ProfileStage_t stage);
+void     Profile_End(ProfileStage_t stage);
+const ProfileStats_t* Profile_Get_Stats(ProfileStage_t stage);
+uint8_t  Profile_Report_Due(uint32_t now_ms);
+void     Profile_Print_Report(void);
+void     Profile_Write_Json(JsonStream_t* w);
+
+#define PROFILE_BEGIN(stage)   Profile_Begin(stage)
+#define PROFILE_END(stage)     Profile_End(stage)
+
+#else
+
+#define PROFILE_BEGIN(stage)   ((void)0)
+#define PROFILE_END(stage)     ((void)0)
+
+#endif
+
+#endif
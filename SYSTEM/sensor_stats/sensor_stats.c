@@ -0,0 +1,68 @@
+#include "sensor_stats.h"
+#include <math.h>
+#include <string.h>
+
+static void SensorStats_Reset(SensorStats_t* s, uint32_t now_ms)
+{
+    memset(s->acc, 0, sizeof(s->acc));
+    s->start_ms = now_ms;
+}
+
+void SensorStats_Init(SensorStats_t* s, uint32_t window_ms, uint32_t now_ms)
+{
+    memset(s, 0, sizeof(*s));
+    s->window_ms = window_ms;
+    SensorStats_Reset(s, now_ms);
+}
+
+/**
+ * @brief  Welford 更新：mean += d/n，M2 += d*(x - 新 mean)
+ * @note   与先求和再求平方和的做法相比，温度在 0°C 附近小幅波动时不会因相减而丢失精度
+ */
+void SensorStats_Add(SensorStats_t* s, SensorStats_Channel_t ch, float x)
+{
+    if (ch >= STATS_CH_COUNT || !isfinite(x))
+    {
+        return;
+    }
+
+    SensorStats_Acc_t* a = &s->acc[ch];
+    if (a->n == 0)
+    {
+        a->min = x;
+        a->max = x;
+    }
+    else
+    {
+        if (x < a->min) a->min = x;
+        if (x > a->max) a->max = x;
+    }
+    a->n++;
+    float d = x - a->mean;
+    a->mean += d / (float)a->n;
+    a->m2 += d * (x - a->mean);
+}
+
+bool SensorStats_Close_If_Due(SensorStats_t* s, uint32_t now_ms)
+{
+    if (now_ms - s->start_ms < s->window_ms)
+    {
+        return false;
+    }
+
+    s->last.seq++;
+    s->last.duration_ms = now_ms - s->start_ms;
+    for (int i = 0; i < STATS_CH_COUNT; i++)
+    {
+        const SensorStats_Acc_t* a = &s->acc[i];
+        SensorStats_Summary_t* out = &s->last.ch[i];
+
+        out->n = (a->n > UINT16_MAX) ? UINT16_MAX : (uint16_t)a->n;
+        out->min = a->min;
+        out->max = a->max;
+        out->mean = a->mean;
+        out->stddev = (a->n > 1) ? sqrtf(a->m2 / (float)(a->n - 1)) : 0.0f;
+    }
+    SensorStats_Reset(s, now_ms);
+    return true;
+}
@@ -0,0 +1,71 @@
+/**
+ ******************************************************************************
+ * @ 名称  传感器窗口统计
+ * @ 描述  对温度、湿度、风速各通道用 Welford 算法流式累计样本数、最小/最大值、均值与 M2，
+ *         每个固定时长的窗口结束时生成一份摘要 (含标准差) 并清零重新累计。
+ *         控制环路可以按任意频率采样，上报只发送窗口摘要，上行流量只取决于窗口长度。
+ * @ 注意  每个样本只需一次除法与少量乘加，不保存样本本身，RAM 占用与采样率无关。
+ ******************************************************************************
+ */
+#ifndef __SENSOR_STATS_H
+#define __SENSOR_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 窗口长度：每个窗口结束时上报一次摘要，可在编译时用 -DSENSOR_STATS_WINDOW_MS=... 覆盖
+#ifndef SENSOR_STATS_WINDOW_MS
+#define SENSOR_STATS_WINDOW_MS      60000
+#endif
+
+// 统计通道
+typedef enum {
+    STATS_CH_TEMP1,
+    STATS_CH_TEMP2,
+    STATS_CH_TEMP3,
+    STATS_CH_TEMP4,
+    STATS_CH_AMBIENT,
+    STATS_CH_HUMIDITY,
+    STATS_CH_WIND,
+    STATS_CH_COUNT
+} SensorStats_Channel_t;
+
+// 单个通道的流式累计量
+typedef struct {
+    uint32_t n;
+    float    mean;
+    float    m2;                // 与均值之差的平方和
+    float    min;
+    float    max;
+} SensorStats_Acc_t;
+
+// 单个通道在一个窗口内的摘要，n 为 0 时其余字段无意义
+typedef struct {
+    uint16_t n;
+    float    min;
+    float    max;
+    float    mean;
+    float    stddev;            // 样本标准差，n < 2 时为 0
+} SensorStats_Summary_t;
+
+// 一个已结束窗口的全部摘要
+typedef struct {
+    uint32_t seq;               // 窗口序号，从 1 开始
+    uint32_t duration_ms;
+    SensorStats_Summary_t ch[STATS_CH_COUNT];
+} SensorWindow_t;
+
+typedef struct {
+    SensorStats_Acc_t acc[STATS_CH_COUNT];
+    uint32_t window_ms;
+    uint32_t start_ms;
+    SensorWindow_t last;        // 最近一个已结束窗口，last.seq 为 0 表示还没有
+} SensorStats_t;
+
+void SensorStats_Init(SensorStats_t* s, uint32_t window_ms, uint32_t now_ms);
+// 加入一个样本，非有限值 (传感器失效) 被忽略
+void SensorStats_Add(SensorStats_t* s, SensorStats_Channel_t ch, float x);
+// 窗口到期时生成摘要写入 s->last 并开始新窗口，返回 true
+bool SensorStats_Close_If_Due(SensorStats_t* s, uint32_t now_ms);
+
+#endif
@@ -1,5 +1,5 @@
 #include "simulation_model.h"
-#include "stdlib.h"
+#include "hal.h"
 // 模拟参数 (在报告中要说明这些是为了演示而加速的)
 #define SIM_NATURAL_COOLING      -0.02f
 #define SIM_NATURAL_EFFECT       +0.025f
@@ -11,32 +11,59 @@
 
 
 
-void TIM4_MainTick_Init(u16 period_ms)
+uint8_t en_count;//模拟实现时间计数器
+uint8_t en_count_flag;//模拟时间计数器标志位
+uint8_t g_simulation_tick_flag = 0;
+
+// 模型默认使用的随机数发生器 (板上演示路径)
+static SimRng_t s_sim_rng = { SIM_DEFAULT_SEED };
+
+// 仿真节拍：每个周期最多推进一次环境模型，由主循环消费后再放行下一拍
+static void Sim_Tick_Handler(void)
 {
-    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
-    NVIC_InitTypeDef NVIC_InitStructure;
+    if(en_count_flag == 0)
+    {
+        g_simulation_tick_flag = 1;
+        en_count++;
+        en_count_flag = 1;
+    }
+}
 
-    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM4, ENABLE);
+void TIM4_MainTick_Init(u16 period_ms)
+{
+    HAL_Timer_StartPeriodic(HAL_TIMER_SIM_TICK, period_ms, Sim_Tick_Handler);
+}
 
-    TIM_TimeBaseStructure.TIM_Period = period_ms - 1;
-    TIM_TimeBaseStructure.TIM_Prescaler = 36000 - 1; 
-    TIM_TimeBaseStructure.TIM_ClockDivision = 0;
-    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
-    TIM_TimeBaseInit(TIM4, &TIM_TimeBaseStructure);
+/**
+ * @brief  xorshift32 伪随机数发生器，序列只由种子决定，与平台的 rand() 实现无关
+ */
+void Sim_Rng_Seed(SimRng_t* rng, uint32_t seed)
+{
+    // xorshift 的状态不能为 0
+    rng->state = (seed != 0) ? seed : SIM_DEFAULT_SEED;
+}
 
-    
-    TIM_ITConfig(TIM4, TIM_IT_Update, ENABLE);
+uint32_t Sim_Rng_Next(SimRng_t* rng)
+{
+    uint32_t x = rng->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng->state = x;
+    return x;
+}
 
-    
-    NVIC_InitStructure.NVIC_IRQChannel = TIM4_IRQn;
-    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1; // 优先级可以根据需要调整
-    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
-    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-    NVIC_Init(&NVIC_InitStructure);
+// 返回 [0, 1) 区间的均匀分布随机数
+float Sim_Rng_Uniform(SimRng_t* rng)
+{
+    return (Sim_Rng_Next(rng) >> 8) * (1.0f / 16777216.0f);
+}
 
-    
-    TIM_Cmd(TIM4, ENABLE);
+void Sim_Seed(uint32_t seed)
+{
+    Sim_Rng_Seed(&s_sim_rng, seed);
 }
+
 // 辅助函数，根据高度值(米)返回最接近的传感器数组索引
 // 确保这个函数与你的SENSOR_HEIGHTS定义匹配
 static int get_index_from_height(float height)
@@ -47,30 +74,34 @@ static int get_index_from_height(float height)
     return 3;
 }
 
+/**
+ * @brief  自然降温/回暖：所有高度叠加相同的温度变化量和随机干扰
+ */
+void Sim_Apply_Natural(EnvironmentalData_t* env_data, float delta, SimRng_t* rng)
+{
+    for (int i = 0; i < 4; i++) 
+    {
+        //计算随机干扰
+        float random_disturbance = (Sim_Rng_Uniform(rng) - 0.5f) * SIM_DISTURBANCE_MAGNITUDE;
+        env_data->temperatures[i] += delta + random_disturbance;
+    }
+}
+
+// 板上演示：用 en_count 划分降温段(0~5拍)与回暖段(6~8拍)
 void Sim_Update_Environment(EnvironmentalData_t* env_data,InterventionPowers_t* powers)
 {
     if(en_count <= 8)
     {
-        if(en_count <= 5)
-        {
-            for (int i = 0; i < 4; i++) 
-            {
-                //计算随机干扰
-                float random_disturbance = ((float)rand() / RAND_MAX - 0.5f) * SIM_DISTURBANCE_MAGNITUDE;
-                env_data->temperatures[i] += SIM_NATURAL_COOLING + random_disturbance;
-            }
-        }
-        else if(en_count > 5)
-        {
-            for (int i = 0; i < 4; i++) 
-            {
-                // 计算随机干扰
-                float random_disturbance = ((float)rand() / RAND_MAX - 0.5f) * SIM_DISTURBANCE_MAGNITUDE;
-                env_data->temperatures[i] += SIM_NATURAL_EFFECT + random_disturbance;
-            }
-        }
+        Sim_Apply_Natural(env_data, (en_count <= 5) ? SIM_NATURAL_COOLING : SIM_NATURAL_EFFECT, &s_sim_rng);
     }
+    Sim_Apply_Interventions(env_data, powers);
+}
 
+/**
+ * @brief  执行器对温度廓线的作用：风扇混合逆温层、加热器整体抬升、洒水稳定近地面温度
+ */
+void Sim_Apply_Interventions(EnvironmentalData_t* env_data, const InterventionPowers_t* powers)
+{
     //模拟风扇打破逆温层的效果 
  if (powers->fan_power > 0) 
     {
@@ -7,7 +7,24 @@
 
 
 extern uint8_t en_count;//模拟实现时间计数器
+extern uint8_t en_count_flag;//模拟时间计数器标志位
+extern uint8_t g_simulation_tick_flag;//仿真节拍到达标志
+#define SIM_DEFAULT_SEED  0x2545F491u   // 默认随机种子，保证每次上电的仿真过程可复现
+
+// 可设种子的伪随机数发生器，每个调用者持有自己的状态，可在多线程中并行使用
+typedef struct {
+    uint32_t state;
+} SimRng_t;
+
+void     Sim_Rng_Seed(SimRng_t* rng, uint32_t seed);
+uint32_t Sim_Rng_Next(SimRng_t* rng);
+float    Sim_Rng_Uniform(SimRng_t* rng);
+void     Sim_Seed(uint32_t seed);
+
 // 根据自然降温和干预功率，更新整个环境的状态
 void Sim_Update_Environment(EnvironmentalData_t* env_data, InterventionPowers_t* powers);
+// 模型的两个组成部分，供主机回放工具直接驱动
+void Sim_Apply_Natural(EnvironmentalData_t* env_data, float delta, SimRng_t* rng);
+void Sim_Apply_Interventions(EnvironmentalData_t* env_data, const InterventionPowers_t* powers);
 void TIM4_MainTick_Init(u16 period_ms);
 #endif
\ No newline at end of file
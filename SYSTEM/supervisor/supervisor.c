@@ -0,0 +1,185 @@
+#include "supervisor.h"
+#include "hal.h"
+#include "delay.h"
+#include <stdio.h>
+
+static const char* const s_task_name[SUP_TASK_COUNT] = { "comms", "sense", "control", "display", "alarm" };
+
+/* 顺序与 Sup_Task_t 一致 */
+static const uint16_t s_timeout_ms[SUP_TASK_COUNT] = {
+    SUP_TASK_TIMEOUT_MS,
+    SUP_TASK_TIMEOUT_MS,
+    SUP_TASK_TIMEOUT_MS,
+    SUP_TASK_TIMEOUT_MS,
+    SUP_ALARM_TIMEOUT_MS,
+};
+
+/* 顺序与 HAL_ResetCause_t 一致 */
+static const char* const s_cause_name[HAL_RESET_CAUSE_COUNT] = {
+    "unknown", "power-on", "pin", "software", "iwdg", "wwdg", "low-power"
+};
+
+static volatile uint32_t s_last_beat[SUP_TASK_COUNT];
+static volatile uint8_t  s_last_task = 0xFF;    // 最后报到的主循环任务
+static uint32_t s_last_tick_ms;
+static uint8_t  s_tripped;                       // 已记录超时，不再喂 IWDG
+static volatile uint8_t s_suspended;             // 主循环处于已知的长时间阻塞操作中
+
+/**
+ * @brief  备份寄存器中的任务编码 (0 无，1~SUP_TASK_COUNT 任务，SUP_TASK_WWDG 节拍) 转为名称
+ */
+static const char* Task_Code_Name(uint8_t code)
+{
+    if (code == 0)
+    {
+        return "none";
+    }
+    if (code == SUP_TASK_WWDG)
+    {
+        return "tick";
+    }
+    return (code <= SUP_TASK_COUNT) ? s_task_name[code - 1] : "?";
+}
+
+static uint8_t Last_Task_Code(void)
+{
+    uint8_t last = s_last_task;
+    return (last < SUP_TASK_COUNT) ? (uint8_t)(last + 1) : 0;
+}
+
+static void Latch(uint8_t missed_code, uint32_t silent_ms)
+{
+    HAL_BKP_Write(SUP_BKP_MISS_REG, (uint16_t)((Last_Task_Code() << 8) | missed_code));
+    HAL_BKP_Write(SUP_BKP_SILENT_REG, (uint16_t)(silent_ms > 0xFFFF ? 0xFFFF : silent_ms));
+}
+
+/**
+ * @brief  WWDG 提前唤醒 (中断上下文)：10ms 节拍已停止约 57ms，复位前记录现场
+ */
+static void Supervisor_Wwdg_Early_Wakeup(void)
+{
+    Latch(SUP_TASK_WWDG, (uint32_t)System_GetTimeMs() - s_last_tick_ms);
+}
+
+/**
+ * @brief  10ms 检查节拍 (中断上下文)：先喂 WWDG，再检查各任务，全部按时才喂 IWDG
+ * @note   暂停期间主循环任务按 SUP_SUSPEND_MAX_MS 检查，中断中的任务不受影响
+ */
+static void Supervisor_Tick(void)
+{
+    uint32_t now = (uint32_t)System_GetTimeMs();
+
+    s_last_tick_ms = now;
+    HAL_WWDG_Feed();
+    if (s_tripped)
+    {
+        return;
+    }
+    for (int i = 0; i < SUP_TASK_COUNT; i++)
+    {
+        uint32_t silent = now - s_last_beat[i];
+        uint32_t limit = (s_suspended && i < SUP_TASK_FIRST_ISR) ? SUP_SUSPEND_MAX_MS : s_timeout_ms[i];
+
+        if (silent > limit)
+        {
+            Latch((uint8_t)(i + 1), silent);
+            s_tripped = 1;
+            return;
+        }
+    }
+    HAL_IWDG_Feed();
+}
+
+void Supervisor_Init(void)
+{
+    HAL_ResetCause_t cause = HAL_Reset_Cause();
+    uint16_t history, boots, miss;
+
+    if (HAL_BKP_Read(SUP_BKP_MAGIC_REG) != SUP_BKP_MAGIC)
+    {
+        // VBAT 掉电或首次上电：备份域内容无效
+        HAL_BKP_Write(SUP_BKP_MAGIC_REG, SUP_BKP_MAGIC);
+        HAL_BKP_Write(SUP_BKP_HISTORY_REG, 0);
+        HAL_BKP_Write(SUP_BKP_BOOTS_REG, 0);
+        HAL_BKP_Write(SUP_BKP_MISS_REG, 0);
+        HAL_BKP_Write(SUP_BKP_SILENT_REG, 0);
+    }
+    history = (uint16_t)((HAL_BKP_Read(SUP_BKP_HISTORY_REG) << 4) | cause);
+    boots = (uint16_t)(HAL_BKP_Read(SUP_BKP_BOOTS_REG) + 1);
+    HAL_BKP_Write(SUP_BKP_HISTORY_REG, history);
+    HAL_BKP_Write(SUP_BKP_BOOTS_REG, boots);
+
+    printf("INFO: reset cause %s, boot %u, history", s_cause_name[cause], boots);
+    for (int i = 0; i < 4; i++)
+    {
+        uint8_t c = (history >> (4 * i)) & 0x0F;
+        printf(" %s", (c != 0 && c < HAL_RESET_CAUSE_COUNT) ? s_cause_name[c] : "-");
+    }
+    printf("\r\n");
+
+    miss = HAL_BKP_Read(SUP_BKP_MISS_REG);
+    if (cause == HAL_RESET_IWDG || cause == HAL_RESET_WWDG)
+    {
+        if (miss != 0)
+        {
+            printf("WARN: %s reset: '%s' missed its heartbeat (silent %u ms), last check-in '%s'\r\n",
+                   s_cause_name[cause], Task_Code_Name(miss & 0xFF), HAL_BKP_Read(SUP_BKP_SILENT_REG),
+                   Task_Code_Name(miss >> 8));
+        }
+        else
+        {
+            printf("WARN: %s reset without a latched heartbeat miss\r\n", s_cause_name[cause]);
+        }
+    }
+    // 现场只报告一次，复位原因保留在历史中
+    HAL_BKP_Write(SUP_BKP_MISS_REG, 0);
+    HAL_BKP_Write(SUP_BKP_SILENT_REG, 0);
+}
+
+void Supervisor_Start(void)
+{
+    uint32_t now = (uint32_t)System_GetTimeMs();
+
+    for (int i = 0; i < SUP_TASK_COUNT; i++)
+    {
+        s_last_beat[i] = now;
+    }
+    s_last_tick_ms = now;
+    s_tripped = 0;
+    s_suspended = 0;
+
+    HAL_IWDG_Start(SUP_IWDG_TIMEOUT_MS);
+    HAL_WWDG_Start(SUP_WWDG_WINDOW, SUP_WWDG_IRQ_PRIORITY, Supervisor_Wwdg_Early_Wakeup);
+    HAL_Timer_StartPeriodic(HAL_TIMER_SUPERVISOR, SUP_TICK_MS * 2, Supervisor_Tick);
+    printf("INFO: supervisor started, task timeout %u ms, IWDG %u ms\r\n", SUP_TASK_TIMEOUT_MS, SUP_IWDG_TIMEOUT_MS);
+}
+
+void Supervisor_Beat(Sup_Task_t task)
+{
+    if (task >= SUP_TASK_COUNT)
+    {
+        return;
+    }
+    s_last_beat[task] = (uint32_t)System_GetTimeMs();
+    if (task < SUP_TASK_FIRST_ISR)
+    {
+        s_last_task = (uint8_t)task;
+    }
+}
+
+void Supervisor_Suspend(void)
+{
+    s_suspended = 1;
+}
+
+void Supervisor_Resume(void)
+{
+    uint32_t now = (uint32_t)System_GetTimeMs();
+
+    // 先刷新报到时间再解除暂停，节拍中断不会看到旧的报到时间
+    for (int i = 0; i < SUP_TASK_FIRST_ISR; i++)
+    {
+        s_last_beat[i] = now;
+    }
+    s_suspended = 0;
+}
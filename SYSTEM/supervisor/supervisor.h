@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * @ 名称  看门狗监督
+ * @ 描述  主循环各阶段与告警节拍按时调用 Supervisor_Beat() 报到，TIM5 每 10ms 检查一次：
+ *         全部任务都在各自的超时内报到过才喂独立看门狗 (IWDG)，任一任务超时即停止喂狗，
+ *         并把超时的任务、最后报到的任务与静默时长写入备份寄存器，约 SUP_IWDG_TIMEOUT_MS 后复位。
+ *         窗口看门狗 (WWDG) 由同一个 10ms 节拍在窗口内喂，节拍停止 (卡在更高优先级中断或关中断)
+ *         约 58ms 即复位，提前唤醒中断记录最后报到的任务。
+ *         复位后 Supervisor_Init() 读取复位原因，写入备份寄存器中的复位历史并在串口报告。
+ * @ 注意  主循环卡死后的恢复时间不超过 任务超时 (SUP_TASK_TIMEOUT_MS) + 10ms + IWDG 超时
+ *         (LSI 偏差下最长约 2.7s)，即约 13s。
+ *         已知会超过任务超时的阻塞操作 (经调试串口导出 Flash 日志约 23s) 前后调用
+ *         Supervisor_Suspend()/Supervisor_Resume()：期间主循环任务的超时放宽到 SUP_SUSPEND_MAX_MS，
+ *         告警节拍与 WWDG 照常监督。
+ *         WWDG 最长约 58ms，无法覆盖一整轮主循环 (AT 等待最长数秒)，只用于监督 10ms 节拍。
+ ******************************************************************************
+ */
+#ifndef __SUPERVISOR_H
+#define __SUPERVISOR_H
+
+#include <stdint.h>
+
+#define SUP_TICK_MS             10
+#define SUP_TASK_TIMEOUT_MS     10000   // 主循环任务：一轮上报 (多条 AT 指令，每条最长等待 1~2s) 远小于此值
+#define SUP_SUSPEND_MAX_MS      60000   // 暂停期间主循环任务的超时，卡死在阻塞操作中仍会复位
+#define SUP_ALARM_TIMEOUT_MS    100     // 告警节拍 10ms 一次
+#define SUP_IWDG_TIMEOUT_MS     2000
+// 擦除一页片内 Flash 时 CPU 取指停顿 20~40ms，中断也无法响应，这段时间计入 58ms 中，WWDG 只剩几毫秒余量：
+// Flash 日志只在模组空闲时预擦除 (FlashLog_Poll)，不得在中断中或连续擦除多页
+#define SUP_WWDG_WINDOW         0x77    // 喂狗后约 8ms 才打开窗口，节拍过快 (时钟配置错误) 同样复位
+#define SUP_WWDG_IRQ_PRIORITY   0       // 提前唤醒的抢占优先级高于所有应用中断 (TIM5 节拍为 1)
+
+// 备份寄存器分配
+#define SUP_BKP_MAGIC_REG       1       // SUP_BKP_MAGIC：其余寄存器有效
+#define SUP_BKP_HISTORY_REG     2       // 最近 4 次复位原因，每个 4 位，最新的在低 4 位
+#define SUP_BKP_BOOTS_REG       3       // 启动次数
+#define SUP_BKP_MISS_REG        4       // 低字节：超时任务 + 1，高字节：最后报到的任务 + 1 (0 表示无)
+#define SUP_BKP_SILENT_REG      5       // 超时任务的静默时长 (ms，上限 65535)
+#define SUP_BKP_MAGIC           0x5A17
+
+// 被监督的任务
+typedef enum {
+    SUP_TASK_COMMS,         // Handle_Serial_Reception：下行命令与连接状态机
+    SUP_TASK_SENSE,         // 传感器读取
+    SUP_TASK_CONTROL,       // 决策与执行器输出
+    SUP_TASK_DISPLAY,       // 上报与屏幕刷新 (一轮的末尾)
+    SUP_TASK_ALARM,         // 告警引擎的 TIM7 节拍
+    SUP_TASK_COUNT
+} Sup_Task_t;
+
+#define SUP_TASK_FIRST_ISR      SUP_TASK_ALARM  // 此后为中断中的任务，不计入 "最后报到的任务"
+
+#define SUP_TASK_WWDG           0xFE    // SUP_BKP_MISS_REG 中表示窗口看门狗 (10ms 节拍停止)
+
+// 读取并记录复位原因，报告上一次看门狗复位的现场；在 App_Setup 开头、调试串口 (USART2) 初始化之后调用一次
+void Supervisor_Init(void);
+// 启动两个看门狗与 10ms 检查节拍；此前未报到的任务从此刻开始计时
+void Supervisor_Start(void);
+// 任务报到 (可在中断中调用)
+void Supervisor_Beat(Sup_Task_t task);
+// 主循环进入/结束一段已知的长时间阻塞操作；Resume 时所有主循环任务视为刚刚报到，不可嵌套
+void Supervisor_Suspend(void);
+void Supervisor_Resume(void);
+
+#endif
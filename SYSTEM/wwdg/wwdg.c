@@ -9,13 +9,16 @@
  */
 #include "wwdg.h"
 
+static void (*s_ewi_hook)(void);
+
 //初始化窗口看门狗 	
 //tr   :T[6:0],计数器值 
 //wr   :W[6:0],窗口值 
 //fprer:分频系数（WDGTB）,仅最低2位有效 
 //Fwwdg=PCLK1/(4096*2^fprer). 
+//prio :提前唤醒中断的抢占优先级 (组2，0~3)
 
-void WWDG_Init(uint8_t tr,uint8_t wr,uint32_t fprer)
+void WWDG_Init(uint8_t tr,uint8_t wr,uint32_t fprer,uint8_t prio)
 { 
 	RCC_APB1PeriphClockCmd(RCC_APB1Periph_WWDG, ENABLE);  //   WWDG时钟使能
 
@@ -27,7 +30,7 @@ void WWDG_Init(uint8_t tr,uint8_t wr,uint32_t fprer)
 
 	WWDG_ClearFlag();//清除提前唤醒中断标志位 
 
-	WWDG_NVIC_Init();//初始化窗口看门狗 NVIC
+	WWDG_NVIC_Init(prio);//初始化窗口看门狗 NVIC
 
 	WWDG_EnableIT(); //开启窗口看门狗中断
 } 
@@ -37,19 +40,29 @@ void WWDG_Set_Counter(uint8_t cnt)
     WWDG_Enable(cnt);//使能看门狗 ,	设置 counter .	 
 }
 //窗口看门狗中断服务程序
-void WWDG_NVIC_Init()
+void WWDG_NVIC_Init(uint8_t prio)
 {
 	NVIC_InitTypeDef NVIC_InitStructure;
 	NVIC_InitStructure.NVIC_IRQChannel = WWDG_IRQn;    //WWDG中断
-	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;   //抢占2，子优先级3，组2	
-	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 3;	 //抢占2，子优先级3，组2	
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = prio;   //抢占由调用者指定，组2
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;	 //子优先级0
     NVIC_InitStructure.NVIC_IRQChannelCmd=ENABLE; 
 	NVIC_Init(&NVIC_InitStructure);//NVIC初始化
 }
 
-void WWDG_IRQHandler(void)
+//提前唤醒回调：复位前约一个计数周期调用，用于把现场写入备份寄存器
+void WWDG_Set_EarlyWakeup_Hook(void (*hook)(void))
 {
-	WWDG_SetCounter(WWDG_CNT);	  //当禁掉此句后,窗口看门狗将产生复位
+	s_ewi_hook = hook;
+}
 
+//提前唤醒中断：只记录现场，不再在这里重装计数器，否则窗口看门狗永远不会复位
+void WWDG_IRQHandler(void)
+{
 	WWDG_ClearFlag();	  //清除中断标志位
+
+	if (s_ewi_hook != 0)
+	{
+		s_ewi_hook();
+	}
 }
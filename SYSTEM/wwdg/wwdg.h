@@ -20,11 +20,14 @@
 //wr   :W[6:0],窗口值 
 //fprer:分频系数（WDGTB）,仅最低2位有效 
 //Fwwdg=PCLK1/(4096*2^fprer). 
-void WWDG_Init(uint8_t tr,uint8_t wr,uint32_t fprer);
+//prio :提前唤醒中断的抢占优先级 (组2，0~3)
+void WWDG_Init(uint8_t tr,uint8_t wr,uint32_t fprer,uint8_t prio);
 //重设置WWDG计数器的值
 void WWDG_Set_Counter(uint8_t cnt);
 //窗口看门狗中断服务程序
-void WWDG_NVIC_Init();
+void WWDG_NVIC_Init(uint8_t prio);
+//提前唤醒回调 (中断上下文)
+void WWDG_Set_EarlyWakeup_Hook(void (*hook)(void));
 
 
 #endif
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+片内 Flash 样本日志导出解码器
+
+在 USART2 上发送 "log export" 后，固件输出一行 LOG-EXPORT BEGIN、按页序号从旧到新的原始日志页和
+一行带 CRC 的 LOG-EXPORT END。本脚本从串口抓取文件中找出这一段，校验 CRC、逐页校验页头与记录，
+输出 CSV。格式定义以 SYSTEM/flash_log/flash_log.h 为准，两处需同步修改。
+
+用法:
+    python3 TOOLS/flash_log/decode_flash_log.py capture.bin > season.csv
+    python3 TOOLS/flash_log/decode_flash_log.py --summary capture.bin
+"""
+import argparse
+import binascii
+import csv
+import re
+import struct
+import sys
+
+MAGIC = 0x31474C46
+HEADER = struct.Struct("<IIH4sH")
+RECORD = struct.Struct("<I5hHHBBH")
+INVALID_I16 = -32768
+INVALID_U16 = 0xFFFF
+assert HEADER.size == 16 and RECORD.size == 22
+
+METHODS = ["none", "sprinklers", "fans", "heaters", "fans+heaters"]
+FIELDS = ["page_seq", "boot", "uptime_s", "temp1", "temp2", "temp3", "temp4", "ambient_temp",
+          "humidity", "wind_speed", "method", "crop_stage"]
+
+
+class DecodeError(ValueError):
+    pass
+
+
+def crc16(data, crc=0xFFFF):
+    # CRC-16/CCITT-FALSE，与固件 FlashLog_Crc16 相同
+    return binascii.crc_hqx(data, crc)
+
+
+def extract(blob):
+    """返回 (页大小, 记录长度, 原始页字节)"""
+    begin = re.search(rb"LOG-EXPORT BEGIN pages=(\d+) page_size=(\d+) record_size=(\d+)\r\n", blob)
+    if begin is None:
+        raise DecodeError("LOG-EXPORT BEGIN line not found")
+    pages, page_size, record_size = (int(x) for x in begin.groups())
+    if record_size != RECORD.size:
+        raise DecodeError("record size %d, this decoder expects %d" % (record_size, RECORD.size))
+    start = begin.end()
+    raw = blob[start:start + pages * page_size]
+    end = re.match(rb"\r\nLOG-EXPORT END crc=([0-9A-F]{4})\r\n", blob[start + len(raw):])
+    if len(raw) != pages * page_size or end is None:
+        raise DecodeError("export truncated: %d of %d page bytes" % (len(raw), pages * page_size))
+    if crc16(raw) != int(end.group(1), 16):
+        raise DecodeError("export CRC mismatch")
+    return page_size, raw
+
+
+def records(page_size, raw, stats):
+    per_page = (page_size - HEADER.size) // RECORD.size
+    for base in range(0, len(raw), page_size):
+        page = raw[base:base + page_size]
+        magic, seq, rec_size, _, hcrc = HEADER.unpack_from(page)
+        if magic != MAGIC or rec_size != RECORD.size or crc16(page[:14]) != hcrc:
+            stats["bad_pages"] += 1
+            continue
+        stats["pages"] += 1
+        for i in range(per_page):
+            off = HEADER.size + i * RECORD.size
+            rec = page[off:off + RECORD.size]
+            if rec == b"\xff" * RECORD.size:
+                break
+            fields = RECORD.unpack(rec)
+            if crc16(rec[:20]) != fields[-1]:
+                stats["torn"] += 1
+                continue
+            stats["records"] += 1
+            yield seq, fields
+
+
+def row(seq, fields):
+    stamp, t1, t2, t3, t4, amb, hum, wind, method, stage, _ = fields
+
+    def centi(v):
+        return "" if v == INVALID_I16 else "%.2f" % (v / 100.0)
+
+    return {
+        "page_seq": seq,
+        "boot": stamp >> 24,
+        "uptime_s": stamp & 0xFFFFFF,
+        "temp1": centi(t1),
+        "temp2": centi(t2),
+        "temp3": centi(t3),
+        "temp4": centi(t4),
+        "ambient_temp": centi(amb),
+        "humidity": "" if hum == INVALID_U16 else "%.1f" % (hum / 10.0),
+        "wind_speed": "" if wind == INVALID_U16 else "%.2f" % (wind / 100.0),
+        "method": METHODS[method] if method < len(METHODS) else str(method),
+        "crop_stage": stage,
+    }
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("capture", nargs="?", help="串口抓取文件，缺省时从标准输入读取")
+    ap.add_argument("--summary", action="store_true", help="只打印页数与记录数")
+    args = ap.parse_args()
+
+    blob = open(args.capture, "rb").read() if args.capture else sys.stdin.buffer.read()
+    try:
+        page_size, raw = extract(blob)
+    except DecodeError as e:
+        print("ERROR: %s" % e, file=sys.stderr)
+        return 1
+
+    stats = {"pages": 0, "bad_pages": 0, "records": 0, "torn": 0}
+    if args.summary:
+        for _ in records(page_size, raw, stats):
+            pass
+    else:
+        out = csv.DictWriter(sys.stdout, fieldnames=FIELDS)
+        out.writeheader()
+        for seq, fields in records(page_size, raw, stats):
+            out.writerow(row(seq, fields))
+    print("pages %(pages)d (%(bad_pages)d bad), records %(records)d (%(torn)d torn)" % stats, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
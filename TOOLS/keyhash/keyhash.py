@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""
+下行命令键名完美哈希表生成器
+
+onenet_mqtt.c 中的 DOWNLINK_KEY_* 表用 FNV-1a (可变初值) 把键名映射到 2 的幂大小的槽位，
+槽位取哈希值的高位 (FNV-1a 的低位只取决于输入的低位，区分度差)。
+物模型增加下行属性后，把新键名加入 KEYS，运行本脚本，把输出粘贴回 onenet_mqtt.c。
+
+用法: python3 TOOLS/keyhash/keyhash.py [--slots 16]
+"""
+import argparse
+
+KEYS = ["id", "crop_stage", "fan_power", "heater_power", "sprinkler_power", "pressure", "method"]
+
+FNV_PRIME = 16777619
+
+
+def fnv1a(key, seed):
+    h = seed
+    for c in key.encode():
+        h ^= c
+        h = (h * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def slot(key, seed, slots):
+    return fnv1a(key, seed) >> (32 - (slots.bit_length() - 1))
+
+
+def find_seed(keys, slots):
+    for seed in range(2166136261, 2166136261 + 1000000):
+        used = {slot(k, seed, slots) for k in keys}
+        if len(used) == len(keys):
+            return seed
+    raise SystemExit("no collision-free seed found, increase --slots")
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--slots", type=int, default=16)
+    args = ap.parse_args()
+    if args.slots & (args.slots - 1):
+        raise SystemExit("--slots must be a power of two")
+
+    seed = find_seed(KEYS, args.slots)
+    print("#define DOWNLINK_KEY_SLOTS      %d" % args.slots)
+    print("#define DOWNLINK_KEY_SHIFT      %d" % (32 - (args.slots.bit_length() - 1)))
+    print("#define DOWNLINK_KEY_HASH_SEED  %uu" % seed)
+    for k in sorted(KEYS, key=lambda k: slot(k, seed, args.slots)):
+        print("    [%2d] = \"%s\"" % (slot(k, seed, args.slots), k))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,350 @@
+/**
+ ******************************************************************************
+ * @ 名称  MQTT 层离线基准
+ * @ 描述  用法: mqtt_bench [--rounds N] [--minutes M] [--loop-ms L] [--publish-ms P] [--command-ms C]
+ *                          [--at-latency MS] [--net-latency MS] [--jitter MS] [--loss PCT]
+ *                          [--open-fail PCT] [--disconnect-every S] [--interleave] [--counted]
+ *                          [--fragment BYTES] [--seed S] [--verbose]
+ *         固件的 onenet_mqtt.c 原样运行在虚拟时钟上，USART1 另一端是 host_modem 仿真的模组与代理。
+ *         1) 连接：从 MQTT_Connection_Start() 到全部主题订阅完成的时间
+ *         2) 突发：连续 N 轮全量上报，统计代理侧的发布速率
+ *         3) 稳态：主循环每 L ms 一次，每 P ms 上报一轮，约每 C ms 由代理下发一条 property/set，
+ *            统计命令到执行 (g_device_status 生效) 与命令到回复的延迟，以及断线重连耗时；
+ *            回复按请求 id 匹配，穿插模式下多条命令同时在途也逐条计入
+ ******************************************************************************
+ */
+#include "onenet_mqtt.h"
+#include "UART_DISPLAY.h"
+#include "host_modem.h"
+#include "hal_host.h"
+#include "delay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MAX_SAMPLES   4096
+#define BENCH_SET_TOPIC     "$sys/" MQTT_PRODUCT_ID "/" MQTT_DEVICE_NAME "/thing/property/set"
+
+typedef struct {
+    uint32_t v[BENCH_MAX_SAMPLES];
+    uint32_t n;
+} Samples_t;
+
+static Samples_t s_actuation;       // 命令下发 -> 属性生效
+static Samples_t s_reply;           // 命令下发 -> 代理收到回复
+static Samples_t s_reconnect;       // 断线 -> 重新上线
+
+// 在途的命令按请求 id 记录：fan_power 目标值与下发时刻。穿插模式下回复可能晚于后面的命令，
+// 同时在途的命令超过 BENCH_MAX_PENDING 条时最早的一条被覆盖，不再计入
+#define BENCH_MAX_PENDING   64
+
+typedef struct {
+    uint32_t id;                // 0 表示空闲
+    int      target;
+    uint64_t sent_ms;
+    uint8_t  actuated;
+    uint8_t  replied;
+} BenchCommand_t;
+
+static BenchCommand_t s_pending[BENCH_MAX_PENDING];
+static uint32_t s_cmd_id;
+
+static void Pending_Retire(BenchCommand_t* c)
+{
+    if (c->actuated && c->replied)
+    {
+        c->id = 0;
+    }
+}
+
+static void Samples_Add(Samples_t* s, uint64_t v)
+{
+    if (s->n < BENCH_MAX_SAMPLES)
+    {
+        s->v[s->n++] = (uint32_t)v;
+    }
+}
+
+static int cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void Samples_Print(const char* name, Samples_t* s)
+{
+    if (s->n == 0)
+    {
+        fprintf(stderr, "  %-22s no samples\n", name);
+        return;
+    }
+    uint64_t sum = 0;
+    qsort(s->v, s->n, sizeof(s->v[0]), cmp_u32);
+    for (uint32_t i = 0; i < s->n; i++)
+    {
+        sum += s->v[i];
+    }
+    fprintf(stderr, "  %-22s n=%-5u min %5u  avg %7.1f  p50 %5u  p95 %5u  max %5u ms\n", name, s->n,
+            s->v[0], (double)sum / s->n, s->v[s->n / 2], s->v[(s->n * 95) / 100], s->v[s->n - 1]);
+}
+
+// 虚拟时间每推进 1ms 检查一次命令是否已生效。同一毫秒内连续执行的几条命令只能看到最后一条的值，
+// 命令按下发顺序执行，因此匹配到的这条之前尚未生效的命令也按此刻计 (上限)
+static void Bench_TickHook(uint64_t now_ms)
+{
+    uint32_t matched = 0;
+
+    for (int i = 0; i < BENCH_MAX_PENDING; i++)
+    {
+        BenchCommand_t* c = &s_pending[i];
+        if (c->id != 0 && !c->actuated && g_device_status.fan_power == c->target && c->id > matched)
+        {
+            matched = c->id;
+        }
+    }
+    if (matched == 0)
+    {
+        return;
+    }
+    for (int i = 0; i < BENCH_MAX_PENDING; i++)
+    {
+        BenchCommand_t* c = &s_pending[i];
+        if (c->id != 0 && c->id <= matched && !c->actuated)
+        {
+            c->actuated = 1;
+            Samples_Add(&s_actuation, now_ms - c->sent_ms);
+            Pending_Retire(c);
+        }
+    }
+}
+
+// 代理收到上行发布：按回复中的 "id" 匹配 property/set 的请求
+static void Bench_On_Publish(const char* topic, const char* payload, uint16_t len, uint64_t now_ms)
+{
+    static const char key[] = "\"id\":\"";
+    const size_t n = sizeof(key) - 1;
+
+    if (strstr(topic, "thing/property/set_reply") == NULL)
+    {
+        return;
+    }
+    for (uint16_t i = 0; i + n < len; i++)
+    {
+        if (memcmp(payload + i, key, n) == 0)
+        {
+            uint32_t id = (uint32_t)strtoul(payload + i + n, NULL, 10);
+            BenchCommand_t* c = &s_pending[id % BENCH_MAX_PENDING];
+            if (id != 0 && c->id == id && !c->replied)
+            {
+                c->replied = 1;
+                Samples_Add(&s_reply, now_ms - c->sent_ms);
+                Pending_Retire(c);
+            }
+            return;
+        }
+    }
+}
+
+static void Bench_Send_Command(void)
+{
+    char payload[96];
+    BenchCommand_t* c;
+
+    s_cmd_id++;
+    c = &s_pending[s_cmd_id % BENCH_MAX_PENDING];
+    c->id = s_cmd_id;
+    // 固件把风扇功率限制在 20..100，目标取在范围内才能观察到生效
+    c->target = 20 + (int)(s_cmd_id * 37 % 80);
+    if (c->target == g_device_status.fan_power)
+    {
+        c->target = (c->target == 100) ? 20 : c->target + 1;
+    }
+    snprintf(payload, sizeof(payload), "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{\"fan_power\":%d}}",
+             s_cmd_id, c->target);
+    c->actuated = 0;
+    c->replied = 0;
+    c->sent_ms = System_GetTimeMs();
+    if (HostBroker_Publish(BENCH_SET_TOPIC, payload) != 0)
+    {
+        c->id = 0;      // 离线，这条不计
+    }
+}
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+            "usage: %s [--rounds N] [--minutes M] [--loop-ms L] [--publish-ms P] [--command-ms C]\n"
+            "          [--at-latency MS] [--net-latency MS] [--jitter MS] [--loss PCT] [--open-fail PCT]\n"
+            "          [--disconnect-every S] [--interleave] [--counted] [--fragment BYTES] [--seed S] [--verbose]\n"
+            "commands are matched to replies by request id; at most %d may be outstanding, older ones are not sampled\n",
+            prog, BENCH_MAX_PENDING);
+}
+
+int main(int argc, char** argv)
+{
+    HostModem_Config_t cfg;
+    uint32_t rounds = 50;
+    double minutes = 30.0;
+    uint32_t loop_ms = 50;
+    uint32_t publish_ms = 10000;
+    uint32_t command_ms = 5000;
+    int verbose = 0;
+
+    HostModem_Default_Config(&cfg);
+    for (int i = 1; i < argc; i++)
+    {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if      (strcmp(a, "--interleave") == 0) { cfg.interleave = 1; continue; }
+        else if (strcmp(a, "--counted") == 0)    { cfg.counted_recv = 1; continue; }
+        else if (strcmp(a, "--verbose") == 0)    { verbose = 1; continue; }
+        if (v == NULL)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+        if      (strcmp(a, "--rounds") == 0)           rounds = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--minutes") == 0)          minutes = atof(v);
+        else if (strcmp(a, "--loop-ms") == 0)          loop_ms = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--publish-ms") == 0)       publish_ms = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--command-ms") == 0)       command_ms = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--at-latency") == 0)       cfg.at_latency_ms = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--net-latency") == 0)      cfg.network_latency_ms = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--jitter") == 0)           cfg.jitter_ms = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--loss") == 0)             cfg.puback_loss_pct = (uint8_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--open-fail") == 0)        cfg.open_fail_pct = (uint8_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--disconnect-every") == 0) cfg.disconnect_every_ms = (uint32_t)(atof(v) * 1000.0);
+        else if (strcmp(a, "--fragment") == 0)         cfg.fragment = (uint16_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--seed") == 0)             cfg.seed = (uint32_t)strtoul(v, NULL, 0);
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (loop_ms == 0)
+    {
+        loop_ms = 1;
+    }
+
+    // 固件日志走 stdout，默认丢弃；基准结果输出到 stderr
+    if (!verbose && freopen("/dev/null", "w", stdout) == NULL)
+    {
+        return 1;
+    }
+
+    HostModem_Init(&cfg);
+    HostBroker_Set_Publish_Hook(Bench_On_Publish);
+    USART1_Init(115200);
+    Host_Register_Tick_Hook(Bench_TickHook);
+    srand(cfg.seed);
+
+    // 1) 连接
+    uint64_t t0 = System_GetTimeMs();
+    MQTT_Connection_Start();
+    while (!MQTT_Is_Online() && System_GetTimeMs() - t0 < 600000)
+    {
+        Handle_Serial_Reception();
+        delay_ms(loop_ms);
+    }
+    if (!MQTT_Is_Online())
+    {
+        fprintf(stderr, "connect: not online after 600 s, giving up\n");
+        return 1;
+    }
+    uint64_t connect_ms = System_GetTimeMs() - t0;
+
+    // 2) 突发上报
+    const HostModem_Stats_t* st = HostModem_Get_Stats();
+    uint32_t pub0 = st->publishes;
+    uint64_t bytes0 = st->publish_bytes;
+    t0 = System_GetTimeMs();
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        MQTT_Publish_All_Data(&g_device_status);
+        Handle_Serial_Reception();
+    }
+    uint64_t burst_ms = System_GetTimeMs() - t0;
+    uint32_t burst_pubs = st->publishes - pub0;
+    uint64_t burst_bytes = st->publish_bytes - bytes0;
+    // 等后台确认收尾，避免影响稳态统计
+    for (int i = 0; i < 200; i++)
+    {
+        Handle_Serial_Reception();
+        delay_ms(loop_ms);
+    }
+
+    // 3) 稳态：周期上报 + 下行命令 + 断线重连
+    uint64_t end_ms = System_GetTimeMs() + (uint64_t)(minutes * 60000.0);
+    uint64_t next_publish = System_GetTimeMs();
+    uint64_t next_command = System_GetTimeMs() + command_ms / 2;
+    uint64_t offline_since = 0;
+    uint32_t publish_rounds = 0;
+    uint32_t skipped_rounds = 0;
+    uint32_t pub_steady0 = st->publishes;
+    uint32_t dup_steady0 = st->duplicates;
+    uint32_t commands = 0;
+
+    while (System_GetTimeMs() < end_ms)
+    {
+        uint64_t now = System_GetTimeMs();
+
+        Handle_Serial_Reception();
+        if (!MQTT_Is_Online() && offline_since == 0)
+        {
+            offline_since = now;
+        }
+        else if (MQTT_Is_Online() && offline_since != 0)
+        {
+            Samples_Add(&s_reconnect, now - offline_since);
+            offline_since = 0;
+        }
+
+        if (now >= next_publish)
+        {
+            if (MQTT_Is_Online())
+            {
+                publish_rounds++;
+            }
+            else
+            {
+                skipped_rounds++;
+            }
+            MQTT_Publish_All_Data(&g_device_status);
+            next_publish += publish_ms;
+        }
+        if (command_ms > 0 && now >= next_command)
+        {
+            Bench_Send_Command();
+            commands++;
+            next_command = now + command_ms / 2 + (uint32_t)rand() % (command_ms + 1);
+        }
+        delay_ms(loop_ms);      // 感知与控制占用的时间
+    }
+
+    fprintf(stderr, "link: at %u ms, network %u ms, jitter %u ms, puback loss %u%%, open fail %u%%, "
+            "disconnect every %.0f s%s%s, fragment %u\n",
+            cfg.at_latency_ms, cfg.network_latency_ms, cfg.jitter_ms, cfg.puback_loss_pct, cfg.open_fail_pct,
+            cfg.disconnect_every_ms / 1000.0, cfg.interleave ? ", interleaved" : "",
+            cfg.counted_recv ? ", counted recv" : "", cfg.fragment);
+    fprintf(stderr, "connect: online after %llu ms\n", (unsigned long long)connect_ms);
+    fprintf(stderr, "burst: %u rounds, %u publishes in %llu ms -> %.1f msg/s, %.0f payload B/s, %.1f ms/round\n",
+            rounds, burst_pubs, (unsigned long long)burst_ms,
+            burst_ms ? burst_pubs * 1000.0 / burst_ms : 0.0, burst_ms ? burst_bytes * 1000.0 / burst_ms : 0.0,
+            rounds ? (double)burst_ms / rounds : 0.0);
+    fprintf(stderr, "steady: %.1f min, loop %u ms, %u publish rounds (%u skipped offline), %u publishes "
+            "(%u retransmitted), %u commands\n",
+            minutes, loop_ms, publish_rounds, skipped_rounds, st->publishes - pub_steady0,
+            st->duplicates - dup_steady0, commands);
+    Samples_Print("command -> actuation", &s_actuation);
+    Samples_Print("command -> reply", &s_reply);
+    Samples_Print("offline -> online", &s_reconnect);
+    fprintf(stderr, "modem: %u commands, %u errors, %u pubacks lost, %u opens failed, %u connects, "
+            "%u disconnects, %u downlinks (%u dropped)\n",
+            st->commands, st->errors, st->pubacks_lost, st->opens_failed, st->connects, st->disconnects,
+            st->downlinks, st->downlinks_dropped);
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include "replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+void Replay_Default_Config(ReplayConfig_t* cfg)
+{
+    cfg->step_ms = REPLAY_DEFAULT_STEP_MS;
+    cfg->critical_temp = -2.9f;             // 盛花期
+    cfg->offset_decay = REPLAY_DEFAULT_DECAY;
+    cfg->seed = SIM_DEFAULT_SEED;
+    cfg->capabilities.sprinklers_available = 1;
+    cfg->capabilities.fans_available = 1;
+    cfg->capabilities.heaters_available = 1;
+}
+
+/**
+ * @brief  回放一段气象序列
+ * @note   每一步：实际廓线 = 自然廓线 + 干预偏移；决策与功率计算沿用固件代码，
+ *         干预作用由 Sim_Apply_Interventions 施加，偏移随后按 offset_decay 向自然廓线回归
+ */
+void Replay_Run(const ReplayConfig_t* cfg, const ReplaySample_t* samples, uint32_t count, ReplayResult_t* result)
+{
+    InterventionFSM_t fsm;
+    SimRng_t rng;
+    float offset[4] = {0};
+    InterventionMethod_t last_raw = INTERVENTION_NONE;
+    SystemCapabilities_t caps = cfg->capabilities;
+    const double step_h = cfg->step_ms / 3600000.0;
+    uint64_t below = 0, below_natural = 0;
+    double fan_pct_steps = 0, heater_pct_steps = 0, pump_pct_steps = 0;
+
+    memset(result, 0, sizeof(*result));
+    result->min_ground_temp = 1000.0f;
+    Sim_Rng_Seed(&rng, cfg->seed);
+    Intervention_FSM_Init(&fsm, 0);
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        const ReplaySample_t* s = &samples[k];
+        uint32_t now_ms = k * cfg->step_ms;
+        EnvironmentalData_t env;
+
+        for (int i = 0; i < 4; i++)
+        {
+            env.temperatures[i] = s->temperatures[i] + offset[i];
+        }
+        env.humidity = s->humidity;
+        env.ambient_temp = env.temperatures[1];
+        env.wind_speed = s->wind_speed;
+        env.pressure = 1013;
+
+        below_natural += (s->temperatures[0] < cfg->critical_temp);
+        below += (env.temperatures[0] < cfg->critical_temp);
+        if (env.temperatures[0] < result->min_ground_temp)
+        {
+            result->min_ground_temp = env.temperatures[0];
+        }
+
+        InversionLayerInfo_t inversion = Analyze_Inversion_Layer(&env);
+        InterventionMethod_t method = Intervention_FSM_Update(&fsm, &inversion, &caps, &env, cfg->critical_temp, now_ms);
+        InterventionPowers_t powers = Calculate_Intervention_Powers(method, &inversion, &env, cfg->critical_temp);
+
+        if (fsm.requested != last_raw)
+        {
+            result->raw_decision_changes++;
+            last_raw = fsm.requested;
+        }
+        result->steps_by_method[method]++;
+        fan_pct_steps += powers.fan_power;
+        heater_pct_steps += powers.heater_power;
+        pump_pct_steps += powers.sprinkler_power;
+
+        Sim_Apply_Interventions(&env, &powers);
+        Sim_Apply_Natural(&env, 0.0f, &rng);
+        for (int i = 0; i < 4; i++)
+        {
+            offset[i] = (env.temperatures[i] - s->temperatures[i]) * cfg->offset_decay;
+        }
+    }
+
+    result->steps = count;
+    result->fan_kwh = fan_pct_steps / 100.0 * REPLAY_FAN_RATED_W / 1000.0 * step_h;
+    result->heater_kwh = heater_pct_steps / 100.0 * REPLAY_HEATER_RATED_W / 1000.0 * step_h;
+    result->pump_kwh = pump_pct_steps / 100.0 * REPLAY_PUMP_RATED_W / 1000.0 * step_h;
+    result->hours_below_critical = below * step_h;
+    result->hours_below_critical_natural = below_natural * step_h;
+    for (int i = 0; i < FSM_ACTUATOR_COUNT; i++)
+    {
+        result->switches[i] = fsm.actuator_switches[i];
+    }
+    result->total_switches = fsm.total_switches;
+}
+
+/**
+ * @brief  合成霜冻季：每夜随机抽取傍晚温度、最低温度、逆温强度、风和湿度，
+ *         近地面按牛顿冷却降温、黎明前回暖，上层按逆温梯度叠加
+ * @return 写入的样本数 (nights * REPLAY_STEPS_PER_NIGHT)
+ */
+uint32_t Replay_Synthesize_Season(ReplaySample_t* out, uint32_t nights, uint32_t seed)
+{
+    static const float heights[4] = { HEIGHT_0, HEIGHT_1, HEIGHT_2, HEIGHT_3 };
+    SimRng_t rng;
+    uint32_t n = 0;
+
+    Sim_Rng_Seed(&rng, seed);
+
+    for (uint32_t night = 0; night < nights; night++)
+    {
+        float t_dusk    = 2.0f + 6.0f * Sim_Rng_Uniform(&rng);
+        float t_min     = -6.5f + 8.0f * Sim_Rng_Uniform(&rng);
+        float inv_max   = 0.2f + 1.6f * Sim_Rng_Uniform(&rng);      // °C/m
+        float wind_base = 2.8f * Sim_Rng_Uniform(&rng) * Sim_Rng_Uniform(&rng);
+        float rh_base   = 55.0f + 40.0f * Sim_Rng_Uniform(&rng);
+        float wind = wind_base;
+
+        for (uint32_t k = 0; k < REPLAY_STEPS_PER_NIGHT; k++)
+        {
+            float p = (float)k / REPLAY_STEPS_PER_NIGHT;
+            float ground;
+
+            if (p < 0.9f)
+            {
+                ground = t_min + (t_dusk - t_min) * expf(-4.0f * p / 0.9f);
+            }
+            else
+            {
+                float t_low = t_min + (t_dusk - t_min) * expf(-4.0f);
+                ground = t_low + 30.0f * (p - 0.9f);    // 日出后每步回暖
+            }
+
+            // 风速一阶自回归，偶有阵风
+            wind = 0.95f * wind + 0.05f * wind_base + (Sim_Rng_Uniform(&rng) - 0.5f) * 0.2f;
+            if (Sim_Rng_Uniform(&rng) < 0.002f) wind += 2.0f * Sim_Rng_Uniform(&rng);
+            if (wind < 0.0f) wind = 0.0f;
+
+            // 有风时逆温减弱
+            float calm = 1.0f - wind / 3.0f;
+            if (calm < 0.0f) calm = 0.0f;
+            float build_up = (p * 3.0f < 1.0f) ? p * 3.0f : 1.0f;
+            float gradient = inv_max * build_up * calm;
+
+            ReplaySample_t* s = &out[n++];
+            for (int i = 0; i < 4; i++)
+            {
+                s->temperatures[i] = ground + gradient * (heights[i] - heights[0]);
+            }
+            s->humidity = rh_base + (t_dusk - ground) * 2.0f;
+            if (s->humidity > 100.0f) s->humidity = 100.0f;
+            s->wind_speed = wind;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief  读取实测序列：每行 "t1,t2,t3,t4,humidity,wind"，'#' 开头的行与无法解析的表头忽略
+ * @return 0 成功，-1 失败；*samples 由调用者 free()
+ */
+int Replay_Load_CSV(const char* path, ReplaySample_t** samples, uint32_t* count)
+{
+    FILE* fp = fopen(path, "r");
+    char line[256];
+    uint32_t cap = 1024, n = 0;
+    ReplaySample_t* buf;
+
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    buf = malloc(cap * sizeof(*buf));
+    if (buf == NULL)
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        ReplaySample_t s;
+        if (line[0] == '#')
+        {
+            continue;
+        }
+        if (sscanf(line, "%f,%f,%f,%f,%f,%f", &s.temperatures[0], &s.temperatures[1],
+                   &s.temperatures[2], &s.temperatures[3], &s.humidity, &s.wind_speed) != 6)
+        {
+            continue;
+        }
+        if (n == cap)
+        {
+            ReplaySample_t* grown = realloc(buf, cap * 2 * sizeof(*buf));
+            if (grown == NULL)
+            {
+                free(buf);
+                fclose(fp);
+                return -1;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+        buf[n++] = s;
+    }
+    fclose(fp);
+
+    *samples = buf;
+    *count = n;
+    return 0;
+}
@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ * @ 名称  霜冻季回放引擎 (仅主机)
+ * @ 描述  把实测或合成的气象序列逐步送入与固件相同的
+ *         Analyze_Inversion_Layer -> Intervention_FSM_Update -> 功率计算 流程，
+ *         干预效果沿用 simulation_model，统计能耗、低于临界温度时长与执行器切换次数。
+ ******************************************************************************
+ */
+#ifndef __REPLAY_H
+#define __REPLAY_H
+
+#include "Frost_Detection.h"
+#include "Intervention_FSM.h"
+#include "simulation_model.h"
+#include <stdint.h>
+
+// 执行器额定功率 (W)，用于把功率百分比折算为能耗
+#define REPLAY_FAN_RATED_W         5500.0f
+#define REPLAY_HEATER_RATED_W     10000.0f
+#define REPLAY_PUMP_RATED_W        3000.0f
+
+#define REPLAY_DEFAULT_STEP_MS       60000     // 每个样本代表的时长
+#define REPLAY_DEFAULT_DECAY         0.90f     // 干预造成的温度偏移每步保留的比例
+#define REPLAY_STEPS_PER_NIGHT       720       // 合成序列：12 小时夜间，每分钟一个样本
+#define REPLAY_METHOD_COUNT          5
+
+// 一个气象样本：无干预时各高度的自然温度廓线
+typedef struct {
+    float temperatures[4];          // 各高度气温 (°C)
+    float humidity;                 // 相对湿度 (%)
+    float wind_speed;               // 风速 (m/s)
+} ReplaySample_t;
+
+typedef struct {
+    uint32_t step_ms;               // 样本间隔
+    float    critical_temp;         // 作物临界温度
+    float    offset_decay;          // 干预偏移的保留比例 (0~1)
+    uint32_t seed;                  // 随机干扰种子
+    SystemCapabilities_t capabilities;
+} ReplayConfig_t;
+
+typedef struct {
+    uint64_t steps;
+    double   fan_kwh;
+    double   heater_kwh;
+    double   pump_kwh;
+    double   hours_below_critical;          // 有干预时近地面低于临界温度的时长
+    double   hours_below_critical_natural;  // 无干预基线
+    float    min_ground_temp;               // 有干预时近地面最低温度
+    uint32_t switches[FSM_ACTUATOR_COUNT];  // 状态机输出的各执行器切换次数
+    uint32_t total_switches;
+    uint32_t raw_decision_changes;          // 未经状态机时决策结果的变化次数
+    uint64_t steps_by_method[REPLAY_METHOD_COUNT];
+} ReplayResult_t;
+
+void     Replay_Default_Config(ReplayConfig_t* cfg);
+void     Replay_Run(const ReplayConfig_t* cfg, const ReplaySample_t* samples, uint32_t count, ReplayResult_t* result);
+uint32_t Replay_Synthesize_Season(ReplaySample_t* out, uint32_t nights, uint32_t seed);
+int      Replay_Load_CSV(const char* path, ReplaySample_t** samples, uint32_t* count);
+
+#endif
@@ -0,0 +1,359 @@
+/**
+ ******************************************************************************
+ * @ 名称  霜冻控制阈值并行扫描工具
+ * @ 描述  在多线程中用回放引擎评估 Frost_Detection.h 的可调阈值组合：
+ *         每个候选参数在同一组扰动后的合成夜晚上回放，
+ *         得分 = 总能耗(kWh) + damage_weight * 低于临界温度的分钟数 + switch_weight * 切换次数，
+ *         最优结果写成 Frost_Params_Tuned.h，固件以 make TUNED=1 使用。
+ *         用法: threshold_sweep [--mode grid|adaptive] [--levels L] [--nights N] [--seed S]
+ *                               [--threads T] [--damage-weight W] [--switch-weight W]
+ *                               [--critical T] [--rounds R] [--out file]
+ ******************************************************************************
+ */
+#include "replay.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SWEEP_PARAM_COUNT   7
+
+// 参数描述：名称、在 FrostParams_t 中的取值/赋值方式、搜索范围
+typedef struct {
+    const char* macro;      // 输出头文件中的宏名
+    float min;
+    float max;
+    uint8_t is_int;
+} SweepParamDesc_t;
+
+static const SweepParamDesc_t s_param_desc[SWEEP_PARAM_COUNT] = {
+    { "FROST_DEFAULT_INVERSION_GRADIENT_THRESHOLD", 0.1f, 1.5f,  0 },
+    { "FROST_DEFAULT_MAX_INVERSION_STRENGTH",       1.0f, 5.0f,  0 },
+    { "FROST_DEFAULT_WIND_SPEED_NO_INTERVENTION",   0.5f, 4.0f,  0 },
+    { "FROST_DEFAULT_WIND_SPEED_SPRINKLERS_RISKY",  1.0f, 5.0f,  0 },
+    { "FROST_DEFAULT_INTERVENTION_SAFETY_MARGIN",   0.0f, 3.0f,  0 },
+    { "FROST_DEFAULT_SEVERE_FROST_MARGIN",          0.5f, 4.0f,  0 },
+    { "FROST_DEFAULT_MIN_POWER",                    0.0f, 60.0f, 1 },
+};
+
+typedef struct {
+    float v[SWEEP_PARAM_COUNT];
+} SweepPoint_t;
+
+typedef struct {
+    SweepPoint_t   point;
+    ReplayResult_t result;
+    double         score;
+} SweepCandidate_t;
+
+typedef struct {
+    const ReplayConfig_t* cfg;
+    const ReplaySample_t* samples;
+    uint32_t              count;
+    double                damage_weight;
+    double                switch_weight;
+    SweepCandidate_t*     candidates;
+    uint32_t              candidate_num;
+    atomic_uint           next;
+} SweepJob_t;
+
+static void point_to_params(const SweepPoint_t* p, FrostParams_t* out)
+{
+    out->inversion_gradient_threshold = p->v[0];
+    out->max_inversion_strength       = p->v[1];
+    out->wind_speed_no_intervention   = p->v[2];
+    out->wind_speed_sprinklers_risky  = p->v[3];
+    out->intervention_safety_margin   = p->v[4];
+    out->severe_frost_margin          = p->v[5];
+    out->min_power                    = (int)(p->v[6] + 0.5f);
+}
+
+static void params_to_point(const FrostParams_t* in, SweepPoint_t* p)
+{
+    p->v[0] = in->inversion_gradient_threshold;
+    p->v[1] = in->max_inversion_strength;
+    p->v[2] = in->wind_speed_no_intervention;
+    p->v[3] = in->wind_speed_sprinklers_risky;
+    p->v[4] = in->intervention_safety_margin;
+    p->v[5] = in->severe_frost_margin;
+    p->v[6] = (float)in->min_power;
+}
+
+static double score_of(const SweepJob_t* job, const ReplayResult_t* r)
+{
+    double energy = r->fan_kwh + r->heater_kwh + r->pump_kwh;
+    double damage_minutes = r->hours_below_critical * 60.0;
+    return energy + job->damage_weight * damage_minutes + job->switch_weight * r->total_switches;
+}
+
+// 工作线程：从共享队列领取候选参数，在线程局部参数表上运行真实决策代码
+static void* sweep_worker(void* arg)
+{
+    SweepJob_t* job = (SweepJob_t*)arg;
+
+    for (;;)
+    {
+        unsigned int i = atomic_fetch_add(&job->next, 1);
+        if (i >= job->candidate_num)
+        {
+            break;
+        }
+        SweepCandidate_t* c = &job->candidates[i];
+        point_to_params(&c->point, &g_frost_params);
+        Replay_Run(job->cfg, job->samples, job->count, &c->result);
+        c->score = score_of(job, &c->result);
+    }
+    return NULL;
+}
+
+static void evaluate(SweepJob_t* job, SweepCandidate_t* candidates, uint32_t num, unsigned threads)
+{
+    pthread_t tid[256];
+
+    job->candidates = candidates;
+    job->candidate_num = num;
+    atomic_store(&job->next, 0);
+
+    if (threads > 256) threads = 256;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        pthread_create(&tid[t], NULL, sweep_worker, job);
+    }
+    for (unsigned t = 0; t < threads; t++)
+    {
+        pthread_join(tid[t], NULL);
+    }
+}
+
+static const SweepCandidate_t* best_of(const SweepCandidate_t* c, uint32_t num)
+{
+    const SweepCandidate_t* best = &c[0];
+    for (uint32_t i = 1; i < num; i++)
+    {
+        if (c[i].score < best->score)
+        {
+            best = &c[i];
+        }
+    }
+    return best;
+}
+
+static float clampf(float v, float lo, float hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+/* 网格扫描：每个参数在范围内取 levels 个等分点 */
+static SweepCandidate_t run_grid(SweepJob_t* job, unsigned levels, unsigned threads)
+{
+    uint64_t total = 1;
+    for (int k = 0; k < SWEEP_PARAM_COUNT; k++)
+    {
+        total *= levels;
+    }
+    if (total > 2000000)
+    {
+        fprintf(stderr, "ERROR: grid of %llu points is too large, lower --levels\n", (unsigned long long)total);
+        exit(1);
+    }
+
+    SweepCandidate_t* c = calloc(total, sizeof(*c));
+    if (c == NULL)
+    {
+        fprintf(stderr, "ERROR: out of memory for %llu grid candidates\n", (unsigned long long)total);
+        exit(1);
+    }
+    for (uint64_t i = 0; i < total; i++)
+    {
+        uint64_t idx = i;
+        for (int k = 0; k < SWEEP_PARAM_COUNT; k++)
+        {
+            unsigned step = idx % levels;
+            idx /= levels;
+            float t = (levels > 1) ? (float)step / (levels - 1) : 0.5f;
+            c[i].point.v[k] = s_param_desc[k].min + t * (s_param_desc[k].max - s_param_desc[k].min);
+        }
+    }
+    fprintf(stderr, "grid: %llu candidates on %u threads\n", (unsigned long long)total, threads);
+    evaluate(job, c, (uint32_t)total, threads);
+
+    SweepCandidate_t best = *best_of(c, (uint32_t)total);
+    free(c);
+    return best;
+}
+
+/* 自适应搜索：从当前默认值出发做并行坐标模式搜索，无改进时步长减半 */
+static SweepCandidate_t run_adaptive(SweepJob_t* job, unsigned rounds, unsigned threads)
+{
+    SweepCandidate_t current;
+    SweepCandidate_t trial[2 * SWEEP_PARAM_COUNT];
+    float step[SWEEP_PARAM_COUNT];
+
+    params_to_point(&g_frost_params_default, &current.point);
+    evaluate(job, &current, 1, 1);
+    for (int k = 0; k < SWEEP_PARAM_COUNT; k++)
+    {
+        step[k] = (s_param_desc[k].max - s_param_desc[k].min) / 4.0f;
+    }
+    fprintf(stderr, "adaptive: start score %.1f\n", current.score);
+
+    for (unsigned r = 0; r < rounds; r++)
+    {
+        for (int k = 0; k < SWEEP_PARAM_COUNT; k++)
+        {
+            for (int dir = 0; dir < 2; dir++)
+            {
+                SweepCandidate_t* t = &trial[2 * k + dir];
+                t->point = current.point;
+                t->point.v[k] = clampf(current.point.v[k] + (dir ? step[k] : -step[k]),
+                                       s_param_desc[k].min, s_param_desc[k].max);
+            }
+        }
+        evaluate(job, trial, 2 * SWEEP_PARAM_COUNT, threads);
+
+        const SweepCandidate_t* best = best_of(trial, 2 * SWEEP_PARAM_COUNT);
+        if (best->score < current.score)
+        {
+            current = *best;
+        }
+        else
+        {
+            for (int k = 0; k < SWEEP_PARAM_COUNT; k++)
+            {
+                step[k] *= 0.5f;
+            }
+        }
+        fprintf(stderr, "adaptive: round %u score %.1f\n", r + 1, current.score);
+    }
+    return current;
+}
+
+static int write_header(const char* path, const SweepCandidate_t* best, const ReplayConfig_t* cfg,
+                        uint32_t nights, const SweepJob_t* job)
+{
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+
+    fprintf(fp, "/* 由 TOOLS/sweep/threshold_sweep 生成，请勿手工修改 */\n");
+    fprintf(fp, "/* %u nights, seed 0x%08X, critical %.2f C, damage weight %.3f kWh/min, switch weight %.3f kWh */\n",
+            nights, cfg->seed, cfg->critical_temp, job->damage_weight, job->switch_weight);
+    fprintf(fp, "/* score %.1f: energy %.1f kWh, %.2f h below critical, %u switches */\n",
+            best->score, best->result.fan_kwh + best->result.heater_kwh + best->result.pump_kwh,
+            best->result.hours_below_critical, best->result.total_switches);
+    fprintf(fp, "#ifndef __FROST_PARAMS_TUNED_H\n#define __FROST_PARAMS_TUNED_H\n\n");
+    for (int k = 0; k < SWEEP_PARAM_COUNT; k++)
+    {
+        if (s_param_desc[k].is_int)
+        {
+            fprintf(fp, "#define %-44s %d\n", s_param_desc[k].macro, (int)(best->point.v[k] + 0.5f));
+        }
+        else
+        {
+            fprintf(fp, "#define %-44s %.3ff\n", s_param_desc[k].macro, best->point.v[k]);
+        }
+    }
+    fprintf(fp, "\n#endif\n");
+    fclose(fp);
+    return 0;
+}
+
+static void print_result(const char* label, const SweepCandidate_t* c)
+{
+    fprintf(stderr, "%-8s score %.1f | energy %.1f kWh | below critical %.2f h | switches %u\n", label,
+            c->score, c->result.fan_kwh + c->result.heater_kwh + c->result.pump_kwh,
+            c->result.hours_below_critical, c->result.total_switches);
+    for (int k = 0; k < SWEEP_PARAM_COUNT; k++)
+    {
+        fprintf(stderr, "    %-44s %.3f\n", s_param_desc[k].macro, c->point.v[k]);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ReplayConfig_t cfg;
+    SweepJob_t job;
+    const char* mode = "adaptive";
+    const char* out = "build_host/Frost_Params_Tuned.h";
+    uint32_t nights = 1000;
+    unsigned levels = 3;
+    unsigned rounds = 12;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned threads = (ncpu > 0) ? (unsigned)ncpu : 1;
+
+    Replay_Default_Config(&cfg);
+    memset(&job, 0, sizeof(job));
+    job.damage_weight = 1.0;
+    job.switch_weight = 0.01;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc
+            && (strcmp(argv[i + 1], "grid") == 0 || strcmp(argv[i + 1], "adaptive") == 0)) mode = argv[++i];
+        else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc)        levels = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--nights") == 0 && i + 1 < argc)        nights = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)          cfg.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)       threads = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--damage-weight") == 0 && i + 1 < argc) job.damage_weight = atof(argv[++i]);
+        else if (strcmp(argv[i], "--switch-weight") == 0 && i + 1 < argc) job.switch_weight = atof(argv[++i]);
+        else if (strcmp(argv[i], "--critical") == 0 && i + 1 < argc)      cfg.critical_temp = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)        rounds = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)           out = argv[++i];
+        else
+        {
+            fprintf(stderr, "usage: %s [--mode grid|adaptive] [--levels L] [--nights N] [--seed S] [--threads T]\n"
+                            "       [--damage-weight W] [--switch-weight W] [--critical T] [--rounds R] [--out file]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (threads == 0) threads = 1;
+    if (levels < 2) levels = 2;
+
+    // 所有候选参数共用同一组扰动夜晚，比较才公平
+    ReplaySample_t* samples = malloc((size_t)nights * REPLAY_STEPS_PER_NIGHT * sizeof(*samples));
+    if (samples == NULL)
+    {
+        fprintf(stderr, "ERROR: out of memory\n");
+        return 1;
+    }
+    job.cfg = &cfg;
+    job.samples = samples;
+    job.count = Replay_Synthesize_Season(samples, nights, cfg.seed);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    SweepCandidate_t baseline;
+    params_to_point(&g_frost_params_default, &baseline.point);
+    evaluate(&job, &baseline, 1, 1);
+
+    SweepCandidate_t best = (strcmp(mode, "grid") == 0) ? run_grid(&job, levels, threads)
+                                                         : run_adaptive(&job, rounds, threads);
+    if (baseline.score <= best.score)
+    {
+        best = baseline;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    print_result("default", &baseline);
+    print_result("tuned", &best);
+    fprintf(stderr, "%u nights x %u steps, %u threads, %.2f s\n", nights, REPLAY_STEPS_PER_NIGHT, threads, wall);
+
+    if (write_header(out, &best, &cfg, nights, &job) != 0)
+    {
+        fprintf(stderr, "ERROR: cannot write '%s'\n", out);
+        free(samples);
+        return 1;
+    }
+    fprintf(stderr, "wrote %s\n", out);
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+二进制遥测记录云端解码器
+
+固件在 make TELEMETRY_BIN=1 时把每轮上报编码为 32 字节定长记录，Base64 后发布到
+{product_id}/{device_name}/telemetry/bin。本脚本把它还原为与 OneNET 物模型同名的属性，
+格式定义以 HARDWARE/telemetry_bin/telemetry_bin.h 为准，两处需同步修改。
+
+用法:
+    python3 TOOLS/telemetry/decode_telemetry.py AQcAAB...          # 解码一条或多条，输出 JSON
+    echo AQcAAB... | python3 TOOLS/telemetry/decode_telemetry.py   # 从标准输入读取
+    ./build_host/telemetry_roundtrip --emit | python3 TOOLS/telemetry/decode_telemetry.py --verify
+"""
+import argparse
+import base64
+import binascii
+import json
+import math
+import struct
+import sys
+
+VERSION = 1
+RECORD = struct.Struct("<BBH4hhHHHBBBBBBIH")
+INVALID = -32768
+assert RECORD.size == 32
+
+
+class DecodeError(ValueError):
+    pass
+
+
+def decode(text):
+    raw = base64.b64decode(text, validate=True)
+    if len(raw) != RECORD.size:
+        raise DecodeError("record is %d bytes, expected %d" % (len(raw), RECORD.size))
+    if raw[0] != VERSION:
+        raise DecodeError("unsupported record version %d" % raw[0])
+    # CRC-16/CCITT-FALSE，与固件 TelemetryBin_Crc16 相同
+    if binascii.crc_hqx(raw[:30], 0xFFFF) != struct.unpack_from("<H", raw, 30)[0]:
+        raise DecodeError("CRC mismatch")
+
+    (_, avail, seq, t1, t2, t3, t4, amb, hum, pressure, wind,
+     status, stage, fan, heater, sprinkler, _, switches, _) = RECORD.unpack(raw)
+
+    def centi(v):
+        return None if v == INVALID else v / 100.0
+
+    return {
+        "seq": seq,
+        "temp1": centi(t1),
+        "temp2": centi(t2),
+        "temp3": centi(t3),
+        "temp4": centi(t4),
+        "ambient_temp": centi(amb),
+        "humidity": hum / 10.0,
+        "pressure": pressure,
+        "wind_speed": wind / 100.0,
+        "intervention_status": status,
+        "crop_stage": stage,
+        "fan_power": fan,
+        "heater_power": heater,
+        "sprinkler_power": sprinkler,
+        "sprinklers_available": avail & 1,
+        "fans_available": (avail >> 1) & 1,
+        "heaters_available": (avail >> 2) & 1,
+        "actuator_switches": switches,
+    }
+
+
+def verify(lines):
+    """逐行比对 telemetry_roundtrip --emit 的输出：Base64 文本 + C 解码器得到的字段值"""
+    fields = ["seq", "temp1", "temp2", "temp3", "temp4", "ambient_temp", "humidity", "pressure",
+              "wind_speed", "intervention_status", "crop_stage", "fan_power", "heater_power",
+              "sprinkler_power", "available", "actuator_switches"]
+    count = 0
+    bad = 0
+    for line in lines:
+        parts = line.split()
+        if not parts:
+            continue
+        count += 1
+        rec = decode(parts[0])
+        rec["available"] = rec["sprinklers_available"] | rec["fans_available"] << 1 | rec["heaters_available"] << 2
+        for name, expected in zip(fields, parts[1:]):
+            got = rec[name]
+            want = float(expected)
+            if got is None:
+                ok = math.isnan(want)
+            else:
+                ok = abs(got - want) < 0.006
+            if not ok:
+                bad += 1
+                print("MISMATCH seq %s %s: python %r, C %s" % (parts[1], name, got, expected), file=sys.stderr)
+                break
+    print("verified %d records, %d mismatches" % (count, bad))
+    return 0 if bad == 0 and count > 0 else 1
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("records", nargs="*", help="Base64 记录，缺省时从标准输入逐行读取")
+    ap.add_argument("--verify", action="store_true", help="比对 telemetry_roundtrip --emit 的输出")
+    args = ap.parse_args()
+
+    lines = args.records or [l.strip() for l in sys.stdin]
+    if args.verify:
+        return verify(lines)
+
+    status = 0
+    for text in lines:
+        if not text:
+            continue
+        try:
+            print(json.dumps(decode(text), ensure_ascii=False))
+        except (DecodeError, binascii.Error) as e:
+            print("ERROR: %s: %s" % (text, e), file=sys.stderr)
+            status = 1
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ * @ 名称  二进制遥测往返校验工具
+ * @ 描述  用法: telemetry_roundtrip [--count N] [--seed S] [--emit]
+ *         随机生成 N 条记录 (含 NaN、越界等边界值)，经固件同一份编码器编码、Base64、
+ *         再解码回来，检查每个字段的误差不超过量化步长的一半，并检查单比特翻转都被 CRC 检出。
+ *         --emit 把每条记录的 Base64 文本与期望值按行输出，供 decode_telemetry.py --verify 交叉校验。
+ ******************************************************************************
+ */
+#include "telemetry_bin.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t s_rng = 1;
+
+static uint32_t xorshift32(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static float uniform(float lo, float hi)
+{
+    return lo + (hi - lo) * (xorshift32() / 4294967296.0f);
+}
+
+static int base64_value(char c)
+{
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+static int base64_decode(const char* text, uint8_t* out, int max)
+{
+    int n = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+
+    for (; *text != '\0' && *text != '='; text++)
+    {
+        int v = base64_value(*text);
+        if (v < 0) return -1;
+        acc = (acc << 6) | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            if (n >= max) return -1;
+            out[n++] = (uint8_t)(acc >> bits);
+        }
+    }
+    return n;
+}
+
+static void random_record(TelemetryBin_Record_t* r, uint32_t index)
+{
+    r->seq = (uint16_t)index;
+    for (int i = 0; i < 4; i++)
+    {
+        r->temps[i] = uniform(-15.0f, 25.0f);
+    }
+    r->ambient_temp = uniform(-15.0f, 25.0f);
+    r->humidity = uniform(20.0f, 100.0f);
+    r->pressure = (int32_t)uniform(950.0f, 1050.0f);
+    r->wind_speed = uniform(0.0f, 12.0f);
+    r->intervention_status = (uint8_t)(xorshift32() % 5);
+    r->crop_stage = (uint8_t)(xorshift32() % 4);
+    r->fan_power = (uint8_t)(xorshift32() % 101);
+    r->heater_power = (uint8_t)(xorshift32() % 101);
+    r->sprinkler_power = (uint8_t)(xorshift32() % 101);
+    r->available = (uint8_t)(xorshift32() & 0x07);
+    r->actuator_switches = xorshift32();
+
+    // 每 16 条插入一条边界值：传感器失效与超出量程
+    if (index % 16 == 15)
+    {
+        r->temps[index % 4] = NAN;
+        r->ambient_temp = 400.0f;
+        r->wind_speed = -1.0f;
+    }
+}
+
+static int near(float decoded, float original, float step, float lo, float hi)
+{
+    if (isnan(original)) return isnan(decoded);
+    if (original > hi) original = hi;
+    if (original < lo) original = lo;
+    return fabsf(decoded - original) <= step * 0.5f + 1e-4f;
+}
+
+static int check(const TelemetryBin_Record_t* a, const TelemetryBin_Record_t* b)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        if (!near(b->temps[i], a->temps[i], 0.01f, -327.67f, 327.67f)) return 0;
+    }
+    return near(b->ambient_temp, a->ambient_temp, 0.01f, -327.67f, 327.67f) &&
+           near(b->humidity, a->humidity, 0.1f, 0.0f, 6553.5f) &&
+           near(b->wind_speed, a->wind_speed, 0.01f, 0.0f, 655.35f) &&
+           b->pressure == a->pressure && b->seq == a->seq &&
+           b->intervention_status == a->intervention_status && b->crop_stage == a->crop_stage &&
+           b->fan_power == a->fan_power && b->heater_power == a->heater_power &&
+           b->sprinkler_power == a->sprinkler_power && b->available == a->available &&
+           b->actuator_switches == a->actuator_switches;
+}
+
+// 与 onenet_mqtt.c 五条属性上报等价的文本 JSON 负载长度，用于对比
+static int json_equivalent_bytes(const TelemetryBin_Record_t* r)
+{
+    char buf[512];
+    int total = 0;
+
+    total += snprintf(buf, sizeof(buf), "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{\"ambient_temp\":{\"value\":%.1f},"
+                      "\"humidity\":{\"value\":%.1f},\"pressure\":{\"value\":%d},\"wind_speed\":{\"value\":%.1f}}}",
+                      r->seq, r->ambient_temp, r->humidity, (int)r->pressure, r->wind_speed);
+    total += snprintf(buf, sizeof(buf), "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{\"temp1\":{\"value\":%.1f},"
+                      "\"temp2\":{\"value\":%.1f},\"temp3\":{\"value\":%.1f},\"temp4\":{\"value\":%.1f}}}",
+                      r->seq, r->temps[0], r->temps[1], r->temps[2], r->temps[3]);
+    total += snprintf(buf, sizeof(buf), "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{\"intervention_status\":{\"value\":%u}}}",
+                      r->seq, r->intervention_status);
+    total += snprintf(buf, sizeof(buf), "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{\"fan_power\":{\"value\":%u},"
+                      "\"heater_power\":{\"value\":%u},\"sprinkler_power\":{\"value\":%u},\"actuator_switches\":{\"value\":%u}}}",
+                      r->seq, r->fan_power, r->heater_power, r->sprinkler_power, (unsigned)r->actuator_switches);
+    total += snprintf(buf, sizeof(buf), "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{\"sprinklers_available\":{\"value\":%d},"
+                      "\"fans_available\":{\"value\":%d},\"heaters_available\":{\"value\":%d}}}",
+                      r->seq, r->available & 1, (r->available >> 1) & 1, (r->available >> 2) & 1);
+    return total;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t count = 10000;
+    int emit = 0;
+    uint32_t failures = 0;
+    uint32_t crc_missed = 0;
+    uint64_t json_bytes = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+        {
+            count = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            s_rng = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (s_rng == 0) s_rng = 1;
+        }
+        else if (strcmp(argv[i], "--emit") == 0)
+        {
+            emit = 1;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--count N] [--seed S] [--emit]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (uint32_t n = 0; n < count; n++)
+    {
+        TelemetryBin_Record_t in, out;
+        uint8_t record[TELEMETRY_BIN_SIZE];
+        uint8_t back[TELEMETRY_BIN_SIZE + 4];
+        char text[TELEMETRY_BIN_BASE64_SIZE + 1];
+
+        random_record(&in, n);
+        TelemetryBin_Base64(record, TelemetryBin_Encode(&in, record), text);
+        int len = base64_decode(text, back, sizeof(back));
+
+        if (len != TELEMETRY_BIN_SIZE || memcmp(back, record, TELEMETRY_BIN_SIZE) != 0 ||
+            TelemetryBin_Decode(back, (uint16_t)len, &out) != 0 || !check(&in, &out))
+        {
+            failures++;
+            if (failures <= 5)
+            {
+                fprintf(stderr, "FAIL: record %u (%s)\n", n, text);
+            }
+            continue;
+        }
+
+        // 单比特翻转必须被 CRC (或版本字节) 检出
+        for (int bit = 0; bit < TELEMETRY_BIN_SIZE * 8; bit++)
+        {
+            back[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+            if (TelemetryBin_Decode(back, TELEMETRY_BIN_SIZE, &out) == 0)
+            {
+                crc_missed++;
+            }
+            back[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        }
+
+        json_bytes += (uint64_t)json_equivalent_bytes(&in);
+        if (emit)
+        {
+            // Base64 文本 + 解码后的期望值，decode_telemetry.py --verify 逐字段比对
+            printf("%s %u %.2f %.2f %.2f %.2f %.2f %.1f %d %.2f %u %u %u %u %u %u %u\n", text, out.seq,
+                   out.temps[0], out.temps[1], out.temps[2], out.temps[3], out.ambient_temp, out.humidity,
+                   (int)out.pressure, out.wind_speed, out.intervention_status, out.crop_stage,
+                   out.fan_power, out.heater_power, out.sprinkler_power, out.available,
+                   (unsigned)out.actuator_switches);
+        }
+    }
+
+    fprintf(emit ? stderr : stdout,
+            "records %u, failures %u, undetected bit flips %u\n"
+            "payload per report: binary %d bytes (base64 %d), text JSON %.0f bytes in 5 posts\n",
+            count, failures, crc_missed, TELEMETRY_BIN_SIZE, TELEMETRY_BIN_BASE64_SIZE,
+            count ? (double)json_bytes / count : 0.0);
+    return (failures == 0 && crc_missed == 0) ? 0 : 1;
+}
@@ -0,0 +1,518 @@
+#include "app.h"
+#include "delay.h"
+#include <stdio.h>
+#include "UART_DISPLAY.h"
+#include "Frost_Detection.h"
+#include "simulation_model.h"
+#include "UART_SENSOR.h"
+#include "ds18b20.h"
+#include "dht11.h"
+#include "fan.h"
+#include "led.h"
+#include "beep.h"
+#include "alarm.h"
+#include "key.h"
+#include "Relay.h"
+#include "actuator.h"
+#include "tft.h"
+#include "tft_driver.h"
+#include "onenet_mqtt.h"
+#include "Intervention_FSM.h"
+#include "profile.h"
+#include "sensor_stats.h"
+#include "config_store.h"
+#include "telemetry_bin.h"
+#include "flash_log.h"
+#include "supervisor.h"
+#include <string.h>
+#include <math.h>
+
+
+// 作物霜冻临界温度（可根据作物类型调整）
+float Crop_Critical_Temp;
+
+float get_critical_temp(int crop_stage) 
+{
+    switch(crop_stage) 
+    {
+        case STAGE_TIGHT_CLUSTER: return -3.9f;
+        case STAGE_FULL_BLOOM:    return -2.9f;
+        case STAGE_SMALL_FRUIT:   return -2.3f; 
+        default:                  return 1.0f; // 默认安全值
+    }
+}
+
+uint8_t high; //模拟高度变量
+uint8_t DATA_Flag = 0;//判断数据是否准备好，模拟高度的一环
+volatile uint8_t CloseAll_flag;
+
+
+// 全局环境数据
+EnvironmentalData_t env_data;
+InversionLayerInfo_t current_inversion;
+InterventionMethod_t Intervention_Method;
+SystemCapabilities_t SysAbilities = {1,1,1};
+InterventionPowers_t powers = {0,0,0};
+SystemStatus_t system_status;
+InterventionFSM_t intervention_fsm;
+SensorStats_t sensor_stats;             // 上报用的窗口统计，控制仍使用瞬时值
+
+/****** 风速传感器操作变量 ******/
+float	 wind_speed = 0.0;		    // 风速值
+uint16_t wind_power = 0;	        // 风力等级
+char	 air_receved_flag = FREE;   // 接收状态标志
+uint16_t air_error_count = 0;	    // 环境参数传感器异常次数 当传感器连续异常多次，即认为该传感器有问题
+uint16_t busy_count = 0;	        // 用于记录等待传感器数据的时间
+
+/****** 温湿度传感器操作变量 ******/
+float humidity;                      //湿度值
+int humidity_temp;
+float temperature;                   //环境温度值
+int temperature_temp;     
+
+int mqtt_flag=0;
+
+/**
+ * @brief  把 EEPROM 中恢复的设备可用性应用到决策层；作物阶段、气压与校准偏移每轮直接读取
+ */
+static void App_Apply_Config(void)
+{
+    const DeviceConfig_t* cfg = ConfigStore_Get();
+    SysAbilities.sprinklers_available = (cfg->available & TELEMETRY_AVAIL_SPRINKLERS) ? 1 : 0;
+    SysAbilities.fans_available = (cfg->available & TELEMETRY_AVAIL_FANS) ? 1 : 0;
+    SysAbilities.heaters_available = (cfg->available & TELEMETRY_AVAIL_HEATERS) ? 1 : 0;
+}
+
+static uint32_t s_boot_mark_ms;         // 上一个启动阶段结束的时刻
+static uint8_t s_first_decision_done;
+
+// 启动阶段计时：打印本阶段耗时与自复位起的时间
+static void Boot_Stage_Done(const char* stage)
+{
+    uint32_t now = (uint32_t)System_GetTimeMs();
+    printf("INFO: boot %-8s %4lu ms (t=%lu ms)\r\n", stage, (unsigned long)(now - s_boot_mark_ms), (unsigned long)now);
+    s_boot_mark_ms = now;
+}
+
+/**
+ * @brief  分阶段启动：执行器先进入安全状态，传感器并行探测并启动第一次转换，
+ *         转换进行期间完成参数恢复和屏幕初始化，云端连接在后台进行
+ * @note   DS18B20 12 位转换 (最长 750ms) 与屏幕初始化重叠，结束时第一帧数据已就绪，
+ *         主循环第一轮即可做出有效决策
+ */
+void App_Setup(void)
+{
+    // 1ms 系统时基初始化，干预状态机的驻留时间与AT指令超时都依赖它
+    System_SysTickInit();
+    // 串口初始化 (波特率 115200)：USART1 接 4G 模组，USART2 为 printf 调试串口，
+    // 必须在第一条 printf 之前完成，否则 _write 在未开时钟的 USART 上一直等待
+    USART1_Init(115200);
+    USART2_Init(115200);
+    // 上一次复位的原因与看门狗现场 (备份寄存器)
+    Supervisor_Init();
+
+    // 阶段 1：执行器安全状态 —— 上电后最先把水泵、加热器、风机与舵机关到位
+    Servo_Init();
+    Fan_TIM2_PWM_Init();
+    Relay_Init();
+    WaterPump_And_Heater_Init();
+    Buzzer_Init();
+    LED_Init();
+    Alarm_Init();
+    Actuator_Init();
+    System_CloseAll();
+    //按键初始化 (紧急停止在启动期间即可用)
+    EXTI_KEY_Init();
+    Boot_Stage_Done("safe");
+
+    // 阶段 2：传感器 —— DS18B20 四路并行探测，配置一致时不写 EEPROM，随后同时启动第一次转换
+    ModBUS_Init();
+    ModBUS_Start_Query();
+    uint8_t ds18b20_present = DS18B20_InitAll();
+    // DHT11 只探测一次，不再无限重试：无应答时主循环每轮照常重试，读数保持上一次的值
+    if (DHT11_Init())
+    {
+        printf("WARN: DHT11 not responding, will retry from the main loop.\r\n");
+    }
+    Boot_Stage_Done("sensors");
+
+    // 阶段 3：上次保存的参数 (一次顺序读出，不依赖网络) 与片内 Flash 样本日志的写指针
+    ConfigStore_Load();
+    App_Apply_Config();
+    FlashLog_Init();
+    //模拟环境初始化
+    TIM4_MainTick_Init(300);
+    Sim_Seed(SIM_DEFAULT_SEED);
+    Intervention_FSM_Init(&intervention_fsm, (uint32_t)System_GetTimeMs());
+    SensorStats_Init(&sensor_stats, SENSOR_STATS_WINDOW_MS, (uint32_t)System_GetTimeMs());
+#if PROFILE_ENABLE
+    Profile_Init();
+#endif
+    Boot_Stage_Done("config");
+
+    // 阶段 4：屏幕初始化与静态界面 (与 DS18B20 转换重叠)
+    Lcd_Init();
+    Lcd_Clear(GRAY0); 
+    
+    // -- 绘制标题区 --
+    Gui_DrawFont_GBK16(5, 2, BLUE, GRAY0, "御霜塔-霜冻预警"); 
+    //Gui_DrawFillRect(0, 0, 139, 20, BLUE);  // 标题蓝底
+    //Gui_DrawFont_GBK16(5, 2, WHITE, BLUE, "御霜塔-霜冻预警");  // 白字蓝底
+    Gui_DrawLine(0, 20, 139, 20, GRAY1);  // 分隔线
+    
+    // 绘制核心数据区 
+    
+    Gui_DrawFont_GBK16(5-4, 22, BLACK, GRAY0, "T1:");
+    Gui_DrawFont_GBK16(69-4, 22, BLACK, GRAY0, "T2:");   
+    Gui_DrawFont_GBK16(5-4, 42, BLACK, GRAY0, "T3:");  
+    Gui_DrawFont_GBK16(69-4, 42, BLACK, GRAY0, "T4:");
+    Gui_DrawFont_GBK16(0, 62, BLACK, GRAY0, " Amb Temp:");
+    Gui_DrawFont_GBK16(5, 82, BLACK, GRAY0, "风速:");
+    Gui_DrawFont_GBK16(5, 103, BLACK, GRAY0, "湿度:");
+    Boot_Stage_Done("display");
+
+    // 阶段 5：云端连接在后台进行，由主循环中的 Handle_Serial_Reception() 推进，不阻塞启动
+    MQTT_Connection_Start();
+    Boot_Stage_Done("modem");
+
+    // 阶段 6：等第一次温度转换结束，主循环第一轮读到的就是有效温度
+    uint8_t pending = DS18B20_Wait_Conversion(ds18b20_present, DS18B20_CONV_MS);
+    if (pending)
+    {
+        printf("WARN: DS18B20 conversion timed out (mask 0x%02X).\r\n", pending);
+    }
+    // 主循环开始后各任务按时报到，看门狗才会被喂
+    Supervisor_Start();
+    Boot_Stage_Done("ready");
+}
+
+/**
+ * @brief  把本轮读数计入统计窗口
+ */
+static void Sample_Sensor_Window(const EnvironmentalData_t* data)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        SensorStats_Add(&sensor_stats, (SensorStats_Channel_t)(STATS_CH_TEMP1 + i), data->temperatures[i]);
+    }
+    SensorStats_Add(&sensor_stats, STATS_CH_AMBIENT, data->ambient_temp);
+    SensorStats_Add(&sensor_stats, STATS_CH_HUMIDITY, data->humidity);
+    SensorStats_Add(&sensor_stats, STATS_CH_WIND, data->wind_speed);
+}
+
+/**
+ * @brief  把刚结束的统计窗口的均值写入 Flash 日志
+ */
+static void Log_Sensor_Window(const SensorWindow_t* win)
+{
+    FlashLog_Sample_t sample;
+
+    #define WINDOW_MEAN(c)  ((win->ch[c].n > 0) ? win->ch[c].mean : NAN)
+    for (int i = 0; i < 4; i++)
+    {
+        sample.temps[i] = WINDOW_MEAN(STATS_CH_TEMP1 + i);
+    }
+    sample.ambient_temp = WINDOW_MEAN(STATS_CH_AMBIENT);
+    sample.humidity = WINDOW_MEAN(STATS_CH_HUMIDITY);
+    sample.wind_speed = WINDOW_MEAN(STATS_CH_WIND);
+    #undef WINDOW_MEAN
+    sample.method = (uint8_t)Intervention_Method;
+    sample.crop_stage = ConfigStore_Get()->crop_stage;
+    FlashLog_Append(&sample, (uint32_t)System_GetTimeMs());
+}
+
+/**
+ * @brief  USART2 维护命令："log export" 导出 Flash 日志，"log info" 打印日志状态，"log flush" 写入缓存记录
+ */
+static void App_Poll_Console(void)
+{
+    static uint8_t line[U2_RX_BUF_SIZE + 1];
+    uint8_t cnt;
+
+    if (USART2_GetBuffer(line, &cnt) == 0)
+    {
+        return;
+    }
+    line[cnt] = '\0';
+    while (cnt > 0 && (line[cnt - 1] == '\r' || line[cnt - 1] == '\n' || line[cnt - 1] == ' '))
+    {
+        line[--cnt] = '\0';
+    }
+
+    if (strcmp((char*)line, "log export") == 0)
+    {
+        // 导出按字节轮询发送，约 23s，超过主循环任务的看门狗超时
+        Supervisor_Suspend();
+        FlashLog_Export();
+        Supervisor_Resume();
+    }
+    else if (strcmp((char*)line, "log info") == 0)
+    {
+        FlashLog_Print_Info();
+    }
+    else if (strcmp((char*)line, "log flush") == 0)
+    {
+        FlashLog_Flush();
+        FlashLog_Print_Info();
+    }
+    else
+    {
+        printf("WARN: Unknown console command '%s' (log export | log info | log flush).\r\n", (char*)line);
+    }
+}
+
+/**
+ * @brief  风机出风方向：有效逆温层时在底高与顶高对应的角度之间往复扫描，把整层暖空气往下混合；
+ *         否则指向默认高度
+ */
+static void App_Aim_Fan(InversionLayerInfo_t* inversion)
+{
+    if (inversion->is_valid)
+    {
+        Actuator_Servo_Sweep(calculate_servo_angle(inversion->base_height), calculate_servo_angle(inversion->top_height));
+    }
+    else
+    {
+        Actuator_Set(ACTUATOR_SERVO, (uint16_t)calculate_servo_angle(calculate_optimal_intervention_height(inversion)));
+    }
+}
+
+/**
+ * @brief  主循环的一次迭代：感知 -> 决策 -> 控制 -> 仿真 -> 统计 -> 上报
+ */
+void App_Loop(void)
+{
+    PROFILE_BEGIN(PROF_STAGE_LOOP);
+
+    Handle_Serial_Reception();
+    Supervisor_Beat(SUP_TASK_COMMS);
+    ConfigStore_Poll((uint32_t)System_GetTimeMs());
+    if (MQTT_Modem_Idle())
+    {
+        FlashLog_Poll();
+    }
+    App_Poll_Console();
+    // 紧急停止后，使状态机与已关断的硬件保持一致
+    if(CloseAll_flag == 1)
+    {
+        CloseAll_flag = 0;
+        Intervention_FSM_Reset(&intervention_fsm, (uint32_t)System_GetTimeMs());
+    }
+    //感知层
+    Crop_Critical_Temp = get_critical_temp(ConfigStore_Get()->crop_stage);
+    PROFILE_BEGIN(PROF_STAGE_SENSE);
+    read_all_environmental_data(&env_data);
+    PROFILE_END(PROF_STAGE_SENSE);
+    Supervisor_Beat(SUP_TASK_SENSE);
+
+    if(DATA_Flag == 1)
+    {
+        //决策层
+        // 2. 分析逆温层
+        PROFILE_BEGIN(PROF_STAGE_ANALYZE);
+        current_inversion = Analyze_Inversion_Layer(&env_data);
+        PROFILE_END(PROF_STAGE_ANALYZE);
+
+         // 3. 判断什么干预方法（经状态机施加回差、驻留时间与分级投入）
+        PROFILE_BEGIN(PROF_STAGE_DECIDE);
+        Intervention_Method = Intervention_FSM_Update(&intervention_fsm, &current_inversion, &SysAbilities, &env_data, Crop_Critical_Temp, (uint32_t)System_GetTimeMs());
+        PROFILE_END(PROF_STAGE_DECIDE);
+        if (!s_first_decision_done)
+        {
+            s_first_decision_done = 1;
+            printf("INFO: first frost decision at t=%lu ms\r\n", (unsigned long)System_GetTimeMs());
+        }
+
+        // --- C. 控制量计算层 (Control Calculation) ---
+        // 未参与本次干预的执行器功率清零，避免仿真模型沿用上一种方式的功率
+        PROFILE_BEGIN(PROF_STAGE_ACTUATE);
+        powers = Calculate_Intervention_Powers(Intervention_Method, &current_inversion, &env_data, Crop_Critical_Temp);
+
+        switch (Intervention_Method) 
+        {
+            case INTERVENTION_NONE:
+            {
+                Alarm_Post(ALARM_PATTERN_STEADY, ALARM_SEV_NORMAL);
+                Actuator_Set(ACTUATOR_PUMP, 0);
+                Actuator_Set(ACTUATOR_HEATER, 0);
+                Actuator_Set(ACTUATOR_FAN, 0);
+                Actuator_Set(ACTUATOR_SERVO, 0);
+
+                break;
+            }
+            case INTERVENTION_SPRINKLERS:
+            {
+                printf("INTERVENTION_SPRINKLERS\r\n");
+                Actuator_Set(ACTUATOR_HEATER, 0);
+                Actuator_Set(ACTUATOR_FAN, 0);
+                Actuator_Set(ACTUATOR_SERVO, 0);
+                Alarm_Post(ALARM_PATTERN_BEEP3, ALARM_SEV_CRITICAL);
+                Actuator_Set(ACTUATOR_PUMP, 1);
+                Actuator_Set(ACTUATOR_SPRINKLER_POWER, powers.sprinkler_power);
+                break;
+            }
+            case INTERVENTION_FANS_ONLY:
+            {
+                printf("INTERVENTION_FANS_ONLY\r\n");
+                Actuator_Set(ACTUATOR_HEATER, 0);
+                Actuator_Set(ACTUATOR_PUMP, 0);
+                Alarm_Post(ALARM_PATTERN_BEEP3, ALARM_SEV_CRITICAL);
+                Actuator_Set(ACTUATOR_FAN, 1);
+                App_Aim_Fan(&current_inversion);
+                Actuator_Set(ACTUATOR_FAN_POWER, powers.fan_power);
+                break;
+            }
+            case INTERVENTION_HEATERS_ONLY:
+            {
+                printf("INTERVENTION_HEATERS_ONLY\r\n");
+                Actuator_Set(ACTUATOR_FAN, 0);
+                Actuator_Set(ACTUATOR_PUMP, 0);
+                Actuator_Set(ACTUATOR_SERVO, 0);
+                Alarm_Post(ALARM_PATTERN_BEEP3, ALARM_SEV_CRITICAL);
+                Actuator_Set(ACTUATOR_HEATER, 1);
+                Actuator_Set(ACTUATOR_HEATER_POWER, powers.heater_power);
+                break;
+            }
+            case INTERVENTION_FANS_THEN_HEATERS:
+            {
+                printf("INTERVENTION_FANS_THEN_HEATERS\r\n");
+                Actuator_Set(ACTUATOR_PUMP, 0);
+                Alarm_Post(ALARM_PATTERN_BEEP3, ALARM_SEV_CRITICAL);
+                Actuator_Set(ACTUATOR_HEATER, 1);
+                Actuator_Set(ACTUATOR_FAN, 1);
+                App_Aim_Fan(&current_inversion);
+                Actuator_Set(ACTUATOR_FAN_POWER, powers.fan_power);
+                Actuator_Set(ACTUATOR_HEATER_POWER, powers.heater_power);
+                break;
+            }
+     
+        }
+        PROFILE_END(PROF_STAGE_ACTUATE);
+        Supervisor_Beat(SUP_TASK_CONTROL);
+        
+        if(g_simulation_tick_flag == 1)
+        {
+            en_count_flag = 0;
+            Sim_Update_Environment(&env_data , &powers);
+            g_simulation_tick_flag = 0;
+            en_count_flag=0;
+        }
+
+        // 每轮都计入统计窗口，窗口结束时才上报一次摘要：上行流量与循环频率无关
+        Sample_Sensor_Window(&env_data);
+        if (SensorStats_Close_If_Due(&sensor_stats, (uint32_t)System_GetTimeMs()))
+        {
+            Log_Sensor_Window(&sensor_stats.last);
+            mqtt_flag = 1;
+        }
+        /*
+        printf("temp1:%f C\r\n",env_data.temperatures[0]);
+        printf("temp2:%f C\r\n",env_data.temperatures[1]);
+        printf("temp3:%f C\r\n",env_data.temperatures[2]);
+        printf("temp4:%f C\r\n",env_data.temperatures[3]);
+        printf("wind_speed:%f m/s\r\n",env_data.wind_speed);
+        printf("humidity:%f \r\n",env_data.humidity);
+        printf("ambient_temp:%f C\r\n",env_data.ambient_temp);
+        */
+
+
+        // 2. 调用MQTT上报函数，并传入 system_status 结构体的地址
+        if(mqtt_flag==1)
+        {
+
+            system_status.env_data = &env_data;
+            system_status.capabilities = &SysAbilities;
+            system_status.method = Intervention_Method;
+            system_status.Powers = &powers;
+            system_status.actuator_switches = intervention_fsm.total_switches;
+            system_status.window = &sensor_stats.last;
+            system_status.crop_stage = ConfigStore_Get()->crop_stage;
+            PROFILE_BEGIN(PROF_STAGE_PUBLISH);
+            MQTT_Publish_All_Data_Adapt(&system_status);
+            MQTT_Publish_Actuator_Usage();
+            PROFILE_END(PROF_STAGE_PUBLISH);
+            mqtt_flag=0;
+        }
+        PROFILE_BEGIN(PROF_STAGE_DISPLAY);
+        Display_All_Data(&env_data);
+        PROFILE_END(PROF_STAGE_DISPLAY);
+        Supervisor_Beat(SUP_TASK_DISPLAY);
+        
+    }
+    else
+    {
+        // 紧急停止后等待按键期间控制与显示本就空闲，不能被当作卡死
+        Supervisor_Beat(SUP_TASK_CONTROL);
+        Supervisor_Beat(SUP_TASK_DISPLAY);
+    }
+
+    PROFILE_END(PROF_STAGE_LOOP);
+#if PROFILE_ENABLE
+    // 定期报告：USART2 打印 + loop_profile 属性上报
+    if (Profile_Report_Due((uint32_t)System_GetTimeMs()))
+    {
+        Profile_Print_Report();
+        MQTT_Publish_Loop_Profile();
+    }
+#endif
+}
+
+void read_all_environmental_data(EnvironmentalData_t* data)
+{
+    const DeviceConfig_t* cfg = ConfigStore_Get();
+    if(high < 4)
+    {
+        data->temperatures[high] = DS18B20_Get_Temp(high) + cfg->temp_offset[high] * 0.1f;
+    }
+    DHT11_Read_Data(&temperature_temp,&humidity_temp);
+    data->humidity = humidity_temp / 10.0f;
+    if(high == 1)//当高度为两米的时候读
+    {
+        data->ambient_temp = temperature_temp / 10.0f + cfg->temp_offset[4] * 0.1f;
+    }
+    
+
+    Get_Wind_Data(&wind_speed,&wind_power);
+    data->wind_speed = wind_speed;
+    // 云端设置过气压时使用保存的值，否则保持原值
+    if(cfg->pressure != 0)
+    {
+        data->pressure = cfg->pressure;
+    }
+
+}
+
+void System_CloseAll(void)
+{
+    Alarm_Post(ALARM_PATTERN_OFF, ALARM_SEV_NORMAL);
+    Actuator_Set(ACTUATOR_PUMP, 0);
+    Actuator_Set(ACTUATOR_HEATER, 0);
+    Actuator_Set(ACTUATOR_FAN, 0);
+    Actuator_Set(ACTUATOR_SERVO, 0);
+    
+}
+
+
+// PB8 按键：切换模拟高度
+void App_Key_NextHeight(void)
+{
+    high++;
+    if(high == 5)
+    {
+        high = 0;
+    }
+}
+
+// PB9 按键：数据准备就绪
+void App_Key_DataReady(void)
+{
+    DATA_Flag = 1;
+}
+
+// PC13 按键：紧急停止
+void App_Key_EmergencyStop(void)
+{
+    DATA_Flag = 0;
+    System_CloseAll();
+    CloseAll_flag = 1;
+}
@@ -0,0 +1,25 @@
+#ifndef __APP_H
+#define __APP_H
+
+#include "Frost_Detection.h"
+#include "Intervention_FSM.h"
+
+// 应用层全局状态 (目标板与主机仿真共用)
+extern EnvironmentalData_t env_data;
+extern InterventionMethod_t Intervention_Method;
+extern InterventionPowers_t powers;
+extern InterventionFSM_t intervention_fsm;
+
+float get_critical_temp(int crop_stage);
+void read_all_environmental_data(EnvironmentalData_t* data);
+void System_CloseAll(void);
+
+void App_Setup(void);
+void App_Loop(void);
+
+// 按键事件，由目标板的 EXTI 中断或主机仿真调用
+void App_Key_NextHeight(void);
+void App_Key_DataReady(void);
+void App_Key_EmergencyStop(void);
+
+#endif
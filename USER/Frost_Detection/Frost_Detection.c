@@ -4,6 +4,21 @@
 // 传感器高度数组
 static const float SENSOR_HEIGHTS[4] = {HEIGHT_0, HEIGHT_1, HEIGHT_2, HEIGHT_3};
 
+#ifdef FROST_TUNABLE_PARAMS
+#define FROST_PARAMS_DEFAULTS {                     \
+    FROST_DEFAULT_INVERSION_GRADIENT_THRESHOLD,     \
+    FROST_DEFAULT_MAX_INVERSION_STRENGTH,           \
+    FROST_DEFAULT_WIND_SPEED_NO_INTERVENTION,       \
+    FROST_DEFAULT_WIND_SPEED_SPRINKLERS_RISKY,      \
+    FROST_DEFAULT_INTERVENTION_SAFETY_MARGIN,       \
+    FROST_DEFAULT_SEVERE_FROST_MARGIN,              \
+    FROST_DEFAULT_MIN_POWER,                        \
+}
+const FrostParams_t g_frost_params_default = FROST_PARAMS_DEFAULTS;
+// 每个扫描线程持有独立的一份，互不干扰
+_Thread_local FrostParams_t g_frost_params = FROST_PARAMS_DEFAULTS;
+#endif
+
 float es_water(float T) 
 {
     return E0 * exp(A_WATER * T / (T + B_WATER));
@@ -350,3 +365,31 @@ uint8_t calculate_sprinkler_power(EnvironmentalData_t* env_data, float critical_
     return (uint8_t)power_float;
 }
 
+
+
+// 根据干预方式计算各执行器功率，未参与本次干预的执行器功率为 0
+InterventionPowers_t Calculate_Intervention_Powers(InterventionMethod_t method, InversionLayerInfo_t* inversion, EnvironmentalData_t* env_data, float critical_temp)
+{
+    InterventionPowers_t powers = {0, 0, 0};
+
+    switch (method)
+    {
+        case INTERVENTION_SPRINKLERS:
+            powers.sprinkler_power = calculate_sprinkler_power(env_data, critical_temp);
+            break;
+        case INTERVENTION_FANS_ONLY:
+            powers.fan_power = calculate_fan_power(inversion, env_data->wind_speed);
+            break;
+        case INTERVENTION_HEATERS_ONLY:
+            powers.heater_power = calculate_heater_power(env_data, critical_temp);
+            break;
+        case INTERVENTION_FANS_THEN_HEATERS:
+            powers.fan_power = calculate_fan_power(inversion, env_data->wind_speed);
+            powers.heater_power = calculate_heater_power(env_data, critical_temp);
+            break;
+        case INTERVENTION_NONE:
+        default:
+            break;
+    }
+    return powers;
+}
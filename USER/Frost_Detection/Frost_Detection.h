@@ -2,6 +2,7 @@
 #define __FROST_DETECTION_H
 
 #include "sys.h"
+#include "sensor_stats.h"
 
 // 传感器安装高度定义（单位：米）- 采用近地层加密方案
 #define HEIGHT_0 1
@@ -27,16 +28,48 @@
 #define GAMMA_FACTOR 0.000665 
 
 // 阈值定义（基于气象学研究和实际应用）
-#define INVERSION_GRADIENT_THRESHOLD 0.5f     // 逆温梯度阈值(°C/m)
-#define MAX_INVERSION_STRENGTH 3.0f           // 最大逆温强度 (°C/m)
-#define WIND_SPEED_NO_INTERVENTION 2.0f       // 无需干预的风速阈值(m/s)
-#define WIND_SPEED_FULL_INTERVENTION 0.5f     // 需要全力干预的风速阈值(m/s)
-#define WIND_SPEED_SPRINKLERS_RISKY 3.0f      // 洒水系统风险风速阈值(m/s)
-#define INTERVENTION_SAFETY_MARGIN 1.0f       // 安全边际(°C)
-#define SEVERE_FROST_MARGIN 2.0f              // 严重霜冻边际(°C)
+// 定义 FROST_USE_TUNED_PARAMS 时改用参数扫描工具 (TOOLS/sweep) 生成的 Frost_Params_Tuned.h
+#ifdef FROST_USE_TUNED_PARAMS
+#include "Frost_Params_Tuned.h"
+#else
+#define FROST_DEFAULT_INVERSION_GRADIENT_THRESHOLD 0.5f     // 逆温梯度阈值(°C/m)
+#define FROST_DEFAULT_MAX_INVERSION_STRENGTH       3.0f     // 最大逆温强度 (°C/m)
+#define FROST_DEFAULT_WIND_SPEED_NO_INTERVENTION   2.0f     // 无需干预的风速阈值(m/s)
+#define FROST_DEFAULT_WIND_SPEED_SPRINKLERS_RISKY  3.0f     // 洒水系统风险风速阈值(m/s)
+#define FROST_DEFAULT_INTERVENTION_SAFETY_MARGIN   1.0f     // 安全边际(°C)
+#define FROST_DEFAULT_SEVERE_FROST_MARGIN          2.0f     // 严重霜冻边际(°C)
+#define FROST_DEFAULT_MIN_POWER                    20       // 最小功率 (%)
+#endif
+
+// 可调阈值：固件中直接展开为常量；主机参数扫描时读取线程局部的参数表
+typedef struct {
+    float inversion_gradient_threshold;
+    float max_inversion_strength;
+    float wind_speed_no_intervention;
+    float wind_speed_sprinklers_risky;
+    float intervention_safety_margin;
+    float severe_frost_margin;
+    int   min_power;
+} FrostParams_t;
+
+#ifdef FROST_TUNABLE_PARAMS
+extern _Thread_local FrostParams_t g_frost_params;
+extern const FrostParams_t g_frost_params_default;
+#define FROST_PARAM(field, default_value)  (g_frost_params.field)
+#else
+#define FROST_PARAM(field, default_value)  (default_value)
+#endif
+
+#define INVERSION_GRADIENT_THRESHOLD  FROST_PARAM(inversion_gradient_threshold, FROST_DEFAULT_INVERSION_GRADIENT_THRESHOLD)
+#define MAX_INVERSION_STRENGTH        FROST_PARAM(max_inversion_strength, FROST_DEFAULT_MAX_INVERSION_STRENGTH)
+#define WIND_SPEED_NO_INTERVENTION    FROST_PARAM(wind_speed_no_intervention, FROST_DEFAULT_WIND_SPEED_NO_INTERVENTION)
+#define WIND_SPEED_FULL_INTERVENTION  0.5f     // 需要全力干预的风速阈值(m/s)
+#define WIND_SPEED_SPRINKLERS_RISKY   FROST_PARAM(wind_speed_sprinklers_risky, FROST_DEFAULT_WIND_SPEED_SPRINKLERS_RISKY)
+#define INTERVENTION_SAFETY_MARGIN    FROST_PARAM(intervention_safety_margin, FROST_DEFAULT_INTERVENTION_SAFETY_MARGIN)
+#define SEVERE_FROST_MARGIN           FROST_PARAM(severe_frost_margin, FROST_DEFAULT_SEVERE_FROST_MARGIN)
 
 //功率控制参数
-#define MIN_POWER        20    // 最小功率 (%)
+#define MIN_POWER        FROST_PARAM(min_power, FROST_DEFAULT_MIN_POWER)    // 最小功率 (%)
 #define MAX_POWER        100    // 最大功率 (%) 
 
 
@@ -99,6 +132,8 @@ typedef struct {
     InterventionMethod_t method;        // 当前决策的干预方法
     InterventionPowers_t* Powers;        // 指向功率的指针
     int crop_stage;                     // 当前作物生长阶段
+    uint32_t actuator_switches;         // 执行器累计开关次数
+    const SensorWindow_t* window;       // 刚结束的统计窗口，NULL 时上报瞬时值
 } SystemStatus_t;
 
 
@@ -109,6 +144,7 @@ uint8_t calculate_fan_power(InversionLayerInfo_t* risk_info, float wind_speed);
 uint8_t calculate_heater_power(EnvironmentalData_t* env_data, float critical_temp);
 uint8_t calculate_sprinkler_power(EnvironmentalData_t* env_data, float critical_temp);
 float calculate_optimal_intervention_height(InversionLayerInfo_t* inversion);
+InterventionPowers_t Calculate_Intervention_Powers(InterventionMethod_t method, InversionLayerInfo_t* inversion, EnvironmentalData_t* env_data, float critical_temp);
 
 #endif
 
@@ -0,0 +1,129 @@
+#include "Intervention_FSM.h"
+#include "stdio.h"
+
+// 各干预方式需要开启的执行器
+static void method_to_outputs(InterventionMethod_t method, uint8_t outputs[FSM_ACTUATOR_COUNT])
+{
+    outputs[FSM_ACTUATOR_FAN]       = (method == INTERVENTION_FANS_ONLY || method == INTERVENTION_FANS_THEN_HEATERS);
+    outputs[FSM_ACTUATOR_HEATER]    = (method == INTERVENTION_HEATERS_ONLY || method == INTERVENTION_FANS_THEN_HEATERS);
+    outputs[FSM_ACTUATOR_SPRINKLER] = (method == INTERVENTION_SPRINKLERS);
+}
+
+// 检查切换到目标方式是否满足所有执行器的最短开/关驻留时间
+static uint8_t transition_allowed(InterventionFSM_t* fsm, InterventionMethod_t target, uint32_t now_ms)
+{
+    uint8_t outputs[FSM_ACTUATOR_COUNT];
+    method_to_outputs(target, outputs);
+
+    for (int i = 0; i < FSM_ACTUATOR_COUNT; i++)
+    {
+        if (outputs[i] == fsm->actuator_on[i])
+        {
+            continue;
+        }
+
+        uint32_t elapsed = now_ms - fsm->actuator_change_ms[i];
+        if (fsm->actuator_on[i] && elapsed < FSM_MIN_ON_TIME_MS)
+        {
+            return 0; // 开启时间不足，不允许关闭
+        }
+        if (!fsm->actuator_on[i] && elapsed < FSM_MIN_OFF_TIME_MS)
+        {
+            return 0; // 停机时间不足，不允许再次开启
+        }
+    }
+    return 1;
+}
+
+// 切换到目标状态，并统计执行器的开关动作
+static void enter_state(InterventionFSM_t* fsm, InterventionMethod_t target, uint32_t now_ms)
+{
+    uint8_t outputs[FSM_ACTUATOR_COUNT];
+    method_to_outputs(target, outputs);
+
+    for (int i = 0; i < FSM_ACTUATOR_COUNT; i++)
+    {
+        if (outputs[i] != fsm->actuator_on[i])
+        {
+            fsm->actuator_on[i] = outputs[i];
+            fsm->actuator_change_ms[i] = now_ms;
+            fsm->actuator_switches[i]++;
+            fsm->total_switches++;
+        }
+    }
+
+#if FSM_TRACE_ENABLE
+    printf("INFO: Intervention state %d -> %d\r\n", (int)fsm->state, (int)target);
+#endif
+    fsm->state = target;
+    fsm->state_enter_ms = now_ms;
+}
+
+void Intervention_FSM_Init(InterventionFSM_t* fsm, uint32_t now_ms)
+{
+    fsm->state = INTERVENTION_NONE;
+    fsm->requested = INTERVENTION_NONE;
+    fsm->state_enter_ms = now_ms;
+    fsm->total_switches = 0;
+
+    for (int i = 0; i < FSM_ACTUATOR_COUNT; i++)
+    {
+        fsm->actuator_on[i] = 0;
+        // 上电时视为已停机足够久，首次开启不受最短停机时间限制
+        fsm->actuator_change_ms[i] = now_ms - FSM_MIN_OFF_TIME_MS;
+        fsm->actuator_switches[i] = 0;
+    }
+}
+
+// 紧急停止等外部强制关断后调用，使状态机与硬件保持一致
+void Intervention_FSM_Reset(InterventionFSM_t* fsm, uint32_t now_ms)
+{
+    if (fsm->state != INTERVENTION_NONE)
+    {
+        enter_state(fsm, INTERVENTION_NONE, now_ms);
+    }
+    fsm->requested = INTERVENTION_NONE;
+}
+
+// 在无状态决策的基础上增加回差、驻留时间与分级投入
+InterventionMethod_t Intervention_FSM_Update(InterventionFSM_t* fsm,
+                                             InversionLayerInfo_t* inversion,
+                                             SystemCapabilities_t* capabilities,
+                                             EnvironmentalData_t* env_data,
+                                             float critical_temp,
+                                             uint32_t now_ms)
+{
+    // 1. 进入阈值：沿用原有决策
+    InterventionMethod_t target = Determine_Optimal_Intervention(inversion, capabilities, env_data, critical_temp);
+    fsm->requested = target;
+
+    // 2. 退出阈值：把临界温度抬高一个回差再决策一次，
+    //    若当前状态在回差带内仍然成立，则保持当前状态
+    if (fsm->state != INTERVENTION_NONE && target != fsm->state)
+    {
+        InterventionMethod_t held = Determine_Optimal_Intervention(inversion, capabilities, env_data,
+                                                                   critical_temp + FSM_EXIT_HYSTERESIS);
+        if (held == fsm->state)
+        {
+            target = fsm->state;
+        }
+    }
+
+    // 3. 分级投入：组合干预时先开风扇，风扇运行足够久后再追加加热器
+    if (target == INTERVENTION_FANS_THEN_HEATERS && !fsm->actuator_on[FSM_ACTUATOR_HEATER])
+    {
+        if (!fsm->actuator_on[FSM_ACTUATOR_FAN] ||
+            (now_ms - fsm->actuator_change_ms[FSM_ACTUATOR_FAN]) < FSM_HEATER_STAGE_DELAY_MS)
+        {
+            target = INTERVENTION_FANS_ONLY;
+        }
+    }
+
+    // 4. 驻留时间：任何执行器未满足最短开/关时间时推迟切换
+    if (target != fsm->state && transition_allowed(fsm, target, now_ms))
+    {
+        enter_state(fsm, target, now_ms);
+    }
+
+    return fsm->state;
+}
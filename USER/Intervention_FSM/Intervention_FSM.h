@@ -0,0 +1,45 @@
+#ifndef __INTERVENTION_FSM_H
+#define __INTERVENTION_FSM_H
+
+#include "Frost_Detection.h"
+#include <stdint.h>
+
+// 状态机参数（单位：°C / 毫秒）
+#define FSM_EXIT_HYSTERESIS          0.5f      // 退出干预的回差：退出阈值 = 进入阈值 + 回差
+#define FSM_MIN_ON_TIME_MS           60000     // 执行器开启后的最短保持时间
+#define FSM_MIN_OFF_TIME_MS          30000     // 执行器关闭后的最短停机时间
+#define FSM_HEATER_STAGE_DELAY_MS    60000     // 分级投入：风扇运行多久后才允许追加加热器
+
+#ifndef FSM_TRACE_ENABLE
+#define FSM_TRACE_ENABLE             1         // 打印状态切换日志，主机批量回放时关闭
+#endif
+
+// 受状态机管理的执行器
+typedef enum {
+    FSM_ACTUATOR_FAN,
+    FSM_ACTUATOR_HEATER,
+    FSM_ACTUATOR_SPRINKLER,
+    FSM_ACTUATOR_COUNT
+} FSM_Actuator_t;
+
+// 干预状态机
+typedef struct {
+    InterventionMethod_t state;                          // 当前生效的干预方式
+    InterventionMethod_t requested;                      // 决策层最近一次的原始建议
+    uint32_t state_enter_ms;                             // 进入当前状态的时刻
+    uint8_t  actuator_on[FSM_ACTUATOR_COUNT];            // 各执行器当前开关状态
+    uint32_t actuator_change_ms[FSM_ACTUATOR_COUNT];     // 各执行器最近一次切换的时刻
+    uint32_t actuator_switches[FSM_ACTUATOR_COUNT];      // 各执行器累计切换次数
+    uint32_t total_switches;                             // 全部执行器累计切换次数
+} InterventionFSM_t;
+
+void Intervention_FSM_Init(InterventionFSM_t* fsm, uint32_t now_ms);
+void Intervention_FSM_Reset(InterventionFSM_t* fsm, uint32_t now_ms);
+InterventionMethod_t Intervention_FSM_Update(InterventionFSM_t* fsm,
+                                             InversionLayerInfo_t* inversion,
+                                             SystemCapabilities_t* capabilities,
+                                             EnvironmentalData_t* env_data,
+                                             float critical_temp,
+                                             uint32_t now_ms);
+
+#endif